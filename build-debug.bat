@@ -1,3 +1,3 @@
 @echo off
 @chcp 65001>nul
-gcc -Og -ansi -Wall -pedantic main.c --data-sections -ffunction-sections -g -o a.exe
\ No newline at end of file
+gcc -Og -ansi -Wall -pedantic main.c vagtplan.c server.c --data-sections -ffunction-sections -g -o a.exe
\ No newline at end of file
@@ -1,3 +1,3 @@
 @echo off
 @chcp 65001>nul
-gcc -O3 -ansi -Wall -pedantic main.c -o vagtplanlaegger.exe
\ No newline at end of file
+gcc -O3 -ansi -Wall -pedantic main.c vagtplan.c server.c -o vagtplanlaegger.exe
\ No newline at end of file
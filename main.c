@@ -1,798 +1,855 @@
+#if defined(__unix__) || defined(__APPLE__)
+#define _POSIX_C_SOURCE 200809L
+#define SIGNALS_SUPPORTED
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
-#include <math.h>
 #include <time.h>
 
-#define MAX_NAME_LENGTH 50
-#define POPULATION_SIZE 1000
-#define AMOUNT_OF_BEST_INDIVIDUALS 40
-#define AMOUNT_OF_CHILDREN 4
-
-enum Day {
-	DAY_MONDAY,
-	DAY_TUESDAY,
-	DAY_WEDNESDAY,
-	DAY_THURSDAY,
-	DAY_FRIDAY,
-	DAY_SATURDAY,
-	DAY_SUNDAY,
-	DAY_INVALID
-};
-
-enum Shift {
-	SHIFT_NIGHT,
-	SHIFT_DAY,
-	SHIFT_EVENING,
-	SHIFT_INVALID
-};
-
-typedef struct Worker {
-	char name[MAX_NAME_LENGTH + 1];
-	enum Day desired_day_off;
-	enum Shift desired_shift;
-	int last_block; 
-	unsigned int consecutive_night_shifts;
-	int day_off;
-	unsigned int uuid;
-} Worker;
-
-typedef struct BlockSchedule {
-	 Worker** workers;
-} BlockSchedule;
-
-typedef struct Schedule {
-	BlockSchedule blocks[21];
-	double score;
-} Schedule;
-
-typedef struct RequiredWorkers {
-	unsigned int night_workers;
-	unsigned int day_workers;
-	unsigned int evening_workers;
-} RequiredWorkers;
+#ifdef SIGNALS_SUPPORTED
+#include <signal.h>
+#include <pthread.h>
+#endif
+
+#include "vagtplan.h"
+#include "server.h"
+
+#define MAX_SEED_FILES 16
+#define DEFAULT_SERVER_THREADS 4
+#define DEFAULT_CHECK_SCHEDULES 1000000UL
+/*En fitness funktion er gået tilbage hvis den er langsommere end denne andel af sin baseline*/
+#define BASELINE_TOLERANCE 0.8
+/*Hvor den bedste vagtplan indtil videre bliver gemt når programmet får SIGUSR1*/
+#define PROGRESS_FILE "forelobig-vagtplan.csv"
+#define PROGRESS_TEMPORARY_FILE "forelobig-vagtplan.csv.tmp"
+/*Hvor mange skemaer en tråd i print mindst skriver ad gangen*/
+#define PRINT_GRAIN 16
+
+typedef struct CreateOptions {
+	SolverOptions solver;
+	const char* seed_files[MAX_SEED_FILES];
+	unsigned int seed_count;
+	/*Hver afdeling får sin egen vagtplan, som bliver sat sammen til en*/
+	bool departments;
+} CreateOptions;
+
+#ifdef SIGNALS_SUPPORTED
+/**
+ * Tråden der tager imod signalerne mens motoren kører. SIGINT og SIGTERM stopper motoren, som så
+ * giver den bedste vagtplan indtil videre, og SIGUSR1 gemmer den bedste vagtplan i PROGRESS_FILE
+ */
+typedef struct SignalWatcher {
+	/*Trådens egen kopi af medarbejderne, da motorens kontekst ikke må bruges samtidig*/
+	VagtplanContext* context;
+	VagtplanProgress* progress;
+	sigset_t signals;
+	sigset_t old_mask;
+	pthread_mutex_t lock;
+	bool finished;
+	pthread_t thread;
+} SignalWatcher;
+#endif
 
 /**
- * Laver et schema til antallet af mearbejdere
- * @param[in] workers alle workers
- * @param[in] worker_count antallet af workers i workers arrayen
- * @param[in] required_workers en required workers struktur
- * @returns et skema over hvem der skal arbejde
+ * Det print_worker_files skal bruge for at skrive skemaerne
  */
- Schedule make_schedule( Worker* workers[], const unsigned int worker_count, const  RequiredWorkers required_workers);
+typedef struct PrintJob {
+	VagtplanContext* context;
+	const VagtplanSchedule* schedule;
+} PrintJob;
 
 /**
- * Laver den første generation af individer
- * @param[in] required_workers the amount of required workers
- * @param[in] worker array af alle medarbejdere
- * @param[in] worker_count antallet af mebarbejdere
- * @param[in] population_size mængden af
- * @param[out] schedules der hvor populationen bliver gemt
+ * Læser flagene til motoren fra kommandolinjen
+ * @param[in] argc antallet af argumenter efter programnavnet
+ * @param[in] argv argumenterne efter programnavnet
+ * @param[out] options indstillingerne, med standardværdier for dem der ikke er angivet
+ * @returns false hvis et af flagene er forkert
  */
-void generate_initial_population( RequiredWorkers required_workers,  Worker* worker[], unsigned int worker_count, Schedule* schedules, unsigned int population_size);
+bool parse_solver_options(int argc, char** argv, CreateOptions* options);
 
 /**
- * Laver et enkelt tilfældigt skema
- * @param[in] workers alle medarbejdere
- * @param[in] worker_count antallet af medarbejdere i workers
- * @param[in] required_workers antallet af medarbejdere der er brug for
- * @param[out] schedule der hvor det tilfældige skema bliver gemt
+ * Laver en kontekst som skriver til stdout og har medarbejdere.csv indlæst, og fravaer.csv hvis den findes
  */
-void generate_random_schedule( Worker* workers[], const unsigned int worker_count, const  RequiredWorkers required_workers,  Schedule* schedule);
+VagtplanContext* open_context();
 
+/**
+ * Stopper programmet med fejlen fra konteksten, hvis status ikke er VAGTPLAN_OK
+ */
+void check(VagtplanContext* context, enum VagtplanStatus status);
 
 /**
- * Fitness funktionen for skemaer
- * @param[in] schedule vagtplanen som bliver evalueret
- * @param[in] required_workers mængden af medarbejdere der er brug for
- * @returns en værdi som siger hvor god planen er, nu højere nu bedre
+ * Åbner en fil og stopper programmet hvis det ikke kan lade sig gøre
  */
-double evaluate_schedule(Schedule* schedule, const RequiredWorkers required_workers, Worker* worker[], unsigned int amount_of_workers);
+FILE* open_file(const char* file_name, const char* mode);
 
+bool block_has_worker(const VagtplanSchedule* schedule, unsigned int block, unsigned int worker);
 
 /**
- * Læser Workers ind fra den givne file pointer
- * @param[in, out] file en åben fil
- * @param[out] antallet af workers som blev indlæst fra filens
- * @returns en array som er worker_count stor af Worker
+ * Læser en hel fil ind i hukommelsen og stopper programmet hvis det ikke kan lade sig gøre
+ * @param[out] length antallet af bytes i filen
+ * @returns indholdet, skal frigives med free
  */
- Worker* read_workers(FILE* file, unsigned int* worker_count);
+char* read_file(const char* file_name, size_t* length);
+
+void test_schedule(const char* vagtplan_fil_navn);
+void create_schedule(const CreateOptions* options);
+void create_department_schedule(const CreateOptions* options);
+void replan_published_schedule(const char* vagtplan_fil_navn, unsigned int uuid, const char* block_list, int max_changes);
+void print_schedules(const char* vagtplan_fil_navn);
 
 /**
- * Skriver schedule ud i en fil
- * @param[in, out] file en åben fil hvor schedule skal skrives til
- * @param[in] schedule skemaet som skal skrives
+ * Tjekker fitness funktionerne mod referencen i biblioteket og sammenligner hvor hurtige de er
+ * med en baseline fil. Hvis baseline filen ikke findes bliver den skrevet
+ * @param[in] baseline_file_name filen med evalueringer per sekund for hver funktion, må være NULL
+ * @returns EXIT_FAILURE hvis en funktion gav en anden score end referencen eller er gået tilbage
  */
-void write_schedule(FILE* file, const  Schedule* schedule, RequiredWorkers required_workers);
+int run_evaluator_check(RequiredWorkers required_workers, unsigned long schedule_count, const char* baseline_file_name);
 
 /**
- * Læser en schedule som er gemt i en fil
- * @param[in, out] file en åben fil hvor schedule skal læses fra
- * @param[out] out der hvor mængden af arbejdere hver dag bliver gemt
- * @return det indlæste skema
+ * Sender en forespørgsel til en kørende server, argv starter ved kommandoen efter soklen
  */
-Schedule read_schedule(FILE* file, RequiredWorkers* out, Worker** workers, unsigned int worker_count);
+int client_request(const char* socket_path, int argc, char** argv);
 
 /**
  * skriver et pænt skema for en enkelt person til en fil
  * @param[in, out] file en åben fil hvor skemaet skal skrives til
- * @param[in] worker den medarbejder skemaet skal printes til
+ * @param[in] worker nummeret på den medarbejder skemaet skal printes til
  * @param[in] skemaet som er lavet for medarbejderen
  */
-void print_worker_schedule(FILE* file, const Worker* worker, const Schedule* schedule, RequiredWorkers required_workers);
-
-void fatal_error(const char* reason);
-
-void evaluate_schedule_required_workers( Schedule* schedule, const RequiredWorkers required_workers, unsigned int block_number, unsigned int j);
-
-enum Shift string_to_shift(char* input);
-
-enum Day string_to_day(char* input);
-
-unsigned int get_required_workers(RequiredWorkers required_workers, enum Shift shift);
-
-void evaluate_schedule_preferred_day_off(Schedule* schedule, Worker* worker[], unsigned int m, unsigned int amount_assigned_workers, Worker** assigned_workers, unsigned int amount_of_workers, unsigned int i);
-
-int compare_schedule(const void* a, const void* b);
-
-void combine_schedule(Worker* workers[], unsigned int worker_count, RequiredWorkers required_workers, const  Schedule* a, const  Schedule* b,  Schedule* out);
+void print_worker_schedule(FILE* file, unsigned int worker, const VagtplanSchedule* schedule);
 
-int random_number(int min, int max);
-
-unsigned int get_required_for_shift(RequiredWorkers required_workers, enum Shift shift);
-
-void set_required_for_shift(RequiredWorkers* required_workers, enum Shift shift, unsigned int val);
-
-Worker* find_worker_from_uuid(Worker** workers, unsigned int worker_count, unsigned int uuid);
+#ifdef SIGNALS_SUPPORTED
+/**
+ * Blokerer SIGINT, SIGTERM og SIGUSR1 i programmets tråde og starter tråden der venter på dem
+ * @param[in] context konteksten med medarbejderlisten motoren kører med
+ * @returns false hvis tråden ikke kunne startes, så bliver signalerne ikke fanget
+ */
+bool start_signal_watcher(VagtplanContext* context, VagtplanProgress* progress, SignalWatcher* watcher);
 
-RequiredWorkers input_required_workers();
+/**
+ * Stopper tråden og giver signalerne tilbage til programmet
+ */
+void stop_signal_watcher(SignalWatcher* watcher);
+void* watch_signals(void* argument);
 
-void free_schedule(Schedule* schedule);
+/**
+ * Gemmer den bedste vagtplan motoren har udgivet i PROGRESS_FILE
+ */
+void save_progress(SignalWatcher* watcher);
+#endif
 
-int maxi(int a, int b);
+/**
+ * Skriver skemaerne for medarbejderne fra begin til end, hver i sin egen fil i output
+ * @param[in] argument PrintJob
+ */
+void print_worker_files(void* argument, unsigned int thread, unsigned long begin, unsigned long end);
 
-const char* get_shift_as_string(enum Shift shift);
-const char* get_day_as_string(enum Day day);
 const char* get_time_slot(enum Shift shift);
-
-void test_schedule(const char* vagtplan_fil_navn);
-void create_schedule();
-void print_schedules(const char* vagtplan_fil_navn);
+/**
+ * Læser bemandingen fra bemanding.csv hvis filen findes, ellers bliver brugeren spurgt om et antal for hver vagt
+ */
+RequiredWorkers read_staffing(VagtplanContext* context);
+/**
+ * Lægger kravene til kvalifikationer fra kvalifikationer.csv ind i bemandingen, hvis filen findes
+ * @param[in, out] required_workers bemandingen som kravene bliver tilføjet til
+ */
+void read_skill_requirements(VagtplanContext* context, RequiredWorkers* required_workers);
+/**
+ * Læser bemandingen for en afdeling fra bemanding-<afdeling>.csv, og kravene til kvalifikationer fra
+ * kvalifikationer-<afdeling>.csv eller kvalifikationer.csv
+ * @param[out] out bemandingen, kun sat hvis filen fandtes
+ * @returns false hvis afdelingen ikke har sin egen bemanding
+ */
+bool read_department_staffing(VagtplanContext* context, const char* department, RequiredWorkers* out);
+RequiredWorkers input_required_workers();
+void fatal_error(const char* reason);
 
 int main(int argc, char** argv) {
-	if (argc >= 3) {
+	CreateOptions options;
+	if (argc >= 2 && strcmp(argv[1], "serve") == 0) {
+		unsigned int threads = DEFAULT_SERVER_THREADS;
+		if (argc < 3 || (argc >= 4 && sscanf(argv[3], "%u", &threads) != 1)) {
+			printf("Brug: serve <sokkel> [tråde]\n");
+			return EXIT_FAILURE;
+		}
+		return serve(argv[2], threads);
+	}
+	if (argc >= 2 && strcmp(argv[1], "client") == 0) {
+		if (argc < 4) {
+			printf("Brug: client <sokkel> solve <nat> <dag> <aften> [flag], client <sokkel> score <vagtplan> eller client <sokkel> replan <vagtplan> <uuid> <blokke> [max ændringer]\n");
+			return EXIT_FAILURE;
+		}
+		return client_request(argv[2], argc - 3, argv + 3);
+	}
+	if (argc >= 2 && strcmp(argv[1], "check") == 0) {
+		unsigned int night_workers;
+		unsigned int day_workers;
+		unsigned int evening_workers;
+		unsigned long schedule_count = DEFAULT_CHECK_SCHEDULES;
+		if (argc < 5 || sscanf(argv[2], "%u", &night_workers) != 1
+			|| sscanf(argv[3], "%u", &day_workers) != 1
+			|| sscanf(argv[4], "%u", &evening_workers) != 1
+			|| (argc >= 6 && (sscanf(argv[5], "%lu", &schedule_count) != 1 || schedule_count < 1))) {
+			printf("Brug: check <nat> <dag> <aften> [antal vagtplaner] [baseline fil]\n");
+			return EXIT_FAILURE;
+		}
+		return run_evaluator_check(vagtplan_required_per_shift(night_workers, day_workers, evening_workers), schedule_count, argc >= 7 ? argv[6] : NULL);
+	}
+	if (argc >= 2 && strcmp(argv[1], "replan") == 0) {
+		unsigned int uuid;
+		int max_changes = -1;
+		if (argc < 5 || sscanf(argv[3], "%u", &uuid) != 1 || (argc >= 6 && (sscanf(argv[5], "%d", &max_changes) != 1 || max_changes < 0))) {
+			printf("Brug: replan <vagtplan> <uuid> <blokke> [max ændringer]\n");
+			return EXIT_FAILURE;
+		}
+		replan_published_schedule(argv[2], uuid, argv[4], max_changes);
+		return 0;
+	}
+	if (argc >= 2 && (strcmp(argv[1], "test") == 0 || strcmp(argv[1], "print") == 0)) {
+		if (argc < 3) {
+			printf("Mangler filnavn på vagtplanen\n");
+			return EXIT_FAILURE;
+		}
 		if (strcmp(argv[1], "test") == 0) {
 			test_schedule(argv[2]);
-		} else if (strcmp(argv[1], "print") == 0) {
-			print_schedules(argv[2]);
 		} else {
-			printf("Forkert parameter, du kan bruge test eller print\n");
-			return EXIT_FAILURE;
+			print_schedules(argv[2]);
 		}
 	} else {
-		create_schedule();
+		if (!parse_solver_options(argc - 1, argv + 1, &options)) {
+			printf("Forkert parameter, du kan bruge test, print eller --engine generational|steady|exact|anneal|tabu, --exact, --generations N, --population N, --greedy andel, --elite N, --children N, --threads N, --tournament N og --mutation adaptive|fixed, --crossover adaptive|block|day|uniform|worker, --seed vagtplan.csv, --islands N, --time sekunder, --top K, --distance N og --departments N, eller check, serve og client\n");
+			return EXIT_FAILURE;
+		}
+		create_schedule(&options);
 	}
 	return 0;
 }
 
-void test_schedule(const char* vagtplan_fil_navn) {
-	FILE* fil = fopen("medarbejdere.csv", "r");
-	RequiredWorkers required_workers;
-	Worker* workers_direct;
-	Worker** workers;
-	unsigned int worker_count = 0;
-	Schedule schedule;
-	double score = 0;
-	unsigned int i;
-	if (fil == NULL) {
-		fatal_error("Kunne ikke åbne medarbejdere.csv filen");
-	}
-	workers_direct = read_workers(fil, &worker_count);
-	workers = malloc(worker_count * sizeof(struct Worker*));
-	for (i = 0; i < worker_count; i++) {
-		workers[i] = &workers_direct[i];
+bool parse_solver_options(int argc, char** argv, CreateOptions* options) {
+	int i;
+	vagtplan_default_options(&options->solver);
+	options->seed_count = 0;
+	options->departments = false;
+
+	for (i = 0; i < argc; i++) {
+		if (strcmp(argv[i], "--exact") == 0) {
+			options->solver.engine = ENGINE_EXACT;
+			continue;
+		}
+		/*Resten af flagene tager en værdi*/
+		if (i + 1 >= argc) {
+			return false;
+		}
+		if (strcmp(argv[i], "--engine") == 0) {
+			if (strcmp(argv[i + 1], "generational") == 0) {
+				options->solver.engine = ENGINE_GENERATIONAL;
+			} else if (strcmp(argv[i + 1], "steady") == 0) {
+				options->solver.engine = ENGINE_STEADY_STATE;
+			} else if (strcmp(argv[i + 1], "exact") == 0) {
+				options->solver.engine = ENGINE_EXACT;
+			} else if (strcmp(argv[i + 1], "anneal") == 0) {
+				options->solver.engine = ENGINE_ANNEALING;
+			} else if (strcmp(argv[i + 1], "tabu") == 0) {
+				options->solver.engine = ENGINE_TABU;
+			} else {
+				return false;
+			}
+		} else if (strcmp(argv[i], "--generations") == 0) {
+			if (sscanf(argv[i + 1], "%u", &options->solver.generations) != 1 || options->solver.generations < 1) {
+				return false;
+			}
+		} else if (strcmp(argv[i], "--mutation") == 0) {
+			if (strcmp(argv[i + 1], "adaptive") == 0) {
+				options->solver.adaptive_mutation = true;
+			} else if (strcmp(argv[i + 1], "fixed") == 0) {
+				options->solver.adaptive_mutation = false;
+			} else {
+				return false;
+			}
+		} else if (strcmp(argv[i], "--crossover") == 0) {
+			if (strcmp(argv[i + 1], "adaptive") == 0) {
+				options->solver.crossover = CROSSOVER_ADAPTIVE;
+			} else if (strcmp(argv[i + 1], "block") == 0) {
+				options->solver.crossover = CROSSOVER_BLOCKS;
+			} else if (strcmp(argv[i + 1], "day") == 0) {
+				options->solver.crossover = CROSSOVER_DAYS;
+			} else if (strcmp(argv[i + 1], "uniform") == 0) {
+				options->solver.crossover = CROSSOVER_UNIFORM_DAYS;
+			} else if (strcmp(argv[i + 1], "worker") == 0) {
+				options->solver.crossover = CROSSOVER_WORKERS;
+			} else {
+				return false;
+			}
+		} else if (strcmp(argv[i], "--seed") == 0) {
+			if (options->seed_count >= MAX_SEED_FILES) {
+				return false;
+			}
+			options->seed_files[options->seed_count] = argv[i + 1];
+			options->seed_count++;
+		} else if (strcmp(argv[i], "--islands") == 0) {
+			if (sscanf(argv[i + 1], "%u", &options->solver.islands) != 1 || options->solver.islands < 1 || options->solver.islands > MAX_ISLANDS) {
+				return false;
+			}
+		} else if (strcmp(argv[i], "--top") == 0) {
+			if (sscanf(argv[i + 1], "%u", &options->solver.alternatives) != 1 || options->solver.alternatives < 1 || options->solver.alternatives > MAX_ALTERNATIVES) {
+				return false;
+			}
+		} else if (strcmp(argv[i], "--distance") == 0) {
+			if (sscanf(argv[i + 1], "%u", &options->solver.min_distance) != 1) {
+				return false;
+			}
+		} else if (strcmp(argv[i], "--departments") == 0) {
+			if (sscanf(argv[i + 1], "%u", &options->solver.parallel_departments) != 1 || options->solver.parallel_departments < 1 || options->solver.parallel_departments > MAX_PARALLEL_DEPARTMENTS) {
+				return false;
+			}
+			options->departments = true;
+		} else if (strcmp(argv[i], "--time") == 0) {
+			if (sscanf(argv[i + 1], "%lf", &options->solver.time_limit) != 1 || options->solver.time_limit <= 0) {
+				return false;
+			}
+		} else if (strcmp(argv[i], "--greedy") == 0) {
+			if (sscanf(argv[i + 1], "%lf", &options->solver.greedy_fraction) != 1 || options->solver.greedy_fraction < 0 || options->solver.greedy_fraction > 1) {
+				return false;
+			}
+		} else if (strcmp(argv[i], "--population") == 0) {
+			if (sscanf(argv[i + 1], "%u", &options->solver.population_size) != 1 || options->solver.population_size > MAX_POPULATION_SIZE) {
+				return false;
+			}
+		} else if (strcmp(argv[i], "--elite") == 0) {
+			if (sscanf(argv[i + 1], "%u", &options->solver.elite_size) != 1 || options->solver.elite_size < 1) {
+				return false;
+			}
+		} else if (strcmp(argv[i], "--children") == 0) {
+			if (sscanf(argv[i + 1], "%u", &options->solver.children_per_elite) != 1 || options->solver.children_per_elite < 1) {
+				return false;
+			}
+		} else if (strcmp(argv[i], "--threads") == 0) {
+			if (sscanf(argv[i + 1], "%u", &options->solver.threads) != 1 || options->solver.threads < 1 || options->solver.threads > MAX_THREADS) {
+				return false;
+			}
+		} else if (strcmp(argv[i], "--tournament") == 0) {
+			if (sscanf(argv[i + 1], "%u", &options->solver.tournament_size) != 1 || options->solver.tournament_size < 2) {
+				return false;
+			}
+		} else {
+			return false;
+		}
+		i++;
 	}
+	return true;
+}
 
-	fclose(fil);
-	fil = fopen(vagtplan_fil_navn, "r");
-	if (fil == NULL) {
-		fatal_error("Kunne ikke åbne vagtplan filen");
+VagtplanContext* open_context() {
+	VagtplanContext* context = vagtplan_create(NULL, (unsigned long) time(NULL));
+	FILE* fil;
+	bool used_cache;
+	if (context == NULL) {
+		fatal_error("ikke nok hukkomelse");
 	}
-	
-	schedule = read_schedule(fil, &required_workers, workers, worker_count);
-	fclose(fil);
+	vagtplan_set_log(context, stdout);
 
-	score = evaluate_schedule(&schedule, required_workers, workers, worker_count);
-
-	printf("Vagtplanen fik en score på %f\n", score);
-
-	fil = fopen("vagtplan-kopi.csv", "w");
-	
-	write_schedule(fil, &schedule, required_workers);
-
-	fclose(fil);
+	check(context, vagtplan_read_workers_cached(context, "medarbejdere.csv", "medarbejdere.cache", &used_cache));
+	if (used_cache) {
+		printf("Medarbejderne er læst fra medarbejdere.cache\n");
+	}
 
-	free_schedule(&schedule);
-	free(workers);
-	free(workers_direct);
+	fil = fopen("fravaer.csv", "r");
+	if (fil != NULL) {
+		check(context, vagtplan_read_availability(context, fil));
+		fclose(fil);
+		printf("Fraværet er læst fra fravaer.csv\n");
+	}
+	return context;
 }
 
-void create_schedule() {
-	FILE* fil = fopen("medarbejdere.csv", "r");
-	Worker* workers_direct;
-	unsigned int worker_count = 0;
-	Schedule schedule;
-	RequiredWorkers required_workers = input_required_workers();
-	Worker **workers;
-	unsigned int i = 0;
-	
-	srand(time(NULL));
+void check(VagtplanContext* context, enum VagtplanStatus status) {
+	if (status != VAGTPLAN_OK) {
+		fatal_error(vagtplan_error_message(context));
+	}
+}
 
+FILE* open_file(const char* file_name, const char* mode) {
+	FILE* fil = fopen(file_name, mode);
 	if (fil == NULL) {
-		fatal_error("Kunne ikke åbne input csv filen");
+		printf("Kunne ikke åbne %s\n", file_name);
+		fatal_error(NULL);
 	}
+	return fil;
+}
 
-	workers_direct = read_workers(fil, &worker_count);
-	fclose(fil);
+bool block_has_worker(const VagtplanSchedule* schedule, unsigned int block, unsigned int worker) {
+	unsigned int i;
+	for (i = 0; i < vagtplan_block_size(schedule, block); i++) {
+		if (vagtplan_schedule_worker(schedule, block, i) == worker) {
+			return true;
+		}
+	}
+	return false;
+}
 
-	workers = malloc(worker_count * sizeof(struct Worker*));
-	if (workers == NULL) {
+char* read_file(const char* file_name, size_t* length) {
+	FILE* fil = open_file(file_name, "rb");
+	size_t allocated = 4096;
+	char* text = malloc(allocated);
+	size_t got;
+	*length = 0;
+	if (text == NULL) {
 		fatal_error("ikke nok hukkomelse");
 	}
-	for (i = 0; i < worker_count; i++) {
-		workers[i] = &workers_direct[i];
+	while ((got = fread(text + *length, 1, allocated - *length, fil)) > 0) {
+		*length += got;
+		if (*length == allocated) {
+			allocated *= 2;
+			text = realloc(text, allocated);
+			if (text == NULL) {
+				fatal_error("ikke nok hukkomelse");
+			}
+		}
 	}
-	printf("Starter det genetiske algoritme\n");
+	fclose(fil);
+	return text;
+}
+
+void test_schedule(const char* vagtplan_fil_navn) {
+	VagtplanContext* context = open_context();
+	VagtplanSchedule* schedule;
+	double score = 0;
+	FILE* fil = open_file(vagtplan_fil_navn, "r");
 
-	schedule = make_schedule(workers, worker_count, required_workers);
+	check(context, vagtplan_read_schedule(context, fil, &schedule));
+	fclose(fil);
+	read_skill_requirements(context, vagtplan_schedule_requirements(schedule));
 
-	fil = fopen("lavet-vagtplan.csv", "w");
-	
-	write_schedule(fil, &schedule, required_workers);
+	check(context, vagtplan_evaluate_schedule(context, schedule, &score));
 
+	printf("Vagtplanen fik en score på %f\n", score);
+
+	fil = open_file("vagtplan-kopi.csv", "w");
+	check(context, vagtplan_write_schedule(context, fil, schedule));
 	fclose(fil);
-	free_schedule(&schedule);
-	free(workers);
-	free(workers_direct);
+
+	vagtplan_destroy(context);
 }
 
-void print_schedules(const char* vagtplan_fil_navn) {
-	FILE* fil = fopen("medarbejdere.csv", "r");
+void create_schedule(const CreateOptions* options) {
+	VagtplanContext* context;
 	RequiredWorkers required_workers;
-	Worker* workers_direct;
-	Worker** workers;
-	unsigned int worker_count = 0;
-	Schedule schedule;
+	SolverOptions solver_options = options->solver;
+	VagtplanSchedule* seeds[MAX_SEED_FILES];
+	VagtplanSchedule* schedules[MAX_ALTERNATIVES];
+	VagtplanProgress* progress;
+	unsigned int schedule_count;
+	char file_name[64];
+	FILE* fil;
 	unsigned int i;
-	unsigned int worker_i;
-	char filnavn[100];
+#ifdef SIGNALS_SUPPORTED
+	SignalWatcher watcher;
+	bool watching;
+#endif
 
-	if (fil == NULL) {
-		fatal_error("Kunne ikke åbne medarbejdere.csv filen");
-	}
-	workers_direct = read_workers(fil, &worker_count);
-	workers = malloc(worker_count * sizeof(struct Worker*));
-	for (i = 0; i < worker_count; i++) {
-		workers[i] = &workers_direct[i];
+	if (options->departments) {
+		create_department_schedule(options);
+		return;
 	}
+	context = open_context();
+	required_workers = read_staffing(context);
 
-	fclose(fil);
-	fil = fopen(vagtplan_fil_navn, "r");
-	if (fil == NULL) {
-		fatal_error("Kunne ikke åbne vagtplan.csv filen");
+	for (i = 0; i < options->seed_count; i++) {
+		fil = open_file(options->seed_files[i], "r");
+		check(context, vagtplan_read_seed(context, fil, required_workers, &seeds[i]));
+		fclose(fil);
 	}
-	
-	schedule = read_schedule(fil, &required_workers, workers, worker_count);
-	fclose(fil);
+	check(context, vagtplan_create_progress(context, required_workers, &progress));
+	solver_options.progress = progress;
+#ifdef SIGNALS_SUPPORTED
+	/*Den eksakte søgning kan ikke stoppes undervejs, så der skal Ctrl-C stadig stoppe programmet*/
+	watching = options->solver.engine != ENGINE_EXACT && start_signal_watcher(context, progress, &watcher);
+#endif
+	printf("Starter det genetiske algoritme\n");
 
+	check(context, vagtplan_make_schedules(context, required_workers, &solver_options, seeds, options->seed_count, schedules, &schedule_count));
 
-	for (worker_i = 0; worker_i < worker_count; worker_i++) {
-		sprintf(filnavn, "output/%s.%u.txt", workers[worker_i]->name, workers[worker_i]->uuid);
-		fil = fopen(filnavn, "w");
-		if (fil == NULL) {
-			fatal_error("Kunne ikke åbne output filen");
+	/*Den bedste bliver altid gemt i lavet-vagtplan.csv, alternativerne får et nummer*/
+	for (i = 0; i < schedule_count; i++) {
+		if (i == 0) {
+			strcpy(file_name, "lavet-vagtplan.csv");
+		} else {
+			sprintf(file_name, "lavet-vagtplan-%u.csv", i + 1);
 		}
-		print_worker_schedule(fil, workers[worker_i], &schedule, required_workers);
+		fil = open_file(file_name, "w");
+		check(context, vagtplan_write_schedule(context, fil, schedules[i]));
 		fclose(fil);
+		if (schedule_count > 1) {
+			printf("%s har en score på %f\n", file_name, vagtplan_schedule_score(schedules[i]));
+		}
 	}
-
-	free_schedule(&schedule);
-	free(workers);
-	free(workers_direct);
-}
-
-Worker* read_workers(FILE* fil, unsigned int* worker_count) {
-	unsigned int allocated_workers = 10;
-	Worker* workers = malloc(allocated_workers * sizeof( Worker));
-
-	if (workers == NULL) {
-		fatal_error("Ikke mere hukommelse");
+	if (schedule_count < options->solver.alternatives) {
+		printf("Motoren fandt kun %u af de %u forskellige vagtplaner\n", schedule_count, options->solver.alternatives);
 	}
 
-	*worker_count = 0;
+#ifdef SIGNALS_SUPPORTED
+	/*Signalerne bliver først givet tilbage når vagtplanerne er gemt, så et sent Ctrl-C ikke afbryder skrivningen*/
+	if (watching) {
+		stop_signal_watcher(&watcher);
+	}
+#endif
+	vagtplan_destroy(context);
+}
 
-	while (!feof(fil)) {
-		int res = 0;
-		char shift_text[33];
-		char day_text[33];
-		if (*worker_count + 1 >= allocated_workers) {
-			allocated_workers += 10;
-			workers = realloc(workers, allocated_workers * sizeof( Worker));
-			if (workers == NULL) {
-				fatal_error("Ikke mere hukommelse");
-			}
-		}
+#ifdef SIGNALS_SUPPORTED
+bool start_signal_watcher(VagtplanContext* context, VagtplanProgress* progress, SignalWatcher* watcher) {
+	watcher->context = vagtplan_create(NULL, 0);
+	if (watcher->context == NULL || vagtplan_copy_workers(watcher->context, context) != VAGTPLAN_OK) {
+		vagtplan_destroy(watcher->context);
+		return false;
+	}
+	watcher->progress = progress;
+	watcher->finished = false;
+	pthread_mutex_init(&watcher->lock, NULL);
+	sigemptyset(&watcher->signals);
+	sigaddset(&watcher->signals, SIGINT);
+	sigaddset(&watcher->signals, SIGTERM);
+	sigaddset(&watcher->signals, SIGUSR1);
+	/*Signalerne er blokeret i alle andre tråde, også motorens og øernes, så de kun bliver taget af sigwait*/
+	pthread_sigmask(SIG_BLOCK, &watcher->signals, &watcher->old_mask);
+	if (pthread_create(&watcher->thread, NULL, watch_signals, watcher) != 0) {
+		pthread_sigmask(SIG_SETMASK, &watcher->old_mask, NULL);
+		pthread_mutex_destroy(&watcher->lock);
+		vagtplan_destroy(watcher->context);
+		return false;
+	}
+	return true;
+}
 
-		res = fscanf(fil,
-			" %50[^;,] %*1[;,] %32[^;,] %*1[;,] %32[^;,] %*1[;,] %u%*[^\n]\n", 
-			workers[*worker_count].name, day_text, shift_text, &workers[*worker_count].uuid
-		);
+void stop_signal_watcher(SignalWatcher* watcher) {
+	pthread_mutex_lock(&watcher->lock);
+	watcher->finished = true;
+	pthread_mutex_unlock(&watcher->lock);
+	pthread_kill(watcher->thread, SIGUSR1);
+	pthread_join(watcher->thread, NULL);
+	pthread_sigmask(SIG_SETMASK, &watcher->old_mask, NULL);
+	pthread_mutex_destroy(&watcher->lock);
+	vagtplan_destroy(watcher->context);
+}
 
-		if (res != 4) {
-			printf("Fejl i medarbejder liste på linje %u og kolonne %d\n", *worker_count + 1, res);
-			fatal_error(NULL);
+void* watch_signals(void* argument) {
+	SignalWatcher* watcher = argument;
+	for (;;) {
+		int signal_number;
+		bool finished;
+		if (sigwait(&watcher->signals, &signal_number) != 0) {
+			continue;
 		}
-
-		shift_text[32] = 0;
-		day_text[32] = 0;
-
-		workers[*worker_count].desired_day_off = string_to_day(day_text);
-		if (workers[*worker_count].desired_day_off == DAY_INVALID) {
-			printf("Fejl i medarbejder liste på linje %u ved dag: %s er invalid\n", *worker_count + 1, shift_text);
-			fatal_error(NULL);
+		pthread_mutex_lock(&watcher->lock);
+		finished = watcher->finished;
+		pthread_mutex_unlock(&watcher->lock);
+		if (finished) {
+			return NULL;
 		}
-
-		workers[*worker_count].desired_shift = string_to_shift(shift_text);
-		if (workers[*worker_count].desired_shift == SHIFT_INVALID) {
-			printf("Fejl i medarbejder liste på linje %u ved vagt: %s er invalid\n", *worker_count + 1, day_text);
-			fatal_error(NULL);
+		if (signal_number == SIGUSR1) {
+			save_progress(watcher);
+		} else {
+			printf("Stopper, den bedste vagtplan indtil nu bliver gemt\n");
+			vagtplan_request_stop(watcher->progress);
 		}
-
-		*worker_count += 1;
 	}
-	return realloc(workers, *worker_count * sizeof( Worker));
 }
 
-void fatal_error(const char* reason) {
-	if (reason != NULL) {
-		printf("Fatal fejl, programmet kan ikke fortsætte: %s\n", reason);
-	} else {
-		printf("Fatal fejl, programmet kan ikke fortsætte\n");
-	}
-	exit(EXIT_FAILURE);
+void save_progress(SignalWatcher* watcher) {
+	VagtplanSchedule* schedule;
+	unsigned int steps;
+	FILE* fil;
 
-}
-
-enum Shift string_to_shift(char* input) {
-	if (strcmp(input, "nat") == 0) {
-		return SHIFT_NIGHT;
-	} else if (strcmp(input, "dag") == 0) {
-		return SHIFT_DAY;
-	} else if (strcmp(input, "aften") == 0) {
-		return SHIFT_EVENING;
-	} else {
-		return SHIFT_INVALID;
+	if (vagtplan_progress_best(watcher->context, watcher->progress, &schedule, &steps) != VAGTPLAN_OK) {
+		printf("%s\n", vagtplan_error_message(watcher->context));
+		return;
 	}
-}
-
-enum Day string_to_day(char* input) {
-	if (strcmp(input, "mandag") == 0) {
-		return DAY_MONDAY;
-	} else if (strcmp(input, "tirsdag") == 0) {
-		return DAY_TUESDAY;
-	} else if (strcmp(input, "onsdag") == 0) {
-		return DAY_WEDNESDAY;
-	} else if (strcmp(input, "torsdag") == 0) {
-		return DAY_THURSDAY;
-	} else if (strcmp(input, "fredag") == 0) {
-		return DAY_FRIDAY;
-	} else if (strcmp(input, "lørdag") == 0) {
-		return DAY_SATURDAY;
-	} else if (strcmp(input, "søndag") == 0) {
-		return DAY_SUNDAY;
+	/*Filen bliver skrevet ved siden af og omdøbt, så den der læser den aldrig ser en halv vagtplan*/
+	fil = fopen(PROGRESS_TEMPORARY_FILE, "w");
+	if (fil == NULL) {
+		printf("Kunne ikke åbne %s\n", PROGRESS_TEMPORARY_FILE);
+	} else if (vagtplan_write_schedule(watcher->context, fil, schedule) != VAGTPLAN_OK) {
+		printf("%s\n", vagtplan_error_message(watcher->context));
+		fclose(fil);
+	} else if (fclose(fil) != 0 || rename(PROGRESS_TEMPORARY_FILE, PROGRESS_FILE) != 0) {
+		printf("Kunne ikke gemme %s\n", PROGRESS_FILE);
 	} else {
-		return DAY_INVALID;
+		printf("Den bedste vagtplan efter %u skridt har en score på %f og er gemt i %s\n", steps, vagtplan_schedule_score(schedule), PROGRESS_FILE);
 	}
+	vagtplan_free_schedule(watcher->context, schedule);
 }
-
-Schedule make_schedule(Worker* workers[], const unsigned int worker_count, const RequiredWorkers required_workers) {
-	Schedule *population = malloc(sizeof(struct Schedule) * POPULATION_SIZE);
-	int generation = 1;
+#endif
+
+void create_department_schedule(const CreateOptions* options) {
+	VagtplanContext* context;
+	RequiredWorkers* required_workers;
+	RequiredWorkers shared;
+	bool has_shared = false;
+	VagtplanSchedule* schedule;
+	unsigned int department_count;
 	unsigned int i;
-	Schedule rv;
-	generate_initial_population(required_workers, workers, worker_count, population, POPULATION_SIZE);
-
-	while (generation < 100000) {
-		for (i = 0; i < POPULATION_SIZE; i++) {
-			population[i].score = evaluate_schedule(&population[i], required_workers, workers, worker_count);
-		}
+	FILE* fil;
 
-		qsort(population, POPULATION_SIZE, sizeof(struct Schedule), compare_schedule);
-		if (generation % 1000 == 0) {
-			printf("Generation nummer %d. Max fitness er %f, værste: %f\n", generation, population[0].score, population[POPULATION_SIZE - 1].score);
+	if (options->seed_count > 0 || options->solver.alternatives > 1 || options->solver.islands > 1) {
+		fatal_error("--departments kan ikke bruges sammen med --seed, --top eller --islands");
+	}
+	context = open_context();
+	department_count = vagtplan_department_count(context);
+	required_workers = malloc(department_count * sizeof(RequiredWorkers));
+	if (required_workers == NULL) {
+		fatal_error("ikke nok hukkomelse");
+	}
+	/*Afdelinger uden deres egen bemanding deler bemanding.csv, som kun bliver læst en gang*/
+	for (i = 0; i < department_count; i++) {
+		if (read_department_staffing(context, vagtplan_department_name(context, i), &required_workers[i])) {
+			continue;
 		}
-		for (i = 0; i < AMOUNT_OF_BEST_INDIVIDUALS; i++) {
-			int random = random_number(AMOUNT_OF_BEST_INDIVIDUALS, POPULATION_SIZE - AMOUNT_OF_BEST_INDIVIDUALS * AMOUNT_OF_CHILDREN);
-			unsigned int j;
-			for (j = 0; j < AMOUNT_OF_CHILDREN; j++) {
-				combine_schedule(workers, worker_count, required_workers, &population[i], &population[random], &population[POPULATION_SIZE - AMOUNT_OF_BEST_INDIVIDUALS * AMOUNT_OF_CHILDREN + i * 4 + j]);
-			}
+		if (!has_shared) {
+			shared = read_staffing(context);
+			has_shared = true;
 		}
-		generation++;
-	}
-	qsort(population, POPULATION_SIZE, sizeof(struct Schedule), compare_schedule);
-	/*Vi skal deallkoere alt sammen undtagen den første som vi skal bruge*/
-	for (i = 1; i < POPULATION_SIZE; i++) {
-		free_schedule(&population[i]);
+		required_workers[i] = shared;
 	}
-	/*Så kopier vi den første schedule inden vi deallokerer den*/
-	rv = population[0];
-	free(population);
-	return rv;
-}
+	printf("Starter det genetiske algoritme for %u afdelinger\n", department_count);
 
-void generate_initial_population(struct RequiredWorkers required_workers, struct Worker *worker[], unsigned int worker_count, struct Schedule schedules[], unsigned int population_size) {
-	int i;
-	for (i = 0; i < population_size; i++) {
-		generate_random_schedule(worker, worker_count, required_workers, &schedules[i]);
-	}
-}
+	check(context, vagtplan_make_department_schedule(context, required_workers, &options->solver, &schedule));
 
-void generate_random_schedule(
-	Worker *workers[],
-	const unsigned int worker_count,
-	const RequiredWorkers required_workers,
-	Schedule *schedule
-) {
-	int day;
-
-	/*Foerste forloekke, repræsenterer de 7 dage i en uge.*/
-	for (day = 0; day < 7; day++)
-	{
-		/*workers_top assignes til at have samme værdi som worker_count, dette er fordi vi skal gemme vaedien af worker_count.*/
-		unsigned int workers_top = worker_count;
-		int shift;
-
-		/*Denne forloekke repræsenterer de 3 vagter på en dag, dette vil sige denne funktionen goere 3*7 gange.*/
-		for (shift = 0; shift < 3; shift++) {
-			/*Her bliver der aflokkeret plads til den maengde af medarbejder der skal bruges for den shift*/
-			int required_workers_for_shift = get_required_for_shift(required_workers, (enum Shift) shift);
-			unsigned int worker_index;
-			schedule->blocks[day * 3 + shift].workers = malloc(required_workers_for_shift * sizeof(struct Worker*));
-			if (schedule->blocks[day * 3 + shift].workers == NULL) {
-				fatal_error("Kunne ikke allokere mere hukommelse");
-			}
+	fil = open_file("lavet-vagtplan.csv", "w");
+	check(context, vagtplan_write_schedule(context, fil, schedule));
+	fclose(fil);
 
-			/*Her i denne forloekke bliver de medarbejdere indsat i det schedule*/
-			for (worker_index = 0; worker_index < required_workers_for_shift; worker_index++) {
+	free(required_workers);
+	vagtplan_destroy(context);
+}
 
-				/*Her finder vi en telfaeldig index, og derved finder en telfaeldig medarbejder*/
-				int random_index = random_number(0, workers_top);
-				Worker* tmp = NULL;
-				if (workers_top <= 0) {
-					fatal_error("Ikke nok medarbejdere til at lave en valid plan for en dag");
-				}
+void replan_published_schedule(const char* vagtplan_fil_navn, unsigned int uuid, const char* block_list, int max_changes) {
+	VagtplanContext* context = open_context();
+	VagtplanSchedule* published;
+	VagtplanSchedule* replanned;
+	unsigned int sick_worker;
+	unsigned long forbidden_blocks;
+	unsigned int changes;
+	double published_score;
+	clock_t start = clock();
+	unsigned int block;
+	unsigned int i;
+	FILE* fil;
 
-				/*Her indsaettes den tilfældige medarbejder ind i det nye skema.*/
-				schedule->blocks[day * 3 + shift].workers[worker_index] = workers[random_index];
+	check(context, vagtplan_find_worker(context, uuid, &sick_worker));
+	if (!vagtplan_parse_block_list(block_list, &forbidden_blocks)) {
+		fatal_error("Forkert formateret liste af blokke");
+	}
 
-				/*Her bliver den arbejder der er blevet sat ind i skema'et til sidst i arrayet, samtidig bliver counteren workers_top, sat en ned.
-				Derved kan det den tilfaeldige arbejder ikke tilgaas af*/
-				tmp = workers[random_index];
-				workers[random_index] = workers[workers_top - 1];
-				workers[workers_top - 1] = tmp; 
-				workers_top--; 
+	fil = open_file(vagtplan_fil_navn, "r");
+	check(context, vagtplan_read_schedule(context, fil, &published));
+	fclose(fil);
+	read_skill_requirements(context, vagtplan_schedule_requirements(published));
+	check(context, vagtplan_evaluate_schedule(context, published, &published_score));
+
+	check(context, vagtplan_replan_schedule(context, published, sick_worker, forbidden_blocks, max_changes, &replanned, &changes));
+
+	printf("Den udgivne vagtplan havde en score på %f, den nye har %f\n", published_score, vagtplan_schedule_score(replanned));
+	printf("%u ændringer, fundet på %.3f sekunder\n", changes, (double) (clock() - start) / CLOCKS_PER_SEC);
+	for (block = 0; block < 21; block++) {
+		for (i = 0; i < vagtplan_block_size(published, block); i++) {
+			unsigned int added = vagtplan_schedule_worker(replanned, block, i);
+			unsigned int removed = vagtplan_schedule_worker(published, block, i);
+			if (!block_has_worker(published, block, added)) {
+				printf("%s %s: +%s\n", vagtplan_day_name(block / 3), vagtplan_shift_name(block % 3), vagtplan_worker_name(context, added));
+			}
+			if (!block_has_worker(replanned, block, removed)) {
+				printf("%s %s: -%s\n", vagtplan_day_name(block / 3), vagtplan_shift_name(block % 3), vagtplan_worker_name(context, removed));
 			}
 		}
 	}
-}
 
-unsigned int get_required_for_shift(RequiredWorkers required_workers, enum Shift shift) {
-	switch (shift) {
-	case SHIFT_NIGHT:
-		return required_workers.night_workers;
-	case SHIFT_DAY:
-		return required_workers.day_workers;
-	case SHIFT_EVENING:
-		return required_workers.evening_workers;
-	default:
-		fatal_error("Program fejl1337");
-	}
-	return 0;
-}
-
-void set_required_for_shift(RequiredWorkers* required_workers, enum Shift shift, unsigned int val) {
-	switch (shift) {
-	case SHIFT_NIGHT:
-		required_workers->night_workers = val;
-		break;
-	case SHIFT_DAY:
-		required_workers->day_workers = val;
-		break;
-	case SHIFT_EVENING:
-		required_workers->evening_workers = val;
-		break;
-	default:
-		fatal_error("Program fejl4");
-	}
-}
+	fil = open_file("genplanlagt-vagtplan.csv", "w");
+	check(context, vagtplan_write_schedule(context, fil, replanned));
+	fclose(fil);
 
-int random_number(int min, int max) {
-	return (int) floor((double) min + (((double)rand()) / ((double) RAND_MAX + 1)) * ((double) max - (double) min));
+	vagtplan_destroy(context);
 }
 
-double evaluate_schedule(Schedule* schedule, const RequiredWorkers required_workers, Worker* worker[], unsigned int amount_of_workers){
-	unsigned int day, shift, worker_number;
-
-	unsigned int worker_i = 0;
-	for (worker_i = 0; worker_i < amount_of_workers; worker_i++) {
-		worker[worker_i]->last_block = -10;
-		worker[worker_i]->consecutive_night_shifts = 0;
-		worker[worker_i]->day_off = -1;
-	}
+void print_schedules(const char* vagtplan_fil_navn) {
+	VagtplanContext* context = open_context();
+	VagtplanSchedule* schedule;
+	PrintJob job;
+	FILE* fil = open_file(vagtplan_fil_navn, "r");
 
-	schedule->score = 0;
-	for (day = 0; day < 7 ; day++) {
+	check(context, vagtplan_read_schedule(context, fil, &schedule));
+	fclose(fil);
 
-		for (shift = 0; shift < 3; shift++) {
-			unsigned int block_number = day * 3 + shift;
-			unsigned int workers_needed = get_required_for_shift(required_workers, shift);
-			Worker** current_worker_array = (schedule->blocks[block_number]).workers;	
-			
-			for (worker_number = 0; worker_number < workers_needed; worker_number++) {
-				Worker* current_worker = current_worker_array[worker_number];
-				enum Day last_day;
+	/*Skemaerne bliver kun læst fra konteksten, så de kan skrives i alle trådene samtidig*/
+	job.context = context;
+	job.schedule = schedule;
+	check(context, vagtplan_parallel_for(context, 0, vagtplan_worker_count(context), PRINT_GRAIN, print_worker_files, &job));
 
-				/* Alle workers starter med day_off sat til minus 1, så hvis en worker ikke er i skemaet er værdien -1
-				Hvis de er med i skemaet og ikke får et fridøgn er den lig 0 */
-				if (current_worker->day_off == -1){
-					current_worker->day_off = 0;
-				}
+	vagtplan_destroy(context);
+}
 
-				/* Vi sørger for at last_day er en korrekt dag */
-				if (current_worker->last_block < 0){
-					last_day = DAY_INVALID;
-				} else {
-					last_day = current_worker->last_block / 3;
-				}
+void print_worker_files(void* argument, unsigned int thread, unsigned long begin, unsigned long end) {
+	const PrintJob* job = argument;
+	unsigned long worker_i;
+	char filnavn[100];
+	FILE* fil;
 
-				/* Tjekker preferred shift */
-				if (current_worker->desired_shift == shift){
-					schedule->score += 1;
-				} 
+	for (worker_i = begin; worker_i < end; worker_i++) {
+		sprintf(filnavn, "output/%s.%u.txt", vagtplan_worker_name(job->context, (unsigned int) worker_i), vagtplan_worker_uuid(job->context, (unsigned int) worker_i));
+		fil = open_file(filnavn, "w");
+		print_worker_schedule(fil, (unsigned int) worker_i, job->schedule);
+		fclose(fil);
+	}
+}
 
-				/*Tjekker 11 timers reglen*/
-				if(block_number - current_worker->last_block <= 2 && current_worker->last_block >= 0) {
-					schedule->score -= 1000;
-				}
-				/*Den opfylder ikke cyklisk hvis det er 1 dag siden man har arbejdet og 5 blokke siden, men hvis der er gået 2 dage så overholder den*/
-				if (day - last_day == 1 && block_number - current_worker->last_block == 5 && current_worker->last_block >= 0) {
-					schedule->score -= 1000;
-				}
-				/* Tjekker nattevagter i streg*/
-				if (shift == SHIFT_NIGHT) {
-					if (current_worker->last_block == block_number - 3){
-						if (current_worker->consecutive_night_shifts >= 2){
-							schedule->score -= 1000;
-						}
-					} else {
-						current_worker->consecutive_night_shifts = 0;
-					}
-					current_worker->consecutive_night_shifts += 1;
-				} else {
-					current_worker->consecutive_night_shifts = 0;
-				}
+int run_evaluator_check(RequiredWorkers required_workers, unsigned long schedule_count, const char* baseline_file_name) {
+	VagtplanContext* context = open_context();
+	VagtplanEvaluatorCheck results[VAGTPLAN_EVALUATOR_COUNT];
+	double baselines[VAGTPLAN_EVALUATOR_COUNT];
+	bool have_baseline = false;
+	bool failed = false;
+	char name[64];
+	double value;
+	FILE* fil;
+	unsigned int i;
 
-				/* Tjekker fridøgn, max af last_block og 0 fordi, hvis din første vagt er blok 6 har du haft et fridøgn */
-				if (block_number - maxi(current_worker->last_block, -1) > 5){
-					current_worker->day_off = 1;
-				}
-				
-				/* Sætter last shift*/
-				current_worker->last_block = block_number;
+	read_skill_requirements(context, &required_workers);
+	check(context, vagtplan_check_evaluators(context, required_workers, schedule_count, results));
 
-				/*Tjek preferred day*/
-				if (current_worker->desired_day_off == day) {
-					schedule->score -= 2;
+	for (i = 0; i < VAGTPLAN_EVALUATOR_COUNT; i++) {
+		baselines[i] = 0;
+	}
+	fil = baseline_file_name != NULL ? fopen(baseline_file_name, "r") : NULL;
+	if (fil != NULL) {
+		have_baseline = true;
+		while (fscanf(fil, " %63[^,],%lf", name, &value) == 2) {
+			for (i = 0; i < VAGTPLAN_EVALUATOR_COUNT; i++) {
+				if (strcmp(name, results[i].name) == 0) {
+					baselines[i] = value;
 				}
 			}
 		}
+		fclose(fil);
 	}
-	
-	/* Tjekker om der har været fridøgn*/
-	for (worker_i = 0; worker_i < amount_of_workers; worker_i++) {
-		if (worker[worker_i]->day_off == 0) {
-			if (!(worker[worker_i]->last_block > 0 && 21 - worker[worker_i]->last_block > 5)) {
-				schedule->score -= 1000;
+
+	for (i = 0; i < VAGTPLAN_EVALUATOR_COUNT; i++) {
+		printf("%-20s %10lu evalueringer, %6lu forskelle, %12.0f per sekund", results[i].name, results[i].evaluations, results[i].mismatches, results[i].evaluations_per_second);
+		if (baselines[i] > 0) {
+			printf(", %3.0f%% af baseline", 100 * results[i].evaluations_per_second / baselines[i]);
+			if (results[i].evaluations_per_second < baselines[i] * BASELINE_TOLERANCE) {
+				printf(" GÅET TILBAGE");
+				failed = true;
 			}
 		}
-	}
-
-	return schedule->score;
-}
-
-int compare_schedule(const void* a, const void* b) {
-	const  Schedule* sa = a;
-	const  Schedule* sb = b;
-
-	return sb->score - sa->score;
-}
-
-void combine_schedule(Worker* workers[], unsigned int worker_count, RequiredWorkers required_workers, const  Schedule* a, const  Schedule* b,  Schedule* out) {
-	int crossover_start = random_number(0, 20);
-	int crossover_end = random_number(crossover_start + 1, 21);
-	const BlockSchedule* a_block = (const  BlockSchedule*) a->blocks;
-	const BlockSchedule* b_block = (const  BlockSchedule*) b->blocks;
-	BlockSchedule* out_block = ( BlockSchedule*) out->blocks;
-
-	int j;
-
-	for (j = 0; j < 21; j++) {
-		if (j >= crossover_start && j < crossover_end) {
-			memcpy(out_block[j].workers, b_block[j].workers, get_required_for_shift(required_workers, j % 3) * sizeof(Worker*));
-		} else {
-			memcpy(out_block[j].workers, a_block[j].workers, get_required_for_shift(required_workers, j % 3) * sizeof(Worker*));
+		printf("\n");
+		if (results[i].mismatches > 0) {
+			failed = true;
 		}
 	}
-	if (rand() % 3 == 0) {
-		int random_block_index = random_number(0, 21);
-		int i;
-		int top = worker_count;
-		int needed_workers = get_required_for_shift(required_workers, random_block_index % 3);
-		for (i = 0; i < needed_workers; i++) {
-			int random_index = random_number(0, top);
-			Worker* tmp = NULL;
-			if (j <= 0) {
-				fatal_error("Ikke nok medarbejdere til at lave en valid plan for en dag");
-			}
-			out_block[random_block_index].workers[i] = workers[random_index];
-			tmp = workers[random_index];
-			workers[random_index] = workers[top - 1];
-			workers[top - 1] = tmp; 
-			top--; 
+
+	if (baseline_file_name != NULL && !have_baseline) {
+		fil = open_file(baseline_file_name, "w");
+		for (i = 0; i < VAGTPLAN_EVALUATOR_COUNT; i++) {
+			fprintf(fil, "%s,%f\n", results[i].name, results[i].evaluations_per_second);
 		}
+		fclose(fil);
+		printf("Gemte baseline i %s\n", baseline_file_name);
 	}
+	vagtplan_destroy(context);
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
 }
 
-Schedule read_schedule(FILE* file, RequiredWorkers* out, Worker** workers, unsigned int worker_count) {
-	Schedule rv;
-	unsigned int block_id;
-	int res = 0;
-	char shift_string[33];
-	char day_string[33];
-	out->night_workers = 0;
-	out->day_workers = 0;
-	out->evening_workers = 0;
-	for (block_id = 0; block_id < 21; block_id++) {
-		unsigned int allocated_workers = 10;
-		unsigned int workers_read = 0;
-		unsigned int amount_required = get_required_for_shift(*out, block_id % 3);
-		if (feof(file)) {
-			fatal_error("Forkert formateret vagtplan");
+int client_request(const char* socket_path, int argc, char** argv) {
+	ServerRequest request;
+	ServerResponse response;
+	const char* output = NULL;
+	char* workers;
+	char* schedule = NULL;
+	char* availability = NULL;
+	VagtplanContext* context;
+	FILE* fil;
+
+	memset(&request, 0, sizeof(request));
+	request.max_changes = -1;
+	if (strcmp(argv[0], "solve") == 0) {
+		CreateOptions options;
+		unsigned int night_workers;
+		unsigned int day_workers;
+		unsigned int evening_workers;
+		if (argc < 4 || sscanf(argv[1], "%u", &night_workers) != 1
+			|| sscanf(argv[2], "%u", &day_workers) != 1
+			|| sscanf(argv[3], "%u", &evening_workers) != 1
+			|| !parse_solver_options(argc - 4, argv + 4, &options)) {
+			printf("Brug: client <sokkel> solve <nat> <dag> <aften> [--engine X] [--generations N] [--time sekunder]\n");
+			return EXIT_FAILURE;
 		}
-		
-		res = fscanf(file,
-			" %32[^;,] %*1[;,] %32[^;,] %*1[;,]", 
-			day_string, shift_string
-		);
-
-		rv.blocks[block_id].workers = malloc(allocated_workers * sizeof(Worker*));
-
-		if (rv.blocks[block_id].workers == NULL) {
-			fatal_error("kunne ikke allokere hukommelse");
+		request.required_workers = vagtplan_required_per_shift(night_workers, day_workers, evening_workers);
+		if (options.seed_count > 0 || options.solver.islands > 1 || options.departments) {
+			fatal_error("--seed, --islands og --departments kan ikke bruges gennem serveren");
 		}
-
-		while (true) {
-			char name_buffer[MAX_NAME_LENGTH + 1];
-			unsigned int uuid_read;
-			int end_char = 0;
-			if (feof(file)) {
-				fatal_error("Forkert formateret vagtplan");
-			}
-			if (workers_read + 1 > allocated_workers) {
-				allocated_workers += 10;
-				rv.blocks[block_id].workers = realloc(rv.blocks[block_id].workers, allocated_workers * sizeof(Worker*));
-				if (rv.blocks[block_id].workers == NULL) {
-					fatal_error("kunne ikke allokere hukommelse");
-				}
-			}
-
-			res = fscanf(file, " %50[^.].%u %*1[;,] ", name_buffer,  &uuid_read);
-			if (res != 2) {
-				fatal_error("Forkert formateret vagtplan");
-			}
-			name_buffer[MAX_NAME_LENGTH] = 0;
-
-			rv.blocks[block_id].workers[workers_read] = find_worker_from_uuid(workers, worker_count, uuid_read);
-			if (rv.blocks[block_id].workers[workers_read] == NULL) {
-				fatal_error("Forkert uuid");
-			}
-			workers_read++;
-			end_char = fgetc(file);
-			if (end_char == '$') {
-				break;
-			}
-			ungetc(end_char, file);
+		context = vagtplan_create(NULL, 0);
+		if (context == NULL) {
+			fatal_error("ikke nok hukkomelse");
 		}
-		fscanf(file, "%*[^\n]\n");
-		if (amount_required == 0) {
-			set_required_for_shift(out, block_id % 3, workers_read);
-		} else {
-			if (amount_required != workers_read) {
-				printf("%u, %u\n", amount_required, workers_read);
-				fatal_error("Forkert mængde medarbejdere sat");
-			}
+		read_skill_requirements(context, &request.required_workers);
+		vagtplan_destroy(context);
+		request.command = SERVER_SOLVE;
+		request.engine = options.solver.engine;
+		request.generations = options.solver.generations;
+		request.time_limit_ms = (unsigned int) (options.solver.time_limit * 1000);
+		output = "lavet-vagtplan.csv";
+	} else if (strcmp(argv[0], "score") == 0 && argc >= 2) {
+		request.command = SERVER_SCORE;
+		schedule = read_file(argv[1], &request.schedule_length);
+	} else if (strcmp(argv[0], "replan") == 0 && argc >= 4) {
+		request.command = SERVER_REPLAN;
+		if (sscanf(argv[2], "%u", &request.uuid) != 1 || !vagtplan_parse_block_list(argv[3], &request.blocks)
+			|| (argc >= 5 && (sscanf(argv[4], "%d", &request.max_changes) != 1 || request.max_changes < 0))) {
+			printf("Brug: client <sokkel> replan <vagtplan> <uuid> <blokke> [max ændringer]\n");
+			return EXIT_FAILURE;
 		}
+		schedule = read_file(argv[1], &request.schedule_length);
+		output = "genplanlagt-vagtplan.csv";
+	} else {
+		printf("Ukendt kommando til serveren, brug solve, score eller replan\n");
+		return EXIT_FAILURE;
+	}
+	workers = read_file("medarbejdere.csv", &request.workers_length);
+	request.workers = workers;
+	request.schedule = schedule;
+	fil = fopen("fravaer.csv", "rb");
+	if (fil != NULL) {
+		fclose(fil);
+		availability = read_file("fravaer.csv", &request.availability_length);
+		request.availability = availability;
 	}
-	return rv;
-}
 
-void write_schedule(FILE* file, const  Schedule* schedule, RequiredWorkers required_workers) {
-	unsigned int block_id;
-	for (block_id = 0; block_id < 21; block_id++) {
-		unsigned int amount_of_workers = get_required_for_shift(required_workers, block_id % 3);
-		unsigned int i;
-		fprintf(file, "%s,%s", get_day_as_string(block_id / 3), get_shift_as_string(block_id % 3));
-		for (i = 0; i < amount_of_workers; i++) {
-			fprintf(file, ",%s.%u", schedule->blocks[block_id].workers[i]->name, schedule->blocks[block_id].workers[i]->uuid);
-		}
-		fprintf(file, ",$\n");
+	if (!server_call(socket_path, &request, &response)) {
+		fatal_error("Kunne ikke få svar fra serveren");
 	}
-}
-
-Worker* find_worker_from_uuid(Worker** workers, unsigned int worker_count, unsigned int uuid) {
-	unsigned int i = 0;
-	for (i = 0; i < worker_count; i++) {
-		if (workers[i]->uuid == uuid) {
-			return workers[i];
-		}
+	free(workers);
+	free(schedule);
+	free(availability);
+	if (response.status != VAGTPLAN_OK) {
+		fatal_error(response.body);
 	}
-	return NULL;
-}
 
-const char* get_day_as_string(enum Day day){
-	switch (day) {
-	case DAY_MONDAY:
-		return "mandag";
-		break;
-	case DAY_TUESDAY:
-		return "tirsdag";
-	case DAY_WEDNESDAY:
-		return "onsdag";
-	case DAY_THURSDAY:
-		return "torsdag";
-	case DAY_FRIDAY:
-		return "fredag";
-	case DAY_SATURDAY:
-		return "lørdag";
-	case DAY_SUNDAY:
-		return "søndag";
-	case DAY_INVALID:
-		return "invalid";
-	default:
-		break;
-	}
-	fatal_error("Program fejl2");
-	return "";
-}
-
-const char* get_shift_as_string(enum Shift shift) {
-	switch (shift) {
-	case SHIFT_NIGHT:
-		return "nat";
-	case SHIFT_DAY:
-		return "dag";
-	case SHIFT_EVENING: 
-		return "aften";
-	case SHIFT_INVALID:
-		return "ingen";
-	}
-	fatal_error("Program fejl1");
-	return "";
+	printf("Vagtplanen fik en score på %f\n", response.score);
+	if (request.command == SERVER_REPLAN) {
+		printf("%u ændringer\n", response.changes);
+	}
+	if (output != NULL) {
+		fil = open_file(output, "wb");
+		fwrite(response.body, 1, response.body_length, fil);
+		fclose(fil);
+	}
+	free(response.body);
+	return EXIT_SUCCESS;
 }
 
-void print_worker_schedule(FILE* file, const Worker* worker, const Schedule* schedule, RequiredWorkers required_workers) {
+void print_worker_schedule(FILE* file, unsigned int worker, const VagtplanSchedule* schedule) {
 	unsigned int day;
 	unsigned int shift;
 	fprintf(file,
@@ -803,16 +860,7 @@ void print_worker_schedule(FILE* file, const Worker* worker, const Schedule* sch
 	for (shift = 0; shift < 3; shift++) {
 		fprintf(file, "|%s|", get_time_slot(shift));
 		for (day = 0; day < 7; day++) {
-			unsigned int worker_i;
-			unsigned int amount_of_workers = get_required_for_shift(required_workers, shift);
-			int found = 0;
-			for (worker_i = 0; worker_i < amount_of_workers; worker_i++) {
-				if (worker->uuid == schedule->blocks[shift + day * 3].workers[worker_i]->uuid) {
-					found = 1;
-					break;
-				}
-			}
-			if (found)  {
+			if (block_has_worker(schedule, shift + day * 3, worker))  {
 				fprintf(file, "#######|");
 			} else {
 				fprintf(file, "       |");
@@ -837,42 +885,93 @@ const char* get_time_slot(enum Shift shift) {
 	}
 }
 
-RequiredWorkers input_required_workers() {
+RequiredWorkers read_staffing(VagtplanContext* context) {
 	RequiredWorkers rv;
+	FILE* fil = fopen("bemanding.csv", "r");
+	if (fil == NULL) {
+		rv = input_required_workers();
+	} else {
+		check(context, vagtplan_read_required_workers(context, fil, &rv));
+		fclose(fil);
+		printf("Bemandingen er læst fra bemanding.csv\n");
+	}
+	read_skill_requirements(context, &rv);
+	return rv;
+}
+
+void read_skill_requirements(VagtplanContext* context, RequiredWorkers* required_workers) {
+	FILE* fil = fopen("kvalifikationer.csv", "r");
+	if (fil == NULL) {
+		return;
+	}
+	check(context, vagtplan_read_skill_requirements(context, fil, required_workers));
+	fclose(fil);
+	printf("Kravene til kvalifikationer er læst fra kvalifikationer.csv\n");
+}
+
+bool read_department_staffing(VagtplanContext* context, const char* department, RequiredWorkers* out) {
+	char file_name[80];
+	FILE* fil;
+
+	if (department[0] == 0) {
+		return false;
+	}
+	sprintf(file_name, "bemanding-%s.csv", department);
+	fil = fopen(file_name, "r");
+	if (fil == NULL) {
+		return false;
+	}
+	check(context, vagtplan_read_required_workers(context, fil, out));
+	fclose(fil);
+	printf("Bemandingen for %s er læst fra %s\n", department, file_name);
+
+	sprintf(file_name, "kvalifikationer-%s.csv", department);
+	fil = fopen(file_name, "r");
+	if (fil == NULL) {
+		read_skill_requirements(context, out);
+		return true;
+	}
+	check(context, vagtplan_read_skill_requirements(context, fil, out));
+	fclose(fil);
+	printf("Kravene til kvalifikationer for %s er læst fra %s\n", department, file_name);
+	return true;
+}
+
+RequiredWorkers input_required_workers() {
 	int res;
 	int antallet_indtastet;
+	unsigned int night_workers;
+	unsigned int day_workers;
 	printf("Indtast antallet af nat arbejdere: ");
 
 	res = scanf(" %d", &antallet_indtastet);
 	if (res != 1 || antallet_indtastet < 1) {
 		fatal_error("Forkert formateret tal, det skal være et positivt heltal");
 	}
-	rv.night_workers = antallet_indtastet;
-	
+	night_workers = antallet_indtastet;
+
 	printf("Indtast antallet af dag arbejdere: ");
 	res = scanf(" %d", &antallet_indtastet);
 	if (res != 1 || antallet_indtastet < 1) {
 		fatal_error("Forkert formateret tal, det skal være et positivt heltal");
 	}
-	rv.day_workers = antallet_indtastet;
+	day_workers = antallet_indtastet;
 
 	printf("Indtast antallet af aften arbejdere: ");
 	res = scanf(" %d", &antallet_indtastet);
 	if (res != 1 || antallet_indtastet < 1) {
 		fatal_error("Forkert formateret tal, det skal være et positivt heltal");
 	}
-	rv.evening_workers = antallet_indtastet;
 
-	return rv;
+	return vagtplan_required_per_shift(night_workers, day_workers, antallet_indtastet);
 }
 
-void free_schedule(Schedule* schedule) {
-	unsigned int i;
-	for (i = 0; i < 21; i++) {
-		free(schedule->blocks[i].workers);
+void fatal_error(const char* reason) {
+	if (reason != NULL) {
+		printf("Fatal fejl, programmet kan ikke fortsætte: %s\n", reason);
+	} else {
+		printf("Fatal fejl, programmet kan ikke fortsætte\n");
 	}
-}
+	exit(EXIT_FAILURE);
 
-int maxi(int a, int b) {
-	return a > b ? a : b;
-}
\ No newline at end of file
+}
@@ -1,4 +1,4 @@
 @echo off
 @chcp 65001>nul
-gcc -ansi -Wall -pedantic main.c -o a.exe
+gcc -ansi -Wall -pedantic main.c vagtplan.c server.c -o a.exe
 a.exe
\ No newline at end of file
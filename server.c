@@ -0,0 +1,791 @@
+#if defined(__unix__) || defined(__APPLE__)
+#define _POSIX_C_SOURCE 200809L
+#define SERVER_SUPPORTED
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+
+#ifdef SERVER_SUPPORTED
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#endif
+
+#include "server.h"
+
+#define SERVER_MAX_THREADS 64
+#define SERVER_QUEUE_SIZE 64
+#define SERVER_CACHE_SIZE 16
+#define SERVER_MAX_FRAME (16UL * 1024 * 1024)
+#define SERVER_DEFAULT_TIME_LIMIT 5.0
+#define SERVER_MAX_TIME_LIMIT 300.0
+#define SERVER_REQUEST_HEADER 200
+#define SERVER_RESPONSE_HEADER 16
+/*Hvor længe serveren højst venter på en klient der er gået i stå midt i en ramme*/
+#define SERVER_IO_TIMEOUT_SECONDS 5
+
+#ifdef SERVER_SUPPORTED
+
+/**
+ * En medarbejderliste der allerede er læst, fundet igen på en hash af CSV teksten
+ */
+typedef struct WorkerCacheEntry {
+	unsigned long hash;
+	char* text;
+	size_t length;
+	VagtplanContext* context;
+	unsigned long last_used;
+} WorkerCacheEntry;
+
+/**
+ * Alt hvad trådene deler. Forbindelserne ligger i en ringbuffer som accept løkken fylder og trådene tømmer
+ */
+typedef struct Server {
+	pthread_mutex_t lock;
+	pthread_cond_t queue_changed;
+	int queue[SERVER_QUEUE_SIZE];
+	unsigned int queue_start;
+	unsigned int queue_count;
+	bool stopping;
+	/*Forbindelserne trådene er i gang med, -1 er en ledig plads. Bliver lukket for læsning når serveren stopper*/
+	int active[SERVER_MAX_THREADS];
+	WorkerCacheEntry cache[SERVER_CACHE_SIZE];
+	unsigned long cache_clock;
+	unsigned long requests;
+} Server;
+
+typedef struct ByteBuffer {
+	unsigned char* data;
+	size_t length;
+	size_t allocated;
+	bool failed;
+} ByteBuffer;
+
+/**
+ * Tråden der tager forbindelser fra køen og besvarer dem
+ */
+void* server_thread(void* argument);
+
+/**
+ * Besvarer den ene forespørgsel klienten sender på forbindelsen
+ */
+void server_connection(Server* server, int fd);
+
+/**
+ * Løser en enkelt forespørgsel i en ny kontekst
+ */
+void server_handle(Server* server, const ServerRequest* request, ServerResponse* response);
+
+/**
+ * Giver konteksten medarbejderlisten fra forespørgslen, fra cachen hvis den er læst før
+ */
+enum VagtplanStatus server_load_workers(Server* server, VagtplanContext* context, const char* text, size_t length);
+
+unsigned long hash_text(const char* text, size_t length);
+
+/**
+ * Laver en FILE* der læser fra hukommelsen, så bibliotekets læsefunktioner kan bruges direkte
+ */
+FILE* open_text(const char* text, size_t length);
+
+void encode_request(ByteBuffer* buffer, const ServerRequest* request);
+bool decode_request(const unsigned char* data, size_t length, ServerRequest* request);
+void encode_response(ByteBuffer* buffer, const ServerResponse* response);
+bool decode_response(const unsigned char* data, size_t length, ServerResponse* response);
+
+void buffer_put_u32(ByteBuffer* buffer, unsigned long value);
+void buffer_put_bytes(ByteBuffer* buffer, const void* data, size_t length);
+unsigned long get_u32(const unsigned char* data);
+
+/**
+ * Læser en hel ramme, en længde på 4 byte i netværksrækkefølge efterfulgt af indholdet
+ * @returns indholdet som skal frigives med free, eller NULL hvis forbindelsen er lukket eller rammen er forkert
+ */
+unsigned char* read_frame(int fd, size_t* length);
+bool write_frame(int fd, const ByteBuffer* buffer);
+bool read_full(int fd, void* data, size_t length);
+bool write_full(int fd, const void* data, size_t length);
+
+void handle_stop_signal(int signal_number);
+
+volatile sig_atomic_t stop_signal = 0;
+
+int serve(const char* socket_path, unsigned int threads) {
+	Server server;
+	pthread_t workers[SERVER_MAX_THREADS];
+	struct sockaddr_un address;
+	struct sigaction action;
+	struct timeval timeout;
+	sigset_t stop_signals;
+	unsigned int started = 0;
+	unsigned int i;
+	int listener;
+
+	if (threads < 1 || threads > SERVER_MAX_THREADS) {
+		printf("Antallet af tråde skal være mellem 1 og %d\n", SERVER_MAX_THREADS);
+		return EXIT_FAILURE;
+	}
+	if (strlen(socket_path) >= sizeof(address.sun_path)) {
+		printf("Stien til soklen er for lang\n");
+		return EXIT_FAILURE;
+	}
+
+	memset(&server, 0, sizeof(server));
+	for (i = 0; i < SERVER_MAX_THREADS; i++) {
+		server.active[i] = -1;
+	}
+	pthread_mutex_init(&server.lock, NULL);
+	pthread_cond_init(&server.queue_changed, NULL);
+
+	/*Uden SA_RESTART vender accept tilbage når der kommer et signal, så løkken kan stoppe*/
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = handle_stop_signal;
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGINT, &action, NULL);
+	sigaction(SIGTERM, &action, NULL);
+	/*En klient der lukker før den har fået svar må ikke stoppe serveren*/
+	action.sa_handler = SIG_IGN;
+	sigaction(SIGPIPE, &action, NULL);
+
+	listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listener < 0) {
+		printf("Kunne ikke lave soklen\n");
+		return EXIT_FAILURE;
+	}
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, socket_path);
+	unlink(socket_path);
+	if (bind(listener, (struct sockaddr*) &address, sizeof(address)) != 0 || listen(listener, SERVER_QUEUE_SIZE) != 0) {
+		printf("Kunne ikke lytte på %s\n", socket_path);
+		close(listener);
+		return EXIT_FAILURE;
+	}
+
+	/*Trådene arver masken, så signalerne altid rammer accept løkken*/
+	sigemptyset(&stop_signals);
+	sigaddset(&stop_signals, SIGINT);
+	sigaddset(&stop_signals, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &stop_signals, NULL);
+	for (i = 0; i < threads; i++) {
+		if (pthread_create(&workers[i], NULL, server_thread, &server) != 0) {
+			break;
+		}
+		started++;
+	}
+	pthread_sigmask(SIG_UNBLOCK, &stop_signals, NULL);
+	if (started == 0) {
+		printf("Kunne ikke starte trådene\n");
+		close(listener);
+		unlink(socket_path);
+		return EXIT_FAILURE;
+	}
+	printf("Lytter på %s med %u tråde\n", socket_path, started);
+	fflush(stdout);
+
+	timeout.tv_sec = SERVER_IO_TIMEOUT_SECONDS;
+	timeout.tv_usec = 0;
+	while (!stop_signal) {
+		int fd = accept(listener, NULL, NULL);
+		if (fd < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			printf("Fejl i accept, stopper\n");
+			break;
+		}
+		/*En klient der ikke sender noget må ikke holde en tråd fast*/
+		setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+		setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+		pthread_mutex_lock(&server.lock);
+		/*Når køen er fuld venter vi på trådene i stedet for at afvise klienten*/
+		while (server.queue_count == SERVER_QUEUE_SIZE) {
+			pthread_cond_wait(&server.queue_changed, &server.lock);
+		}
+		server.queue[(server.queue_start + server.queue_count) % SERVER_QUEUE_SIZE] = fd;
+		server.queue_count++;
+		pthread_cond_broadcast(&server.queue_changed);
+		pthread_mutex_unlock(&server.lock);
+	}
+
+	pthread_mutex_lock(&server.lock);
+	server.stopping = true;
+	/*Det der allerede er sendt kan stadig læses, men en tråd der venter på mere vågner med det samme*/
+	for (i = 0; i < SERVER_MAX_THREADS; i++) {
+		if (server.active[i] >= 0) {
+			shutdown(server.active[i], SHUT_RD);
+		}
+	}
+	pthread_cond_broadcast(&server.queue_changed);
+	pthread_mutex_unlock(&server.lock);
+	for (i = 0; i < started; i++) {
+		pthread_join(workers[i], NULL);
+	}
+
+	close(listener);
+	unlink(socket_path);
+	for (i = 0; i < SERVER_CACHE_SIZE; i++) {
+		if (server.cache[i].context != NULL) {
+			vagtplan_destroy(server.cache[i].context);
+			free(server.cache[i].text);
+		}
+	}
+	pthread_cond_destroy(&server.queue_changed);
+	pthread_mutex_destroy(&server.lock);
+	printf("Serveren stoppede efter %lu forespørgsler\n", server.requests);
+	return EXIT_SUCCESS;
+}
+
+void* server_thread(void* argument) {
+	Server* server = argument;
+	while (true) {
+		unsigned int slot = 0;
+		int fd;
+		pthread_mutex_lock(&server->lock);
+		while (server->queue_count == 0 && !server->stopping) {
+			pthread_cond_wait(&server->queue_changed, &server->lock);
+		}
+		/*Forbindelser der allerede er i køen bliver besvaret før tråden stopper*/
+		if (server->queue_count == 0) {
+			pthread_mutex_unlock(&server->lock);
+			return NULL;
+		}
+		fd = server->queue[server->queue_start];
+		server->queue_start = (server->queue_start + 1) % SERVER_QUEUE_SIZE;
+		server->queue_count--;
+		/*Der er en plads til hver tråd, så der er altid en ledig*/
+		while (server->active[slot] >= 0) {
+			slot++;
+		}
+		server->active[slot] = fd;
+		if (server->stopping) {
+			shutdown(fd, SHUT_RD);
+		}
+		pthread_cond_broadcast(&server->queue_changed);
+		pthread_mutex_unlock(&server->lock);
+
+		server_connection(server, fd);
+
+		/*Pladsen bliver givet fri før fd lukkes, så en anden forbindelse med samme nummer ikke bliver lukket*/
+		pthread_mutex_lock(&server->lock);
+		server->active[slot] = -1;
+		pthread_mutex_unlock(&server->lock);
+		close(fd);
+	}
+}
+
+void server_connection(Server* server, int fd) {
+	ServerRequest request;
+	ServerResponse response;
+	ByteBuffer buffer = {NULL, 0, 0, false};
+	unsigned char* frame;
+	size_t length;
+
+	/*Klienten sender kun en forespørgsel per forbindelse, så tråden er fri igen når den er besvaret*/
+	frame = read_frame(fd, &length);
+	if (frame == NULL) {
+		return;
+	}
+	if (!decode_request(frame, length, &request)) {
+		free(frame);
+		return;
+	}
+	server_handle(server, &request, &response);
+	encode_response(&buffer, &response);
+	if (!buffer.failed) {
+		write_frame(fd, &buffer);
+	}
+	free(buffer.data);
+	free(response.body);
+	free(frame);
+}
+
+void server_handle(Server* server, const ServerRequest* request, ServerResponse* response) {
+	VagtplanContext* context;
+	VagtplanSchedule* schedule = NULL;
+	VagtplanSchedule* result = NULL;
+	enum VagtplanStatus status;
+	const char* message;
+	unsigned long request_number;
+	FILE* file;
+
+	pthread_mutex_lock(&server->lock);
+	server->requests++;
+	request_number = server->requests;
+	pthread_mutex_unlock(&server->lock);
+
+	response->score = 0;
+	response->changes = 0;
+	response->body = NULL;
+	response->body_length = 0;
+
+	/*Hver forespørgsel får sin egen kontekst, så trådene aldrig deler tilstand i biblioteket*/
+	context = vagtplan_create(NULL, (unsigned long) time(NULL) ^ (request_number * 2654435761UL));
+	if (context == NULL) {
+		response->status = VAGTPLAN_ERROR_MEMORY;
+		return;
+	}
+
+	status = server_load_workers(server, context, request->workers, request->workers_length);
+	/*Fraværet bliver sat på kopien, så den gemte medarbejderliste er den samme for alle forespørgsler*/
+	if (status == VAGTPLAN_OK && request->availability_length > 0) {
+		file = open_text(request->availability, request->availability_length);
+		status = file == NULL ? VAGTPLAN_ERROR_SYSTEM : vagtplan_read_availability(context, file);
+		if (file != NULL) {
+			fclose(file);
+		}
+	}
+	if (status == VAGTPLAN_OK && request->command != SERVER_SOLVE) {
+		file = open_text(request->schedule, request->schedule_length);
+		status = file == NULL ? VAGTPLAN_ERROR_SYSTEM : vagtplan_read_schedule(context, file, &schedule);
+		if (file != NULL) {
+			fclose(file);
+		}
+	}
+
+	if (status == VAGTPLAN_OK) {
+		switch (request->command) {
+		case SERVER_SOLVE: {
+			SolverOptions options;
+			vagtplan_default_options(&options);
+			options.engine = request->engine;
+			if (request->generations > 0) {
+				options.generations = request->generations;
+			}
+			/*options.islands er altid 1, tråde og fork passer ikke sammen*/
+			options.time_limit = request->time_limit_ms > 0 ? request->time_limit_ms / 1000.0 : SERVER_DEFAULT_TIME_LIMIT;
+			if (options.time_limit > SERVER_MAX_TIME_LIMIT) {
+				options.time_limit = SERVER_MAX_TIME_LIMIT;
+			}
+			status = vagtplan_make_schedule(context, request->required_workers, &options, NULL, 0, &result);
+			break;
+		}
+		case SERVER_SCORE:
+			status = vagtplan_evaluate_schedule(context, schedule, &response->score);
+			break;
+		case SERVER_REPLAN: {
+			unsigned int worker;
+			status = vagtplan_find_worker(context, request->uuid, &worker);
+			if (status == VAGTPLAN_OK) {
+				status = vagtplan_replan_schedule(context, schedule, worker, request->blocks, request->max_changes, &result, &response->changes);
+			}
+			break;
+		}
+		}
+	}
+
+	if (status == VAGTPLAN_OK && result != NULL) {
+		response->score = vagtplan_schedule_score(result);
+		file = open_memstream(&response->body, &response->body_length);
+		if (file == NULL) {
+			status = VAGTPLAN_ERROR_SYSTEM;
+		} else {
+			status = vagtplan_write_schedule(context, file, result);
+			fclose(file);
+		}
+	}
+
+	response->status = status;
+	if (status != VAGTPLAN_OK) {
+		free(response->body);
+		message = vagtplan_error_message(context);
+		if (message[0] == 0) {
+			message = "Serveren kunne ikke skrive svaret";
+		}
+		response->body_length = strlen(message);
+		response->body = malloc(response->body_length + 1);
+		if (response->body != NULL) {
+			strcpy(response->body, message);
+		} else {
+			response->body_length = 0;
+		}
+	}
+	vagtplan_destroy(context);
+}
+
+enum VagtplanStatus server_load_workers(Server* server, VagtplanContext* context, const char* text, size_t length) {
+	unsigned long hash = hash_text(text, length);
+	WorkerCacheEntry* entry = NULL;
+	VagtplanContext* parsed;
+	enum VagtplanStatus status;
+	bool cached;
+	FILE* file;
+	unsigned int i;
+
+	pthread_mutex_lock(&server->lock);
+	for (i = 0; i < SERVER_CACHE_SIZE; i++) {
+		WorkerCacheEntry* candidate = &server->cache[i];
+		if (candidate->context != NULL && candidate->hash == hash && candidate->length == length && memcmp(candidate->text, text, length) == 0) {
+			/*Kopien bliver lavet mens låsen holdes, så posten ikke kan blive smidt ud imens*/
+			candidate->last_used = ++server->cache_clock;
+			status = vagtplan_copy_workers(context, candidate->context);
+			pthread_mutex_unlock(&server->lock);
+			return status;
+		}
+	}
+	pthread_mutex_unlock(&server->lock);
+
+	/*Listen bliver læst uden låsen, så andre forespørgsler ikke venter på den*/
+	parsed = vagtplan_create(NULL, 1);
+	if (parsed == NULL) {
+		return VAGTPLAN_ERROR_MEMORY;
+	}
+	file = open_text(text, length);
+	if (file == NULL) {
+		vagtplan_destroy(parsed);
+		return VAGTPLAN_ERROR_SYSTEM;
+	}
+	status = vagtplan_read_workers(parsed, file);
+	fclose(file);
+	if (status != VAGTPLAN_OK) {
+		/*Fejlen skal stå i forespørgslens kontekst, så den bliver læst igen der*/
+		vagtplan_destroy(parsed);
+		file = open_text(text, length);
+		if (file == NULL) {
+			return VAGTPLAN_ERROR_SYSTEM;
+		}
+		status = vagtplan_read_workers(context, file);
+		fclose(file);
+		return status;
+	}
+
+	pthread_mutex_lock(&server->lock);
+	for (i = 0; i < SERVER_CACHE_SIZE; i++) {
+		if (entry == NULL || server->cache[i].context == NULL || (entry->context != NULL && server->cache[i].last_used < entry->last_used)) {
+			entry = &server->cache[i];
+		}
+	}
+	if (entry->context != NULL) {
+		vagtplan_destroy(entry->context);
+		free(entry->text);
+		entry->context = NULL;
+	}
+	entry->text = malloc(length);
+	if (entry->text != NULL) {
+		memcpy(entry->text, text, length);
+		entry->hash = hash;
+		entry->length = length;
+		entry->context = parsed;
+		entry->last_used = ++server->cache_clock;
+	}
+	status = vagtplan_copy_workers(context, parsed);
+	/*Posten kan blive smidt ud af en anden tråd så snart låsen er givet fri, så den må ikke læses bagefter*/
+	cached = entry->text != NULL;
+	pthread_mutex_unlock(&server->lock);
+	if (!cached) {
+		vagtplan_destroy(parsed);
+	}
+	return status;
+}
+
+unsigned long hash_text(const char* text, size_t length) {
+	/*FNV-1a, holdt inden for 32 bit*/
+	unsigned long hash = 2166136261UL;
+	size_t i;
+	for (i = 0; i < length; i++) {
+		hash ^= (unsigned char) text[i];
+		hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
+	}
+	return hash;
+}
+
+FILE* open_text(const char* text, size_t length) {
+	/*fmemopen vil ikke have en tom buffer, en tom fil giver den samme fejl i læsefunktionerne*/
+	if (length == 0) {
+		return fmemopen((void*) "\n", 1, "r");
+	}
+	return fmemopen((void*) text, length, "r");
+}
+
+bool server_call(const char* socket_path, const ServerRequest* request, ServerResponse* response) {
+	struct sockaddr_un address;
+	ByteBuffer buffer = {NULL, 0, 0, false};
+	unsigned char* frame;
+	size_t length;
+	bool ok;
+	int fd;
+
+	if (strlen(socket_path) >= sizeof(address.sun_path)) {
+		return false;
+	}
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0) {
+		return false;
+	}
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, socket_path);
+	if (connect(fd, (struct sockaddr*) &address, sizeof(address)) != 0) {
+		close(fd);
+		return false;
+	}
+
+	encode_request(&buffer, request);
+	ok = !buffer.failed && write_frame(fd, &buffer);
+	free(buffer.data);
+	frame = ok ? read_frame(fd, &length) : NULL;
+	close(fd);
+	if (frame == NULL) {
+		return false;
+	}
+	ok = decode_response(frame, length, response);
+	free(frame);
+	return ok;
+}
+
+/*
+ * Forespørgslen er 50 tal på 4 byte i netværksrækkefølge: kommando, motor, antallet på hver af de 21 blokke,
+ * kravene til kvalifikationer på hver af de 21 blokke med en byte per kvalifikation, generationer, tidsbudget i millisekunder, uuid, blokke, max ændringer (0xFFFFFFFF er -1)
+ * og længden af medarbejderlisten. Derefter kommer medarbejderlisten, længden af vagtplanen, vagtplanen,
+ * længden af fraværet og fraværet
+ */
+void encode_request(ByteBuffer* buffer, const ServerRequest* request) {
+	unsigned int block;
+	buffer_put_u32(buffer, request->command);
+	buffer_put_u32(buffer, request->engine);
+	for (block = 0; block < 21; block++) {
+		buffer_put_u32(buffer, vagtplan_required_count(&request->required_workers, block));
+	}
+	for (block = 0; block < 21; block++) {
+		unsigned long skills = 0;
+		unsigned int skill;
+		for (skill = 0; skill < VAGTPLAN_SKILL_COUNT; skill++) {
+			skills |= (unsigned long) request->required_workers.skills[block][skill] << (skill * 8);
+		}
+		buffer_put_u32(buffer, skills);
+	}
+	buffer_put_u32(buffer, request->generations);
+	buffer_put_u32(buffer, request->time_limit_ms);
+	buffer_put_u32(buffer, request->uuid);
+	buffer_put_u32(buffer, request->blocks);
+	buffer_put_u32(buffer, request->max_changes < 0 ? 0xFFFFFFFFUL : (unsigned long) request->max_changes);
+	buffer_put_u32(buffer, request->workers_length);
+	buffer_put_bytes(buffer, request->workers, request->workers_length);
+	buffer_put_u32(buffer, request->schedule_length);
+	buffer_put_bytes(buffer, request->schedule, request->schedule_length);
+	buffer_put_u32(buffer, request->availability_length);
+	buffer_put_bytes(buffer, request->availability, request->availability_length);
+}
+
+bool decode_request(const unsigned char* data, size_t length, ServerRequest* request) {
+	unsigned int counts[21];
+	unsigned long max_changes;
+	unsigned int block;
+	unsigned int skill;
+	size_t offset;
+
+	if (length < SERVER_REQUEST_HEADER) {
+		return false;
+	}
+	request->command = (enum ServerCommand) get_u32(data);
+	request->engine = (enum Engine) get_u32(data + 4);
+	for (block = 0; block < 21; block++) {
+		counts[block] = get_u32(data + 8 + block * 4);
+		/*Holder summen af blokkene langt fra at løbe over*/
+		if (counts[block] > 65535) {
+			return false;
+		}
+	}
+	request->required_workers = vagtplan_required_per_block(counts);
+	for (block = 0; block < 21; block++) {
+		unsigned long skills = get_u32(data + 92 + block * 4);
+		for (skill = 0; skill < VAGTPLAN_SKILL_COUNT; skill++) {
+			request->required_workers.skills[block][skill] = (unsigned char) (skills >> (skill * 8));
+		}
+	}
+	request->generations = get_u32(data + 176);
+	request->time_limit_ms = get_u32(data + 180);
+	request->uuid = get_u32(data + 184);
+	request->blocks = get_u32(data + 188);
+	max_changes = get_u32(data + 192);
+	request->max_changes = max_changes == 0xFFFFFFFFUL || max_changes > 65535 ? -1 : (int) max_changes;
+	request->workers_length = get_u32(data + 196);
+	offset = SERVER_REQUEST_HEADER;
+	if (request->workers_length > length - offset || length - offset - request->workers_length < 4) {
+		return false;
+	}
+	request->workers = (const char*) data + offset;
+	offset += request->workers_length;
+	request->schedule_length = get_u32(data + offset);
+	offset += 4;
+	if (request->schedule_length > length - offset || length - offset - request->schedule_length < 4) {
+		return false;
+	}
+	request->schedule = (const char*) data + offset;
+	offset += request->schedule_length;
+	request->availability_length = get_u32(data + offset);
+	offset += 4;
+	if (request->availability_length != length - offset) {
+		return false;
+	}
+	request->availability = (const char*) data + offset;
+
+	if (request->command < SERVER_SOLVE || request->command > SERVER_REPLAN || request->engine > ENGINE_TABU) {
+		return false;
+	}
+	return true;
+}
+
+/*
+ * Svaret er status og antallet af ændringer som tal på 4 byte, scoren gange 1000 på 8 byte, og
+ * derefter længden af indholdet og indholdet. Scoren er fortegn og størrelse, den højeste bit i
+ * de første 4 byte er fortegnet, så store negative scorer ikke løber rundt
+ */
+void encode_response(ByteBuffer* buffer, const ServerResponse* response) {
+	/*C89 har ingen heltal på 64 bit, så tallet bliver delt op med double, som er præcis op til 2^53*/
+	double magnitude = floor(fabs(response->score) * 1000 + 0.5);
+	double high = floor(magnitude / 4294967296.0);
+	double low = magnitude - high * 4294967296.0;
+	buffer_put_u32(buffer, response->status);
+	buffer_put_u32(buffer, response->changes);
+	buffer_put_u32(buffer, ((unsigned long) high & 0x7FFFFFFFUL) | (response->score < 0 ? 0x80000000UL : 0));
+	buffer_put_u32(buffer, (unsigned long) low);
+	buffer_put_u32(buffer, response->body_length);
+	buffer_put_bytes(buffer, response->body, response->body_length);
+}
+
+bool decode_response(const unsigned char* data, size_t length, ServerResponse* response) {
+	unsigned long high;
+	if (length < SERVER_RESPONSE_HEADER + 4) {
+		return false;
+	}
+	response->status = (enum VagtplanStatus) get_u32(data);
+	response->changes = get_u32(data + 4);
+	high = get_u32(data + 8);
+	response->score = ((double) (high & 0x7FFFFFFFUL) * 4294967296.0 + (double) get_u32(data + 12)) / 1000;
+	if (high & 0x80000000UL) {
+		response->score = -response->score;
+	}
+	response->body_length = get_u32(data + 16);
+	if (response->body_length != length - SERVER_RESPONSE_HEADER - 4) {
+		return false;
+	}
+	response->body = malloc(response->body_length + 1);
+	if (response->body == NULL) {
+		return false;
+	}
+	memcpy(response->body, data + SERVER_RESPONSE_HEADER + 4, response->body_length);
+	response->body[response->body_length] = 0;
+	return true;
+}
+
+void buffer_put_u32(ByteBuffer* buffer, unsigned long value) {
+	unsigned char bytes[4];
+	bytes[0] = (unsigned char) ((value >> 24) & 0xFF);
+	bytes[1] = (unsigned char) ((value >> 16) & 0xFF);
+	bytes[2] = (unsigned char) ((value >> 8) & 0xFF);
+	bytes[3] = (unsigned char) (value & 0xFF);
+	buffer_put_bytes(buffer, bytes, 4);
+}
+
+void buffer_put_bytes(ByteBuffer* buffer, const void* data, size_t length) {
+	if (buffer->failed || length == 0) {
+		return;
+	}
+	if (buffer->length + length > buffer->allocated) {
+		size_t allocated = (buffer->length + length) * 2 + 64;
+		unsigned char* grown = realloc(buffer->data, allocated);
+		if (grown == NULL) {
+			buffer->failed = true;
+			return;
+		}
+		buffer->data = grown;
+		buffer->allocated = allocated;
+	}
+	memcpy(buffer->data + buffer->length, data, length);
+	buffer->length += length;
+}
+
+unsigned long get_u32(const unsigned char* data) {
+	return ((unsigned long) data[0] << 24) | ((unsigned long) data[1] << 16) | ((unsigned long) data[2] << 8) | (unsigned long) data[3];
+}
+
+unsigned char* read_frame(int fd, size_t* length) {
+	unsigned char header[4];
+	unsigned char* data;
+	if (!read_full(fd, header, 4)) {
+		return NULL;
+	}
+	*length = get_u32(header);
+	if (*length > SERVER_MAX_FRAME) {
+		return NULL;
+	}
+	data = malloc(*length + 1);
+	if (data == NULL) {
+		return NULL;
+	}
+	if (!read_full(fd, data, *length)) {
+		free(data);
+		return NULL;
+	}
+	return data;
+}
+
+bool write_frame(int fd, const ByteBuffer* buffer) {
+	unsigned char header[4];
+	header[0] = (unsigned char) ((buffer->length >> 24) & 0xFF);
+	header[1] = (unsigned char) ((buffer->length >> 16) & 0xFF);
+	header[2] = (unsigned char) ((buffer->length >> 8) & 0xFF);
+	header[3] = (unsigned char) (buffer->length & 0xFF);
+	return write_full(fd, header, 4) && write_full(fd, buffer->data, buffer->length);
+}
+
+bool read_full(int fd, void* data, size_t length) {
+	unsigned char* position = data;
+	while (length > 0) {
+		ssize_t got = read(fd, position, length);
+		if (got < 0 && errno == EINTR) {
+			continue;
+		}
+		if (got <= 0) {
+			return false;
+		}
+		position += got;
+		length -= (size_t) got;
+	}
+	return true;
+}
+
+bool write_full(int fd, const void* data, size_t length) {
+	const unsigned char* position = data;
+	while (length > 0) {
+		ssize_t sent = write(fd, position, length);
+		if (sent < 0 && errno == EINTR) {
+			continue;
+		}
+		if (sent <= 0) {
+			return false;
+		}
+		position += sent;
+		length -= (size_t) sent;
+	}
+	return true;
+}
+
+void handle_stop_signal(int signal_number) {
+	stop_signal = 1;
+}
+
+#else
+
+int serve(const char* socket_path, unsigned int threads) {
+	printf("Serveren kræver Unix sokler og virker kun på Linux og lignende\n");
+	return EXIT_FAILURE;
+}
+
+bool server_call(const char* socket_path, const ServerRequest* request, ServerResponse* response) {
+	printf("Klienten kræver Unix sokler og virker kun på Linux og lignende\n");
+	return false;
+}
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "vagtplan.h"
+
+/**
+ * Hvad klienten beder serveren om, tallene bliver sendt over soklen
+ */
+enum ServerCommand {
+	SERVER_SOLVE = 1,
+	SERVER_SCORE = 2,
+	SERVER_REPLAN = 3
+};
+
+/**
+ * En forespørgsel til serveren. Medarbejderlisten, vagtplanen og fraværet bliver sendt som de står
+ * i CSV filerne, så serveren læser dem præcis som kommandolinjen gør
+ */
+typedef struct ServerRequest {
+	enum ServerCommand command;
+	enum Engine engine;
+	RequiredWorkers required_workers;
+	unsigned int generations;
+	/*Tidsbudgettet i millisekunder, 0 betyder serverens standard*/
+	unsigned int time_limit_ms;
+	unsigned int uuid;
+	unsigned long blocks;
+	int max_changes;
+	const char* workers;
+	size_t workers_length;
+	const char* schedule;
+	size_t schedule_length;
+	/*fravaer.csv som den står i filen, længden er 0 hvis der ikke er noget fravær*/
+	const char* availability;
+	size_t availability_length;
+} ServerRequest;
+
+typedef struct ServerResponse {
+	enum VagtplanStatus status;
+	double score;
+	unsigned int changes;
+	/*Den nye vagtplan som CSV, eller fejlteksten hvis status ikke er VAGTPLAN_OK. Frigives med free*/
+	char* body;
+	size_t body_length;
+} ServerResponse;
+
+/**
+ * Lytter på en Unix sokkel og besvarer forespørgsler indtil programmet får SIGINT eller SIGTERM
+ * @param[in] socket_path stien til soklen, en gammel sokkel på stien bliver fjernet
+ * @param[in] threads antallet af tråde der løser forespørgsler samtidig
+ * @returns EXIT_SUCCESS eller EXIT_FAILURE
+ */
+int serve(const char* socket_path, unsigned int threads);
+
+/**
+ * Sender en forespørgsel til en server og venter på svaret
+ * @param[out] response svaret, body skal frigives med free
+ * @returns false hvis serveren ikke kunne nås eller svaret var forkert formateret
+ */
+bool server_call(const char* socket_path, const ServerRequest* request, ServerResponse* response);
+
+#endif
@@ -0,0 +1,6528 @@
+#if defined(__unix__) || defined(__APPLE__)
+#define _POSIX_C_SOURCE 200809L
+#define POSIX_SUPPORTED
+#define ISLANDS_SUPPORTED
+#define THREADS_SUPPORTED
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <signal.h>
+
+#ifdef POSIX_SUPPORTED
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
+
+#ifdef ISLANDS_SUPPORTED
+#include <sys/wait.h>
+#endif
+
+#ifdef THREADS_SUPPORTED
+#include <pthread.h>
+#endif
+
+#include "vagtplan.h"
+
+#define MAX_NAME_LENGTH 50
+#define DEFAULT_POPULATION_SIZE 1000
+#define DEFAULT_ELITE_SIZE 40
+#define DEFAULT_CHILDREN_PER_ELITE 4
+#define MAX_GENERATIONS 100000
+#define DEFAULT_TOURNAMENT_SIZE 3
+#define MUTATION_MIN_PROBABILITY (1.0 / 3.0)
+#define MUTATION_MAX_PROBABILITY 1.0
+#define MUTATION_MAX_BLOCKS 6
+#define CROSSOVER_OPERATOR_COUNT 4
+#define CROSSOVER_MIN_PROBABILITY 0.05
+#define CROSSOVER_LEARNING_RATE 0.1
+#define STALL_GENERATIONS 50
+#define RESTART_GENERATIONS 2000
+#define MIN_DIVERSITY 0.05
+#define DIVERSITY_SAMPLES 32
+#define IMMIGRANT_FRACTION 0.25
+#define EXACT_NODE_LIMIT 2000000000UL
+#define WORKER_BOUND_TABLE_SIZE (3 * 7 * 22 * 22 * 3 * 3)
+#define ANNEALING_MOVES_PER_STEP 1000
+#define ANNEALING_START_TEMPERATURE 1000.0
+#define ANNEALING_END_TEMPERATURE 0.05
+#define TABU_CANDIDATES 100
+#define TABU_TENURE 10
+#define SEED_FRACTION 0.2
+#define DEFAULT_GREEDY_FRACTION 0.25
+#define SEED_MAX_MUTATED_BLOCKS 3
+#define REPLAN_CHANGE_PENALTY 3.0
+#define REPLAN_RADIUS 3
+#define REPLAN_ITERATIONS 500
+#define REPLAN_TIME_LIMIT 0.5
+#define REPLAN_DEFAULT_EXTRA_CHANGES 6
+#define REPLAN_MAX_VACATED 256
+#define MIGRATION_INTERVAL 50
+#define MIGRANTS_PER_ISLAND 4
+/*Hvor tit koordinatoren ser efter øerne mens den venter, når nogen holder øje med fremskridtet*/
+#define ISLAND_WATCH_NANOSECONDS 50000000L
+#define CHILD_BATCH_PAIRS 8
+#define BATCHES_PER_THREAD 2
+#define TASK_DEQUE_SIZE 128
+#define CHECK_BATCH_SIZE 256
+#define CHECK_MAX_REPORTED 5
+#define MAX_SKILL_TEXT 255
+#define MAX_AVAILABILITY_TEXT 255
+#define ALL_BLOCKS ((1UL << 21) - 1)
+#define POOL_KINDS (VAGTPLAN_SKILL_COUNT + 1)
+#define WORKER_CACHE_MAGIC "VAGTDB1"
+#define WORKER_CACHE_SECTIONS 7
+
+/**
+ * Den varme del af en medarbejder, kun det som scoren læser og skriver. Den fylder 16 bytes,
+ * så en hel afdeling ligger i få cachelinjer. id er medarbejderens plads i WorkerDirectory,
+ * skills har en bit for hver kvalifikation i enum Skill og forbidden_blocks en bit for hver
+ * blok medarbejderen ikke kan tage
+ */
+typedef struct Worker {
+	unsigned short id;
+	unsigned char desired_day_off;
+	unsigned char desired_shift;
+	unsigned char skills;
+	signed char last_block;
+	unsigned char consecutive_night_shifts;
+	signed char day_off;
+	unsigned long forbidden_blocks;
+} Worker;
+
+/**
+ * En plads i indekset over uuid, worker er medarbejderens id
+ */
+typedef struct UuidEntry {
+	unsigned int uuid;
+	unsigned int worker;
+} UuidEntry;
+
+/**
+ * Den kolde del af medarbejderne, navne og uuid, som kun bliver brugt når der bliver læst og
+ * skrevet filer. Navnene er internerede, så medarbejdere med samme navn deler strengen i names
+ */
+typedef struct WorkerDirectory {
+	unsigned int worker_count;
+	unsigned int* uuids;
+	/*Alle uuid sorteret, så en medarbejder kan findes med binær søgning*/
+	UuidEntry* uuid_index;
+	unsigned int* name_offsets;
+	char* names;
+	size_t names_length;
+	size_t names_allocated;
+	/*Afdelingen for hver medarbejder, og hvor hver afdelings navn starter i names*/
+	unsigned short* departments;
+	unsigned int* department_offsets;
+	unsigned int department_count;
+} WorkerDirectory;
+
+/**
+ * Hashtabel over navnene i et WorkerDirectory mens det bliver bygget, så intern_worker_name ikke skal
+ * sammenligne med alle de tidligere navne. En plads er 0 hvis den er tom og ellers navnets start i
+ * names plus 1. Tabellen er aldrig mere end halvt fuld
+ */
+typedef struct NameIndex {
+	unsigned int* slots;
+	unsigned int size;
+	unsigned int count;
+} NameIndex;
+
+/**
+ * Alle ugens pladser ligger efter hinanden i workers, blok for blok, så en vagtplan er en enkelt
+ * allokering. Hvor hver blok starter står i RequiredWorkers.offsets, som er fælles for alle
+ * vagtplanerne i en kørsel
+ */
+typedef struct Schedule {
+	Worker** workers;
+	double score;
+} Schedule;
+
+/**
+ * Starten af cachen med medarbejderlisten. source_size, source_time og source_hash beskriver CSV
+ * filen som cachen blev lavet ud fra, og written_time er hvornår cachen blev skrevet. Efter headeren
+ * følger tabellerne fra worker_cache_layout. worker_size er sizeof(Worker), så en cache fra en
+ * anden oversættelse af programmet ikke bliver læst
+ */
+typedef struct WorkerCacheHeader {
+	char magic[8];
+	unsigned long worker_size;
+	unsigned long source_size;
+	unsigned long source_time;
+	unsigned long source_hash;
+	unsigned long written_time;
+	unsigned long worker_count;
+	unsigned long department_count;
+	unsigned long names_length;
+} WorkerCacheHeader;
+
+/**
+ * Medarbejderne der kan vælges til hver blok, pakket ligesom vagtplanerne. Puljen for blok b og
+ * slags k går fra offsets[b * POOL_KINDS + k] til den næste, hvor k = 0 er alle der må tage
+ * blokken og k = 1 + s er dem der har kvalifikationen s. Puljerne gemmer medarbejdernes id og
+ * bliver blandet når der trækkes fra dem. En medarbejder hvis stamp er lig med stamp er allerede
+ * trukket på den dag eller blok der bliver fyldt
+ */
+typedef struct CandidatePools {
+	unsigned int offsets[21 * POOL_KINDS + 1];
+	unsigned short* workers;
+	unsigned long* stamps;
+	unsigned long stamp;
+} CandidatePools;
+
+/**
+ * Foran hver allokering ligger en header, så konteksten kan frigive alt der blev allokeret i et
+ * kald som fejlede. Listen er sorteret med de nyeste allokeringer først. Unionen sørger for at
+ * hukommelsen efter headeren er justeret til alle typer
+ */
+typedef union Allocation {
+	struct {
+		union Allocation* previous;
+		union Allocation* next;
+		unsigned long serial;
+	} links;
+	double align_double;
+	long align_long;
+	void* align_pointer;
+} Allocation;
+
+struct VagtplanContext {
+	VagtplanAllocator allocator;
+	Allocation* allocations;
+	unsigned long allocation_serial;
+	jmp_buf error_jump;
+	enum VagtplanStatus status;
+	char error_message[256];
+	unsigned long random_state;
+	FILE* log;
+	Worker* workers;
+	unsigned int worker_count;
+	WorkerDirectory directory;
+	CandidatePools pools;
+	/*Den faste del af scoren for hver medarbejder på hver blok, 21 tal per medarbejder*/
+	double* static_scores;
+};
+
+struct VagtplanSchedule {
+	Schedule schedule;
+	RequiredWorkers required_workers;
+};
+
+/**
+ * Den bedste vagtplan en motor har fundet indtil videre. Motoren er den eneste der skriver, og
+ * sequence er en seqlock som er ulige mens den skriver, så motoren aldrig venter på dem der læser.
+ * 0 betyder at der ikke er udgivet noget endnu. workers er medarbejdernes id på hver plads
+ */
+struct VagtplanProgress {
+	volatile sig_atomic_t stop_requested;
+	volatile unsigned int sequence;
+	RequiredWorkers required_workers;
+	unsigned int worker_count;
+	unsigned int steps;
+	double score;
+	unsigned short* workers;
+};
+
+typedef struct ExactSearch {
+	VagtplanContext* context;
+	Worker** workers;
+	unsigned int worker_count;
+	RequiredWorkers required_workers;
+	Worker** order[21];
+	/*Hvor mange med hver kvalifikation der er sat på blokkene indtil nu*/
+	unsigned int coverage[21][VAGTPLAN_SKILL_COUNT];
+	Schedule current;
+	Schedule best;
+	double best_score;
+	unsigned long nodes;
+	bool proven;
+	double upper_bound;
+	double* bound_table;
+	double* order_keys;
+} ExactSearch;
+
+typedef struct ExactState {
+	VagtplanContext* context;
+	Schedule result;
+} ExactState;
+
+typedef struct MutationControl {
+	double probability;
+	unsigned int blocks;
+	bool adaptive;
+	double best_score;
+	unsigned int stalled_generations;
+	double diversity;
+} MutationControl;
+
+/**
+ * Sandsynligheden for hver crossover, index er enum CrossoverOperator minus 1. quality er et glidende
+ * gennemsnit af hvor stor en andel af operatorens børn der slår begge forældre, og children og
+ * survivors tæller op i den nuværende generation
+ */
+typedef struct CrossoverControl {
+	enum CrossoverOperator fixed;
+	double probabilities[CROSSOVER_OPERATOR_COUNT];
+	double quality[CROSSOVER_OPERATOR_COUNT];
+	unsigned long children[CROSSOVER_OPERATOR_COUNT];
+	unsigned long survivors[CROSSOVER_OPERATOR_COUNT];
+} CrossoverControl;
+
+/**
+ * De bedste forskellige vagtplaner som motoren har evalueret, sorteret med den bedste først.
+ * Hver vagtplan bliver også gemt som en sorteret liste af tildelinger, blokken gange 65536 plus
+ * medarbejderens id, så to vagtplaner kan sammenlignes uden at se på rækkefølgen i blokkene.
+ * keys har en række mere end capacity, den sidste bruges til den vagtplan der bliver tilbudt
+ */
+typedef struct ScheduleArchive {
+	VagtplanContext* context;
+	RequiredWorkers required_workers;
+	unsigned int capacity;
+	unsigned int count;
+	unsigned int min_distance;
+	unsigned int total_slots;
+	Schedule* schedules;
+	unsigned long* hashes;
+	unsigned long** keys;
+} ScheduleArchive;
+
+typedef struct SolverProblem {
+	VagtplanContext* context;
+	Worker** workers;
+	unsigned int worker_count;
+	RequiredWorkers required_workers;
+	double upper_bound;
+	const Schedule* seeds;
+	unsigned int seed_count;
+	/*Motorerne tilbyder de vagtplaner de evaluerer til arkivet, NULL hvis der kun skal bruges den bedste*/
+	ScheduleArchive* archive;
+} SolverProblem;
+
+/**
+ * Fælles interface for alle motorerne. init laver motorens tilstand, step kører en generation
+ * eller en portion træk og returnerer false når motoren er færdig, best giver den bedste
+ * vagtplan indtil videre, og stop frigiver tilstanden og returnerer den bedste vagtplan.
+ * immigrate tager en evalueret vagtplan fra en anden ø ind, den er NULL hvis motoren ikke kan bruge øer
+ */
+typedef struct Solver {
+	void* state;
+	void (*init)(struct Solver* solver, const SolverProblem* problem, const SolverOptions* options);
+	bool (*step)(struct Solver* solver);
+	const Schedule* (*best)(const struct Solver* solver);
+	Schedule (*stop)(struct Solver* solver);
+	void (*immigrate)(struct Solver* solver, const Schedule* migrant);
+} Solver;
+
+/**
+ * Hvordan det gik med en afdeling i vagtplan_make_department_schedule
+ */
+typedef struct DepartmentResult {
+	enum VagtplanStatus status;
+	double score;
+	char message[256];
+} DepartmentResult;
+
+/**
+ * Det afdelingerne i vagtplan_make_department_schedule deler, givet videre til solve_departments
+ */
+typedef struct DepartmentJob {
+	const VagtplanContext* context;
+	const RequiredWorkers* required_workers;
+	const SolverOptions* options;
+	const unsigned int* starts;
+	DepartmentResult* results;
+	unsigned short* slots;
+} DepartmentJob;
+
+#ifdef THREADS_SUPPORTED
+/**
+ * En gruppe af opgaver der kan ventes på med task_pool_join. pending tæller de opgaver der ikke er
+ * færdige, også dem der bliver delt af undervejs, og bliver kun rørt mens puljens lås holdes
+ */
+typedef struct TaskGroup {
+	unsigned long pending;
+} TaskGroup;
+
+/**
+ * En opgave over [begin, end). Er den større end grain bliver den delt, og den øverste halvdel
+ * bliver lagt i trådens kø hvor en anden tråd kan stjæle den
+ */
+typedef struct Task {
+	VagtplanTaskFunction function;
+	void* argument;
+	unsigned long begin;
+	unsigned long end;
+	unsigned long grain;
+	TaskGroup* group;
+} Task;
+
+/**
+ * En tråds kø af opgaver. Tråden selv tager fra bunden, så den fortsætter med det den lige har
+ * delt af, mens andre tråde stjæler fra toppen hvor de største stykker ligger
+ */
+typedef struct TaskDeque {
+	pthread_mutex_t lock;
+	Task tasks[TASK_DEQUE_SIZE];
+	unsigned int top;
+	unsigned int count;
+} TaskDeque;
+
+typedef struct TaskThread {
+	struct TaskPool* pool;
+	unsigned int index;
+	pthread_t thread;
+} TaskThread;
+
+/**
+ * En work-stealing pulje af tråde med hver sin kø. Tråd 0 er den tråd der har lavet puljen, den
+ * bliver ikke startet men kører opgaver mens den venter i task_pool_join. queued er antallet af
+ * opgaver i alle køerne, så de andre tråde kan sove når der ikke er noget at stjæle
+ */
+typedef struct TaskPool {
+	unsigned int thread_count;
+	TaskDeque* deques;
+	TaskThread* threads;
+	pthread_mutex_t lock;
+	pthread_cond_t wake;
+	long queued;
+	bool stopping;
+} TaskPool;
+#endif
+
+/**
+ * Starten af det delte hukommelsessegment som øerne bytter individer igennem. Efter headeren
+ * kommer MIGRANTS_PER_ISLAND pladser for hver ø, hver på slot_size bytes
+ */
+typedef struct IslandSegment {
+	unsigned int island_count;
+	unsigned int total_slots;
+	size_t slot_size;
+	volatile unsigned int stop_requested;
+} IslandSegment;
+
+/**
+ * En plads til et individ i segmentet, efterfulgt af total_slots medarbejder index.
+ * sequence er en seqlock som er ulige mens pladsen bliver skrevet
+ */
+typedef struct MigrantHeader {
+	volatile unsigned int sequence;
+	unsigned int generation;
+	double score;
+} MigrantHeader;
+
+/**
+ * Den genetiske algoritmes population i kompakt form. Hvert individ er medarbejdernes id på alle
+ * pladserne efter hinanden, på 8 bit hvis der højst er 256 medarbejdere og ellers på 16 bit, så en
+ * population på en million individer kan ligge i hukommelsen. Individerne bliver pakket ud i en
+ * Schedule når de skal krydses, og scoren bliver gemt når de bliver pakket
+ */
+typedef struct Population {
+	unsigned int size;
+	unsigned int total_slots;
+	unsigned int gene_size;
+	unsigned char* genes;
+	double* scores;
+	/*Medarbejderne sorteret efter id, så et gen kan pakkes ud uden at lede*/
+	Worker** workers;
+} Population;
+
+/**
+ * En plads i rangordenen, så den generationsbaserede motor kan sortere uden at flytte individerne
+ */
+typedef struct PopulationRank {
+	double score;
+	unsigned int individual;
+} PopulationRank;
+
+typedef struct GeneticState {
+	SolverProblem problem;
+	SolverOptions options;
+	Population population;
+	/*Rangordenen som den generationsbaserede motor sorterer, NULL for steady-state*/
+	PopulationRank* ranks;
+	/*Forældrene og barnet pakket ud, og det bedste individ som genetic_best giver*/
+	Schedule parents[2];
+	Schedule child;
+	Schedule best_schedule;
+	unsigned int best;
+	unsigned int generation;
+	MutationControl mutation;
+	CrossoverControl crossover;
+} GeneticState;
+
+#ifdef THREADS_SUPPORTED
+/**
+ * En portion børn fra en avlertråd, pakket ligesom individerne i en Population. operators og
+ * improved giver crossover operatorerne point når hovedtråden tager børnene
+ */
+typedef struct ChildBatch {
+	unsigned int count;
+	unsigned char* genes;
+	double* scores;
+	unsigned char* operators;
+	unsigned char* improved;
+} ChildBatch;
+
+/**
+ * Det en tråd i puljen avler med. Den har sin egen kontekst, så den har sine egne medarbejdere at
+ * evaluere med og sin egen tilfældighedsgenerator, mens resten er allokeret i hovedkonteksten
+ */
+typedef struct PipelineProducer {
+	VagtplanContext* context;
+	/*Avlerkontekstens medarbejdere i id rækkefølge*/
+	Worker** workers;
+	unsigned char* parent_genes;
+	Schedule parents[2];
+	Schedule child;
+} PipelineProducer;
+
+/**
+ * Den generationsbaserede motor med en pulje af tråde. genetic.population er forbufferen som
+ * avlerne tager forældre fra, og back er den næste generation som hovedtråden samler af de
+ * overlevende og børnene fra full_batches. Hver portion er en opgave i puljen, som bliver lagt i kø
+ * igen når hovedtråden har taget børnene, så ingen venter på at en hel generation er færdig.
+ * Avlerne læser mutation og crossover, som hovedtråden opdaterer efter hver generation, og alt de
+ * deler bliver kun rørt mens lock holdes. genetic ligger først, så genetic_best og genetic_stop kan
+ * bruges på tilstanden
+ */
+typedef struct PipelineState {
+	GeneticState genetic;
+	Population back;
+	PopulationRank* back_ranks;
+	MutationControl mutation;
+	CrossoverControl crossover;
+	pthread_mutex_t lock;
+	pthread_cond_t batch_ready;
+	ChildBatch* batches;
+	unsigned int batch_count;
+	ChildBatch** full_batches;
+	unsigned int full_first;
+	unsigned int full_count;
+	/*Portionen hovedtråden er i gang med at tage børn fra, og hvor mange den har taget*/
+	ChildBatch* pending;
+	unsigned int pending_used;
+	/*Den næste i eliten der skal have børn, så eliten får lige mange*/
+	unsigned int next_elite;
+	bool stopping;
+	TaskPool* pool;
+	TaskGroup batches_group;
+	/*En for hver tråd i puljen*/
+	PipelineProducer* producers;
+	unsigned int producer_count;
+} PipelineState;
+#endif
+
+typedef struct LocalSearchState {
+	SolverProblem problem;
+	SolverOptions options;
+	Schedule current;
+	Schedule best;
+	/*Medarbejdernes index for hver plads, i samme rækkefølge som current.workers*/
+	unsigned int* assignment;
+	unsigned long* occupancy;
+	/*Hvor mange med hver kvalifikation der er på hver blok, VAGTPLAN_SKILL_COUNT tal per blok*/
+	unsigned int* coverage;
+	double* worker_scores;
+	unsigned int step;
+	double temperature;
+	double cooling;
+	unsigned int* tabu_until;
+} LocalSearchState;
+
+typedef struct LocalSearchMove {
+	unsigned int block;
+	unsigned int slot;
+	unsigned int old_worker;
+	unsigned int new_worker;
+	double old_worker_score;
+	double new_worker_score;
+	double delta;
+} LocalSearchMove;
+
+/**
+ * Starter et kald til biblioteket og nulstiller den sidste fejl. Kaldet skal derefter lave
+ * setjmp på context->error_jump, som context_fail hopper tilbage til
+ * @returns mærket som context_rollback bruger til at finde hukommelsen fra kaldet
+ */
+unsigned long context_begin(VagtplanContext* context);
+
+/**
+ * Frigiver al hukommelse der er allokeret efter mark, bruges når et kald er fejlet
+ * @returns fejlen fra context_fail
+ */
+enum VagtplanStatus context_rollback(VagtplanContext* context, unsigned long mark);
+
+/**
+ * Gemmer en fejl i konteksten uden at hoppe
+ * @returns status
+ */
+enum VagtplanStatus context_error(VagtplanContext* context, enum VagtplanStatus status, const char* reason);
+
+/**
+ * Stopper det nuværende kald til biblioteket med en fejl, kommer aldrig tilbage
+ */
+void context_fail(VagtplanContext* context, enum VagtplanStatus status, const char* reason);
+
+/**
+ * Allokerer hukommelse med kontekstens allocator, fejler kaldet hvis der ikke er mere hukommelse
+ */
+void* context_allocate(VagtplanContext* context, size_t size);
+void* context_allocate_zero(VagtplanContext* context, size_t count, size_t size);
+void* context_reallocate(VagtplanContext* context, void* memory, size_t size);
+void context_free(VagtplanContext* context, void* memory);
+
+/**
+ * Skriver til kontekstens log, hvis den har en
+ */
+void context_log(VagtplanContext* context, const char* format, ...);
+
+/**
+ * Bygger kontekstens puljer af medarbejdere til hver blok og tabellen over de faste scorer ud fra
+ * medarbejderlisten, skal kaldes hver gang medarbejderne ændrer sig. En medarbejder kommer ikke i
+ * puljerne til de blokke de ikke kan tage. De gamle puljer og den gamle tabel bliver først frigivet
+ * når de nye er allokeret
+ */
+void build_candidate_pools(VagtplanContext* context);
+
+/**
+ * @returns true hvis medarbejderen hører til puljen, altså kan tage blokken og har kvalifikationen
+ */
+bool pool_accepts(const Worker* worker, unsigned int pool);
+
+/**
+ * @returns antallet af medarbejdere i en pulje
+ */
+unsigned int pool_size(const CandidatePools* pools, unsigned int pool);
+
+/**
+ * Trækker en tilfældig medarbejder fra en pulje som ikke allerede er trukket siden stamp blev talt op
+ * @param[in] pool blok gange POOL_KINDS plus slagsen
+ * @returns medarbejderen, eller NULL hvis alle i puljen er trukket
+ */
+Worker* pool_draw(VagtplanContext* context, unsigned int pool);
+
+/**
+ * Trækker den medarbejder fra en pulje der passer bedst på blokken, ligesom pool_draw. Først dem der
+ * ikke bryder en hård regel med deres forrige vagt, og blandt dem dem med den højeste faste score.
+ * Lige gode medarbejdere bliver valgt tilfældigt. Medarbejdernes tilstand skal være fra score_transition
+ * @returns medarbejderen, eller NULL hvis alle i puljen er trukket
+ */
+Worker* pool_draw_greedy(VagtplanContext* context, unsigned int pool, unsigned int block);
+
+/**
+ * Fylder en blok med medarbejdere fra puljerne. Først bliver kravene til kvalifikationer
+ * dækket så vidt puljerne rækker, og resten bliver taget fra alle der må tage blokken
+ * @param[out] block_workers blokkens pladser i vagtplanen
+ * @param[in] greedy om medarbejderne bliver trukket med pool_draw_greedy i stedet for tilfældigt
+ */
+void fill_block(VagtplanContext* context, const RequiredWorkers* required_workers, unsigned int block, Worker** block_workers, bool greedy);
+
+/**
+ * @returns strafpoint for de kvalifikationer der mangler på en blok
+ * @param[in] minimum kravene til blokken, VAGTPLAN_SKILL_COUNT tal
+ * @param[in] counts hvor mange med hver kvalifikation der er på blokken
+ */
+double score_skill_shortage(const unsigned char* minimum, const unsigned int* counts);
+
+/**
+ * Tæller kvalifikationerne på hver blok og giver strafpoint for dem der mangler
+ */
+double score_skill_coverage(const Schedule* schedule, const RequiredWorkers* required_workers);
+
+/**
+ * @returns hvor meget strafpointene for blokkens kvalifikationer ændrer sig hvis old_worker bliver
+ * erstattet af new_worker
+ */
+double local_search_skill_delta(const LocalSearchState* state, unsigned int block, unsigned int old_worker, unsigned int new_worker);
+
+/**
+ * Fejler kaldet hvis der ikke er læst en medarbejderliste ind i konteksten
+ */
+void context_require_workers(VagtplanContext* context);
+
+/**
+ * @returns en ny array med en pointer til hver medarbejder i konteksten, i samme rækkefølge som deres id
+ */
+Worker** context_worker_array(VagtplanContext* context);
+
+/**
+ * Bruges kun når programmet selv er i en umulig tilstand, skriver til stderr og stopper med abort
+ */
+void program_error(const char* reason);
+
+void* default_allocate(void* user, size_t size);
+void* default_reallocate(void* user, void* memory, size_t size);
+void default_release(void* user, void* memory);
+
+/**
+ * Tilfældighedsgeneratoren i konteksten, xorshift på 32 bit
+ */
+unsigned long random_next(VagtplanContext* context);
+
+/**
+ * @returns et tilfældigt tal fra og med 0 til 1
+ */
+double random_unit(VagtplanContext* context);
+
+/**
+ * Laver et schema til antallet af mearbejdere
+ * @param[in] workers alle workers
+ * @param[in] worker_count antallet af workers i workers arrayen
+ * @param[in] required_workers en required workers struktur
+ * @param[in] seeds tidligere vagtplaner som søgningen starter fra, de bliver evalueret, må være NULL
+ * @param[in] seed_count antallet af vagtplaner i seeds
+ * @param[in] options hvilken motor der skal bruges og hvor mange generationer den må køre
+ * @param[in, out] archive arkivet som får de bedste forskellige vagtplaner, må være NULL
+ * @returns et skema over hvem der skal arbejde
+ */
+ Schedule make_schedule(VagtplanContext* context, Worker* workers[], const unsigned int worker_count, const  RequiredWorkers required_workers, Schedule* seeds, unsigned int seed_count, const SolverOptions* options, ScheduleArchive* archive);
+
+/**
+ * Laver et tomt arkiv og allokerer alle dets vagtplaner
+ * @param[in] capacity det højeste antal vagtplaner i arkivet
+ * @param[in] min_distance hvor mange pladser vagtplanerne mindst skal være forskellige på
+ */
+void archive_init(ScheduleArchive* archive, VagtplanContext* context, RequiredWorkers required_workers, unsigned int capacity, unsigned int min_distance);
+
+/**
+ * Tilbyder en evalueret vagtplan til arkivet. Hvis arkivet er fuldt og vagtplanen ikke er bedre
+ * end den dårligste koster det kun en sammenligning. Ellers bliver vagtplanen afvist hvis den
+ * ligger for tæt på en vagtplan der er mindst lige så god, og ellers erstatter den de dårligere
+ * vagtplaner den ligger for tæt på
+ * @param[in, out] archive arkivet, må være NULL
+ */
+void archive_offer(ScheduleArchive* archive, const Schedule* schedule);
+
+/**
+ * @returns antallet af pladser hvor to sorterede lister af tildelinger er forskellige
+ */
+unsigned int archive_distance(const unsigned long* a, const unsigned long* b, unsigned int length);
+
+/**
+ * Flytter vagtplanen på plads from hen til plads to og skubber dem imellem en plads
+ */
+void archive_move(ScheduleArchive* archive, unsigned int from, unsigned int to);
+
+/**
+ * Evaluerer vagtplanerne i arkivet igen og sorterer dem, da lokalsøgningerne kun opdaterer scoren
+ * løbende, og frigiver de pladser der ikke blev brugt. Vagtplanerne i archive->schedules bliver
+ * ikke frigivet
+ */
+void archive_finish(ScheduleArchive* archive, Worker** workers, unsigned int worker_count);
+
+int compare_assignment_keys(const void* a, const void* b);
+
+/**
+ * Kører tjekket fra vagtplan_check_evaluators i portioner af CHECK_BATCH_SIZE vagtplaner, så
+ * hver funktion bliver timet over en hel portion ad gangen
+ */
+void compare_evaluators(VagtplanContext* context, RequiredWorkers required_workers, unsigned long schedule_count, VagtplanEvaluatorCheck* results);
+
+/**
+ * Fylder en vagtplan som allerede har allokeret sine blokke med medarbejdere fra de første pool_size
+ * medarbejdere efter workers er blevet blandet. Ingen medarbejder står to gange på den samme blok
+ * @param[in] pool_size antallet af medarbejdere der bliver brugt, mindst det største antal på en vagt
+ */
+void fill_check_schedule(VagtplanContext* context, Worker** workers, unsigned int worker_count, RequiredWorkers required_workers, unsigned int pool_size, Schedule* schedule);
+
+/**
+ * Referencen for fitness funktionen. Den er skrevet for sig selv og må ikke ændres når
+ * evaluate_schedule eller de andre fitness funktioner bliver optimeret, den er det de bliver tjekket mod
+ * @param[in] workers medarbejderne i id rækkefølge, deres tilstand bliver ikke brugt
+ * @param[in] scratch plads til 3 * worker_count tal
+ */
+double reference_evaluate_schedule(const Schedule* schedule, RequiredWorkers required_workers, const Worker* workers, unsigned int worker_count, int* scratch);
+
+/**
+ * Tæller en forskel mellem en fitness funktion og referencen og skriver de første til loggen
+ */
+void check_evaluator_result(VagtplanContext* context, VagtplanEvaluatorCheck* result, double expected, double actual);
+
+/**
+ * Indlæser en tidligere vagtplan så den passer til den nuværende medarbejderliste og det
+ * nuværende antal medarbejdere på hver vagt. Medarbejdere som ikke findes længere bliver
+ * erstattet af tilfældige medarbejdere, og hvis der skal være flere på en blok bliver de
+ * ekstra pladser fyldt tilfældigt
+ * @param[in, out] file en åben fil med vagtplanen
+ * @param[out] out den indlæste vagtplan
+ */
+void load_seed_schedule(VagtplanContext* context, FILE* file, Worker* workers[], unsigned int worker_count, RequiredWorkers required_workers, const WorkerDirectory* directory, Schedule* out);
+
+/**
+ * @returns den bedste af startvagtplanerne, eller NULL hvis der ikke er nogle
+ */
+const Schedule* best_seed(const SolverProblem* problem);
+
+/**
+ * Kopierer en vagtplan over i en anden som allerede har allokeret sine blokke
+ */
+void copy_schedule(const Schedule* from, Schedule* to, RequiredWorkers required_workers);
+
+/**
+ * Allokerer blokkene til en vagtplan uden at fylde dem
+ */
+void allocate_schedule(VagtplanContext* context, Schedule* schedule, RequiredWorkers required_workers);
+
+/**
+ * @returns worker's plads i workers arrayen
+ */
+unsigned int find_worker_index(Worker** workers, unsigned int worker_count, const Worker* worker);
+
+/**
+ * @returns true hvis worker allerede er blandt de første count medarbejdere i block
+ */
+bool block_contains(Worker** block, unsigned int count, const Worker* worker);
+
+/**
+ * Sætter funktionerne i solver til den valgte motor
+ */
+void select_solver(Solver* solver, const SolverOptions* options);
+
+/**
+ * Laver og evaluerer startpopulationen til de genetiske motorer
+ */
+void genetic_init(Solver* solver, const SolverProblem* problem, const SolverOptions* options);
+
+/**
+ * Sætter en genetisk tilstand op med en evalueret startpopulation, bruges af genetic_init og pipeline_init
+ * @param[out] state tilstanden, allokeret af den der kalder
+ */
+void genetic_setup(GeneticState* state, const SolverProblem* problem, const SolverOptions* options);
+
+/**
+ * En generation af den generationsbaserede genetiske algoritme, sorterer rangordenen og
+ * erstatter de dårligste med børn af de bedste
+ */
+bool generational_step(Solver* solver);
+
+/**
+ * En generation af steady-state genetisk algoritme, der bliver lavet et barn ad gangen med
+ * turneringsudvælgelse og barnet erstatter taberen af en omvendt turnering. Der bliver aldrig
+ * sorteret, og bogføringen per barn er O(turneringsstørrelse). En generation er
+ * elite_size * children_per_elite børn ligesom i generational_step
+ */
+bool steady_state_step(Solver* solver);
+
+const Schedule* genetic_best(const Solver* solver);
+Schedule genetic_stop(Solver* solver);
+
+/**
+ * Sætter en indvandrer ind i stedet for taberen af en omvendt turnering
+ */
+void genetic_immigrate(Solver* solver, const Schedule* migrant);
+
+#ifdef THREADS_SUPPORTED
+/**
+ * Laver en pulje med threads tråde, hvor den kaldende tråd er tråd 0
+ */
+TaskPool* task_pool_create(VagtplanContext* context, unsigned int threads);
+
+/**
+ * Stopper trådene når alle opgaver er færdige, og frigiver puljen
+ */
+void task_pool_destroy(VagtplanContext* context, TaskPool* pool);
+
+/**
+ * Stopper de started første tråde og nedlægger låsene, uden at frigive noget
+ */
+void task_pool_stop(TaskPool* pool, unsigned int started);
+
+/**
+ * Lægger en opgave over [begin, end) i trådens kø, eller kører den med det samme hvis køen er fuld
+ * @param[in] thread nummeret på den tråd i puljen der kalder
+ */
+void task_pool_submit(TaskPool* pool, unsigned int thread, TaskGroup* group, VagtplanTaskFunction function, void* argument, unsigned long begin, unsigned long end, unsigned long grain);
+
+/**
+ * @returns false hvis trådens kø var fuld
+ */
+bool task_pool_push(TaskPool* pool, unsigned int thread, const Task* task);
+
+/**
+ * Kører en opgave fra trådens egen kø, eller stjæler en fra en anden tråd
+ * @returns false hvis der ikke var nogen opgaver i kø
+ */
+bool task_pool_run_one(TaskPool* pool, unsigned int thread);
+
+/**
+ * Deler opgaven ned til grain og kører den, og tæller gruppen ned når den er færdig
+ */
+void task_pool_execute(TaskPool* pool, unsigned int thread, Task* task);
+
+/**
+ * Kører opgaver indtil alle opgaverne i gruppen er færdige
+ */
+void task_pool_join(TaskPool* pool, unsigned int thread, TaskGroup* group);
+void* task_pool_thread(void* argument);
+
+/**
+ * Starter den generationsbaserede motor med en pulje af options->threads tråde
+ */
+void pipeline_init(Solver* solver, const SolverProblem* problem, const SolverOptions* options);
+
+/**
+ * En generation for hovedtråden: kopierer de overlevende fra forbufferen, fylder resten af
+ * bagbufferen med børn fra køen, sorterer den og bytter de to buffere
+ */
+bool pipeline_step(Solver* solver);
+void pipeline_immigrate(Solver* solver, const Schedule* migrant);
+Schedule pipeline_stop(Solver* solver);
+
+/**
+ * Opgaven for en portion: kopierer forældrene fra forbufferen og fylder portionen med evaluerede
+ * børn, og lægger den i full_batches
+ * @param[in] argument PipelineState
+ * @param[in] begin nummeret på portionen
+ */
+void pipeline_produce(void* argument, unsigned int thread, unsigned long begin, unsigned long end);
+#endif
+
+void exact_init(Solver* solver, const SolverProblem* problem, const SolverOptions* options);
+bool exact_step(Solver* solver);
+const Schedule* exact_best(const Solver* solver);
+Schedule exact_stop(Solver* solver);
+
+/**
+ * Laver en tilfældig vagtplan og bogføringen som simulated annealing og tabu søgning bruger
+ * til at udregne ændringen i scoren for et enkelt træk
+ * @param[out] state tilstanden der bliver sat op
+ */
+void local_search_init(LocalSearchState* state, const SolverProblem* problem, const SolverOptions* options);
+
+/**
+ * Udregner hvem der er på hvilke blokke og hver medarbejders score ud fra state->current
+ * @param[in, out] state tilstanden, problem og current skal være sat, og problem.workers skal være i id rækkefølge
+ */
+void local_search_index(LocalSearchState* state);
+
+/**
+ * Finder et tilfældigt træk hvor en medarbejder på en blok bliver erstattet af en der ikke er på blokken.
+ * Kun de to medarbejderes score bliver genberegnet
+ * @param[out] move trækket og hvor meget det ændrer scoren
+ * @returns false hvis der ikke findes et træk
+ */
+bool local_search_random_move(const LocalSearchState* state, LocalSearchMove* move);
+
+void local_search_apply_move(LocalSearchState* state, const LocalSearchMove* move);
+
+/**
+ * Kopierer den nuværende vagtplan over i den bedste
+ */
+void local_search_save_best(LocalSearchState* state);
+
+const Schedule* local_search_best(const Solver* solver);
+Schedule local_search_stop(Solver* solver);
+
+/**
+ * Skifter til indvandreren hvis den er bedre end den nuværende vagtplan
+ */
+void local_search_immigrate(Solver* solver, const Schedule* migrant);
+
+#ifdef ISLANDS_SUPPORTED
+/**
+ * Laver et delt hukommelsessegment som barneprocesser lavet med fork bagefter deler med
+ * processen. Segmentet har intet navn, så det forsvinder når det ikke er mappet længere
+ * @returns segmentet fyldt med 0, skal frigives med munmap
+ */
+void* map_shared_segment(VagtplanContext* context, size_t size);
+
+/**
+ * Kører motoren som flere samarbejdende processer, en for hver ø. Øerne deler et POSIX delt
+ * hukommelsessegment hvor hver ø udgiver sine bedste individer i kompakt index form, og tager
+ * de andre øers individer ind. Der bliver ikke låst, hver plads har kun en skriver og læserne
+ * tjekker pladsens seqlock. Koordinatoren samler den bedste vagtplan når alle øerne er færdige,
+ * og hvis en ø dør bliver de andre øer stadig brugt
+ * @returns den bedste vagtplan fra alle øerne
+ */
+Schedule island_schedule(const SolverProblem* problem, const SolverOptions* options);
+
+/**
+ * Kører en enkelt ø i en barneproces
+ * @param[in] stable_workers medarbejder arrayen som index i segmentet peger ind i
+ */
+void island_run(IslandSegment* segment, unsigned int island, const SolverProblem* problem, const SolverOptions* options, Worker** stable_workers);
+
+/**
+ * Udgiver det bedste individ øerne har lagt i segmentet til progress, og giver et ønske om at
+ * stoppe videre til øerne
+ * @param[in, out] published scoren der sidst blev udgivet
+ * @param[out] candidate plads til at pakke individerne ud i
+ */
+void island_watch(IslandSegment* segment, VagtplanProgress* progress, unsigned short* buffer, Worker** stable_workers, const SolverProblem* problem, Schedule* candidate, double* published);
+
+/**
+ * Tager alle nye individer fra de andre øer ind i solver
+ * @param[in, out] seen_generation den sidste generation der er læst fra hver plads
+ */
+void island_immigrate(Solver* solver, IslandSegment* segment, unsigned int island, unsigned int* seen_generation, unsigned short* buffer, Schedule* migrant, Worker** stable_workers, const SolverProblem* problem);
+
+MigrantHeader* island_slot(IslandSegment* segment, unsigned int island, unsigned int slot);
+
+/**
+ * Skriver en vagtplan ind i en af øens egne pladser, hver medarbejder som sit id
+ */
+void island_publish(IslandSegment* segment, unsigned int island, unsigned int slot, const Schedule* schedule, RequiredWorkers required_workers, unsigned int generation);
+
+/**
+ * Læser en plads uden at låse
+ * @param[out] buffer medarbejdernes index
+ * @returns false hvis pladsen er tom eller blev skrevet mens den blev læst
+ */
+bool island_read(IslandSegment* segment, unsigned int island, unsigned int slot, unsigned short* buffer, double* score, unsigned int* generation);
+
+/**
+ * Laver index fra segmentet om til en vagtplan som allerede har allokeret sine blokke
+ */
+void island_decode(VagtplanContext* context, const unsigned short* buffer, Worker** stable_workers, unsigned int worker_count, RequiredWorkers required_workers, Schedule* out);
+#endif
+
+/**
+ * Sørger for at skrivninger før kaldet bliver set af andre tråde før skrivninger efter det, til seqlocks
+ */
+void memory_barrier(void);
+
+/**
+ * Skriver en vagtplan ind i progress under seqlocken
+ * @param[in] steps hvor mange skridt motoren har taget
+ */
+void progress_publish(VagtplanProgress* progress, const Schedule* schedule, unsigned int steps);
+
+/**
+ * Udregner en enkelt medarbejders bidrag til scoren fra evaluate_schedule
+ * @param[in] worker medarbejderen, dens tilstand bliver ikke ændret
+ * @param[in] blocks en bit for hver blok medarbejderen arbejder på
+ * @param[in] static_scores kontekstens tabel over de faste scorer
+ */
+double score_worker_blocks(const Worker* worker, unsigned long blocks, const double* static_scores);
+
+/**
+ * Simulated annealing, forværringer bliver accepteret med en sandsynlighed der falder med temperaturen
+ * Et skridt er ANNEALING_MOVES_PER_STEP træk
+ */
+void annealing_init(Solver* solver, const SolverProblem* problem, const SolverOptions* options);
+bool annealing_step(Solver* solver);
+
+/**
+ * Tabu søgning, hvert skridt tager det bedste af TABU_CANDIDATES tilfældige træk som ikke er tabu
+ */
+void tabu_init(Solver* solver, const SolverProblem* problem, const SolverOptions* options);
+bool tabu_step(Solver* solver);
+
+/**
+ * Finder en bevist optimal vagtplan med branch and bound. Blokkene bliver fyldt i kronologisk
+ * rækkefølge, og hver medarbejders tilstand bliver opdateret løbende med score_assignment, så
+ * scoren er præcis den samme som evaluate_schedule giver. Egnet til afdelinger med 10-30 medarbejdere
+ * @param[in] upper_bound søgningen stopper hvis den finder en vagtplan med denne score
+ * @param[in] incumbent en evalueret vagtplan som søgningen skal slå, må være NULL
+ * @returns den bedste vagtplan, scoren er sat
+ */
+Schedule exact_schedule(VagtplanContext* context, Worker* workers[], unsigned int worker_count, RequiredWorkers required_workers, double upper_bound, const Schedule* incumbent);
+
+/**
+ * Et trin i den eksakte søgning, vælger en medarbejder til en plads i en blok
+ * @param[in, out] search søgningens tilstand
+ * @param[in] block blokken der bliver fyldt
+ * @param[in] slot pladsen i blokken der bliver fyldt
+ * @param[in] min_position den første position i blokkens rækkefølge der må vælges
+ * @param[in] score scoren for alle tildelinger indtil nu
+ */
+void exact_search(ExactSearch* search, unsigned int block, unsigned int slot, unsigned int min_position, double score);
+
+/**
+ * En optimistisk grænse for hvor meget scoren kan stige i resten af ugen
+ * @param[in] block den blok der bliver fyldt lige nu
+ * @param[in] slots_left_in_block antallet af ledige pladser i blokken
+ */
+double exact_bound(const ExactSearch* search, unsigned int block, unsigned int slots_left_in_block);
+
+/**
+ * Udregner for hver slags medarbejder, blok og tilstand den bedste score medarbejderen kan
+ * få alene i resten af ugen
+ * @param[out] table en tabel med WORKER_BOUND_TABLE_SIZE pladser
+ */
+void build_worker_bound_table(double* table);
+
+/**
+ * Udregner en øvre grænse for scoren før kørslen. For hver vagt kan medarbejderne der ønsker den
+ * tilsammen højst få så mange point som en fordeling af de ledige pladser giver, hvor hver
+ * medarbejder højst kan få det de kunne få alene i build_worker_bound_table, og højst en plads per blok
+ * @returns den øvre grænse, ingen vagtplan kan få en højere score
+ */
+double score_upper_bound(VagtplanContext* context, Worker* workers[], unsigned int worker_count, RequiredWorkers required_workers);
+
+/**
+ * @returns medarbejderens plads i tabellen fra build_worker_bound_table
+ */
+unsigned int worker_bound_index(const Worker* worker, unsigned int block);
+
+/**
+ * Tæller medarbejderens kvalifikationer med på blokken, eller fjerner dem igen med direction -1
+ */
+void exact_cover(ExactSearch* search, unsigned int block, const Worker* worker, int direction);
+
+/**
+ * @returns true hvis a og b har samme ønsker, kvalifikationer, fravær og tilstand, så de kan byttes uden at ændre scoren
+ */
+bool exact_equivalent_workers(const Worker* a, const Worker* b);
+
+/**
+ * Sorterer medarbejderne til en blok efter deres nuværende tilstand, så de mest lovende prøves først
+ * @param[in] block blokken der skal til at blive fyldt
+ */
+void exact_order_block(ExactSearch* search, unsigned int block);
+
+/**
+ * Vælger det bedste af tournament_size tilfældige individer
+ * @param[in] scores scoren for hvert individ
+ * @returns indexet på vinderen
+ */
+unsigned int tournament_select(VagtplanContext* context, const double* scores, unsigned int population_size, unsigned int tournament_size);
+
+/**
+ * Vælger det dårligste af tournament_size tilfældige individer, protected bliver aldrig valgt
+ * @returns indexet på taberen
+ */
+unsigned int tournament_select_loser(VagtplanContext* context, const double* scores, unsigned int population_size, unsigned int tournament_size, unsigned int protected_index);
+
+/**
+ * Allokerer en population, genernes størrelse bliver valgt ud fra antallet af medarbejdere
+ * @param[in] workers medarbejderne i vilkårlig rækkefølge
+ * @param[in] total_slots antallet af pladser i en vagtplan
+ */
+void init_population(VagtplanContext* context, Population* population, Worker** workers, unsigned int worker_count, unsigned int size, unsigned int total_slots);
+void free_population(VagtplanContext* context, Population* population);
+
+/**
+ * Gemmer en vagtplan og dens score som et individ i populationen
+ */
+void pack_individual(Population* population, unsigned int individual, const Schedule* schedule);
+
+/**
+ * Pakker et individ ud i en vagtplan der allerede er allokeret
+ */
+void unpack_individual(const Population* population, unsigned int individual, Schedule* out);
+
+/**
+ * Pakker en vagtplan til gener på gene_size bytes ligesom pack_individual
+ */
+void encode_genes(const Schedule* schedule, unsigned int gene_size, unsigned int total_slots, unsigned char* genes);
+
+/**
+ * Pakker gener ud til en vagtplan
+ * @param[in] workers medarbejderne i id rækkefølge
+ */
+void decode_genes(const unsigned char* genes, unsigned int gene_size, unsigned int total_slots, Worker** workers, Schedule* out);
+
+/**
+ * Kopierer et individ og dets score mellem to populationer med samme form
+ */
+void copy_individual(const Population* from, unsigned int from_individual, Population* to, unsigned int to_individual);
+
+/**
+ * Sorterer rangordenen med den højeste score først
+ */
+int compare_ranks(const void* a, const void* b);
+
+/**
+ * Lægger alle individer i ranks og sorterer dem efter score
+ */
+void rank_population(const Population* population, PopulationRank* ranks);
+
+/**
+ * Laver et enkelt tilfældigt skema med medarbejdere fra kontekstens puljer, ingen medarbejder
+ * kommer på to blokke samme dag
+ * @param[in] required_workers antallet af medarbejdere der er brug for
+ * @param[out] schedule der hvor det tilfældige skema bliver gemt
+ */
+void generate_random_schedule(VagtplanContext* context, const  RequiredWorkers required_workers,  Schedule* schedule);
+
+/**
+ * Fylder en vagtplan der allerede er allokeret tilfældigt ligesom generate_random_schedule
+ */
+void fill_random_schedule(VagtplanContext* context, const RequiredWorkers required_workers, Schedule* schedule);
+
+/**
+ * Fylder en vagtplan der allerede er allokeret grådigt og tilfældigt. Blokkene bliver fyldt i
+ * kronologisk rækkefølge med dem der ønsker vagten og ikke bryder en hård regel med deres forrige
+ * vagt, så vagtplanen starter tæt på at være gyldig. Ændrer tilstanden på kontekstens medarbejdere
+ */
+void fill_greedy_schedule(VagtplanContext* context, const RequiredWorkers required_workers, Schedule* schedule);
+
+
+/**
+ * Fitness funktionen for skemaer
+ * @param[in] schedule vagtplanen som bliver evalueret
+ * @param[in] required_workers mængden af medarbejdere der er brug for
+ * @param[in] static_scores kontekstens tabel over de faste scorer, medarbejderne skal være kontekstens
+ * @returns en værdi som siger hvor god planen er, nu højere nu bedre
+ */
+double evaluate_schedule(Schedule* schedule, const RequiredWorkers required_workers, Worker* worker[], unsigned int amount_of_workers, const double* static_scores);
+
+/**
+ * Sætter tilstanden som evaluate_schedule bruger tilbage til starten af ugen
+ */
+void reset_worker_state(Worker* worker);
+
+/**
+ * Sætter en medarbejder på en blok og opdaterer medarbejderens tilstand. Blokkene skal komme i kronologisk rækkefølge.
+ * Summen af static_score og score_transition, til medarbejdere der ikke er i en kontekst
+ * @param[in, out] current_worker medarbejderen
+ * @param[in] block_number blokken
+ * @returns hvor meget scoren ændrer sig af tildelingen
+ */
+double score_assignment(Worker* current_worker, unsigned int block_number);
+
+/**
+ * Den del af scoren for en tildeling som ikke afhænger af resten af vagtplanen: ønsket vagt, ønsket
+ * fridag og fravær. Nye bløde ønsker skal lægges her, så koster de ikke noget under søgningen
+ * @returns scoren for at sætte medarbejderen på blokken
+ */
+double static_score(const Worker* worker, unsigned int block);
+
+/**
+ * Den del af scoren der afhænger af medarbejderens forrige blok, altså de hårde regler, og
+ * opdaterer medarbejderens tilstand. Blokkene skal komme i kronologisk rækkefølge
+ * @returns strafpointene for tildelingen
+ */
+double score_transition(Worker* current_worker, unsigned int block_number);
+
+/**
+ * @returns hvor mange hårde regler det bryder at sætte medarbejderen på blokken, uden at ændre
+ * medarbejderens tilstand. Blokkene skal komme i kronologisk rækkefølge ligesom i score_transition
+ */
+unsigned int transition_broken_rules(const Worker* worker, unsigned int block_number);
+
+/**
+ * @returns strafpoint hvis medarbejderen ikke har haft et fridøgn når ugen er slut
+ */
+double score_week_end(const Worker* worker);
+
+
+/**
+ * Læser Workers ind fra den givne file pointer
+ * @param[in, out] file en åben fil
+ * @param[out] antallet af workers som blev indlæst fra filens
+ * @param[out] directory navne og uuid for medarbejderne, skal frigives med free_worker_directory
+ * @returns en array som er worker_count stor af Worker, hvor id er lig med pladsen i arrayen
+ */
+ Worker* read_workers(VagtplanContext* context, FILE* file, unsigned int* worker_count, WorkerDirectory* directory);
+
+/**
+ * Gemmer et navn i directory, hvis navnet allerede findes bliver den samme streng brugt
+ * @param[in, out] index alle de navne der er gemt i directory indtil nu
+ * @returns hvor navnet starter i directory->names
+ */
+unsigned int intern_worker_name(VagtplanContext* context, WorkerDirectory* directory, NameIndex* index, const char* name);
+
+/**
+ * Finder afdelingen med navnet, eller tilføjer den. directory->department_offsets skal have plads til
+ * en afdeling mere
+ * @returns afdelingens nummer
+ */
+unsigned short intern_department(VagtplanContext* context, WorkerDirectory* directory, NameIndex* index, const char* name);
+
+/**
+ * Laver en tom NameIndex, den frigives med context_free på slots når directory er bygget
+ */
+void name_index_init(VagtplanContext* context, NameIndex* index);
+
+/**
+ * Fordobler tabellen og sætter navnene ind igen
+ */
+void name_index_grow(VagtplanContext* context, const WorkerDirectory* directory, NameIndex* index);
+
+/**
+ * FNV-1a på 32 bit over en streng
+ */
+unsigned long hash_name(const char* name);
+
+/**
+ * Kopierer medarbejderne i en afdeling fra source ind i konteksten som dens eneste afdeling
+ * @param[out] global_ids nummeret i source for hver medarbejder i konteksten
+ */
+enum VagtplanStatus copy_department_workers(VagtplanContext* context, const VagtplanContext* source, unsigned int department, unsigned short** global_ids);
+
+/**
+ * Løser afdelingerne fra begin til end, som en opgave i en pulje
+ * @param[in] argument DepartmentJob
+ */
+void solve_departments(void* argument, unsigned int thread, unsigned long begin, unsigned long end);
+
+/**
+ * Løser en afdeling i sin egen kontekst, så den kan køre i sin egen tråd
+ * @param[in] starts hvor hver afdeling starter i hver blok af den samlede vagtplan, 21 for hver afdeling
+ * @param[out] result hvordan det gik, status er sat og message er fejlteksten hvis det ikke lykkedes
+ * @param[out] slots den samlede vagtplans pladser, afdelingens pladser bliver sat til nummeret på medarbejderen
+ */
+void solve_department(const VagtplanContext* context, unsigned int department, const RequiredWorkers* required_workers, const SolverOptions* options, const unsigned int* starts, DepartmentResult* result, unsigned short* slots);
+
+const char* worker_name(const WorkerDirectory* directory, const Worker* worker);
+
+unsigned int worker_uuid(const WorkerDirectory* directory, const Worker* worker);
+
+/**
+ * Bygger directory->uuid_index ud fra uuids. Hvis et uuid står flere gange kommer det laveste id
+ * først, så det er den medarbejder der bliver fundet
+ */
+void build_uuid_index(VagtplanContext* context, WorkerDirectory* directory);
+int compare_uuid_entries(const void* a, const void* b);
+
+/**
+ * Finder en medarbejder med binær søgning i directory->uuid_index
+ * @param[out] worker medarbejderens id
+ * @returns false hvis der ikke er nogen medarbejder med uuidet
+ */
+bool find_uuid(const WorkerDirectory* directory, unsigned int uuid, unsigned int* worker);
+
+/**
+ * Udregner hvor hver tabel i cachen starter. Tabellerne er medarbejderne, uuids, name_offsets,
+ * uuid_index, departments, department_offsets og names, hver justeret til 8 bytes
+ * @param[out] offsets starten af hver af de WORKER_CACHE_SECTIONS tabeller
+ * @param[out] lengths længden af hver tabel
+ * @returns længden af hele cachen
+ */
+size_t worker_cache_layout(const WorkerCacheHeader* header, size_t* offsets, size_t* lengths);
+
+/**
+ * Læser størrelsen og tidspunktet for sidste ændring af en fil uden at læse indholdet. Uden POSIX
+ * er tidspunktet altid 0, så hashen altid bliver tjekket
+ * @returns false hvis filen ikke kunne åbnes
+ */
+bool read_source_key(const char* file_name, unsigned long* size, unsigned long* time);
+
+/**
+ * FNV-1a på 32 bit over hele filen
+ * @returns false hvis filen ikke kunne læses
+ */
+bool hash_file(const char* file_name, unsigned long* hash);
+
+/**
+ * Læser headeren i en cache og tjekker at den passer til denne oversættelse og til filens længde
+ * @returns false hvis cachen ikke findes eller ikke kan bruges
+ */
+bool read_worker_cache_header(const char* cache_name, WorkerCacheHeader* header);
+
+/**
+ * Kopierer tabellerne i cachen ud til targets. På POSIX bliver filen mappet ind i hukommelsen,
+ * ellers bliver den læst med fread. Der bliver ikke hoppet ud af funktionen, så filen altid bliver lukket
+ * @param[in] targets hvor hver af de WORKER_CACHE_SECTIONS tabeller skal kopieres til
+ * @returns false hvis filen ikke kunne læses eller har ændret længde
+ */
+bool copy_worker_cache(const char* cache_name, size_t length, const size_t* offsets, const size_t* lengths, void* const* targets);
+
+/**
+ * Tjekker at tabellerne fra en cache passer sammen, så en ødelagt cache ikke kan pege uden for dem
+ */
+bool valid_worker_cache(const Worker* workers, const WorkerDirectory* directory);
+
+/**
+ * Læser medarbejderlisten fra cachen ind i konteksten og bygger puljerne
+ * @param[in] header headeren fra read_worker_cache_header
+ */
+enum VagtplanStatus load_worker_cache(VagtplanContext* context, const char* cache_name, const WorkerCacheHeader* header);
+
+/**
+ * Skriver kontekstens medarbejderliste til en cache. Der bliver først skrevet til en midlertidig fil
+ * som så bliver omdøbt, så en anden proces aldrig læser en halv cache
+ * @param[in] source størrelsen, tidspunktet og hashen for CSV filen
+ * @returns false hvis cachen ikke kunne skrives
+ */
+bool write_worker_cache(const VagtplanContext* context, const char* cache_name, const WorkerCacheHeader* source);
+
+/**
+ * Skriver schedule ud i en fil
+ * @param[in, out] file en åben fil hvor schedule skal skrives til
+ * @param[in] schedule skemaet som skal skrives
+ */
+void write_schedule(FILE* file, const  Schedule* schedule, RequiredWorkers required_workers, const WorkerDirectory* directory);
+
+/**
+ * Læser en schedule som er gemt i en fil
+ * @param[in, out] file en åben fil hvor schedule skal læses fra
+ * @param[out] out der hvor mængden af arbejdere hver dag bliver gemt
+ * @return det indlæste skema
+ */
+Schedule read_schedule(VagtplanContext* context, FILE* file, RequiredWorkers* out, Worker** workers, unsigned int worker_count, const WorkerDirectory* directory);
+
+/**
+ * Læser en schedule ligesom read_schedule, men medarbejdere med et uuid der ikke findes bliver sat til NULL
+ * @param[out] unknown_workers antallet af pladser hvor uuidet ikke fandtes
+ */
+Schedule read_schedule_lenient(VagtplanContext* context, FILE* file, RequiredWorkers* out, Worker** workers, unsigned int worker_count, const WorkerDirectory* directory, unsigned int* unknown_workers);
+
+enum Shift string_to_shift(char* input);
+
+enum Day string_to_day(char* input);
+
+enum Skill string_to_skill(const char* input);
+
+const char* get_skill_as_string(enum Skill skill);
+
+/**
+ * Læser kolonnerne efter uuid, som er kvalifikationer og højst en afdeling:navn
+ * @param[in] text resten af linjen efter uuid
+ * @param[out] skills en bit for hver kvalifikation
+ * @param[out] department afdelingens navn, tom hvis der ikke er nogen, plads til MAX_NAME_LENGTH tegn
+ * @returns false hvis en af kolonnerne ikke er en kvalifikation eller en afdeling
+ */
+bool parse_worker_columns(const char* text, unsigned char* skills, char* department);
+
+/**
+ * Laver et barn af a og b med crossover, og muterer det med den sandsynlighed og det antal blokke
+ * som mutation siger
+ * @param[in] mutation den nuværende mutationsrate
+ * @param[in] crossover operatoren, ikke CROSSOVER_ADAPTIVE
+ * @param[out] out barnet, skal allerede have allokeret sine blokke
+ */
+void combine_schedule(VagtplanContext* context, RequiredWorkers required_workers, const  Schedule* a, const  Schedule* b,  Schedule* out, const MutationControl* mutation, enum CrossoverOperator crossover);
+
+/**
+ * Barnet får hver blok fra a, men for en tilfældig halvdel af medarbejderne bliver deres pladser
+ * taget fra b. Blokke der ender med for mange eller for få bliver rettet med a's medarbejdere
+ */
+void combine_worker_rows(VagtplanContext* context, const RequiredWorkers* required_workers, const Schedule* a, const Schedule* b, Schedule* out);
+
+/**
+ * @param[in] fixed operatoren der altid skal bruges, eller CROSSOVER_ADAPTIVE
+ */
+void init_crossover_control(CrossoverControl* crossover, enum CrossoverOperator fixed);
+
+/**
+ * @returns operatoren til det næste barn, trukket efter sandsynlighederne
+ */
+enum CrossoverOperator choose_crossover(VagtplanContext* context, const CrossoverControl* crossover);
+
+/**
+ * Tæller et barn med for dets operator
+ * @param[in] survived om barnet fik en højere score end begge forældre
+ */
+void record_crossover(CrossoverControl* crossover, enum CrossoverOperator operator, bool survived);
+
+/**
+ * Opdaterer operatorernes kvalitet efter en generation og fordeler sandsynlighederne efter den,
+ * hver operator beholder mindst CROSSOVER_MIN_PROBABILITY så den kan komme tilbage
+ */
+void update_crossover_control(CrossoverControl* crossover);
+
+/**
+ * Omskriver tilfældige blokke i et skema med tilfældige medarbejdere fra puljerne
+ * @param[in, out] schedule skemaet der bliver muteret
+ * @param[in] blocks antallet af blokke der bliver omskrevet
+ */
+void mutate_schedule(VagtplanContext* context, RequiredWorkers required_workers, Schedule* schedule, unsigned int blocks);
+
+/**
+ * Sætter mutationsraten til startværdierne
+ * @param[out] mutation kontrolstrukturen
+ * @param[in] adaptive om raten skal tilpasses undervejs, ellers er den fast
+ */
+void init_mutation_control(MutationControl* mutation, bool adaptive);
+
+/**
+ * Tilpasser mutationsraten efter en generation. Raten og antallet af blokke stiger når den bedste
+ * score står stille eller populationen mister diversitet, og falder igen når der sker fremskridt
+ * @param[in, out] mutation kontrolstrukturen
+ * @param[in] best_score den bedste score i populationen lige nu
+ * @param[in] diversity diversiteten fra population_diversity
+ * @returns true hvis populationen har stået stille så længe at der skal laves en genstart med nye individer
+ */
+bool update_mutation_control(MutationControl* mutation, double best_score, double diversity);
+
+/**
+ * Måler hvor forskellige individerne i populationen er ved at sammenligne tilfældige par
+ * @returns andelen af blokke som er forskellige i de sammenlignede par, mellem 0 og 1
+ */
+double population_diversity(VagtplanContext* context, const Population* population, RequiredWorkers required_workers);
+
+/**
+ * Erstatter en del af populationen med nye tilfældige og evaluerede individer
+ * @param[in, out] population populationen
+ * @param[in] ranks rangordenen som first tæller i, eller NULL hvis first er et individ
+ * @param[in] first den første plads der må erstattes
+ * @param[in] protected_index et individ der aldrig bliver erstattet, f.eks. det bedste
+ * @param[out] scratch en allokeret vagtplan som de nye individer bliver lavet i
+ */
+void inject_immigrants(VagtplanContext* context, Population* population, const PopulationRank* ranks, unsigned int first, unsigned int protected_index, Schedule* scratch, Worker* workers[], unsigned int worker_count, RequiredWorkers required_workers);
+
+int random_number(VagtplanContext* context, int min, int max);
+
+/**
+ * @returns antallet af medarbejdere der skal være på blokken
+ */
+unsigned int required_for_block(const RequiredWorkers* required_workers, unsigned int block);
+
+/**
+ * Udregner offsets ud fra antallet på hver blok og nulstiller kravene til kvalifikationer
+ * @param[in] counts antallet på hver af de 21 blokke
+ */
+void set_required_offsets(RequiredWorkers* required_workers, const unsigned int* counts);
+
+/**
+ * @param[in] workers medarbejderne i samme rækkefølge som deres id, som fra context_worker_array
+ * @returns medarbejderen med uuidet, eller NULL hvis der ikke er nogen
+ */
+Worker* find_worker_from_uuid(Worker** workers, unsigned int worker_count, const WorkerDirectory* directory, unsigned int uuid);
+
+void free_schedule(VagtplanContext* context, Schedule* schedule);
+
+int maxi(int a, int b);
+
+/**
+ * @returns sekunder fra et fast tidspunkt, målt på væggen så tråde ikke tæller med i hinandens tid
+ */
+double wall_seconds();
+
+const char* get_shift_as_string(enum Shift shift);
+const char* get_day_as_string(enum Day day);
+
+/**
+ * Genplanlægningen bag vagtplan_replan_schedule
+ * @param[in] published den udgivne vagtplan, medarbejderne skal pege ind i kontekstens medarbejdere
+ * @param[in] sick_worker nummeret på medarbejderen som ikke kan dække blokkene
+ * @param[in] forbidden_blocks en bit for hver blok medarbejderen ikke kan dække
+ * @param[in] max_changes det højeste antal ændringer, eller -1 for standardværdien
+ * @param[out] best_changes antallet af ændringer i den returnerede vagtplan
+ * @returns den nye vagtplan, scoren er sat
+ */
+Schedule replan_schedule(VagtplanContext* context, const Schedule* published, RequiredWorkers required_workers, unsigned int sick_worker, unsigned long forbidden_blocks, int max_changes, unsigned int* best_changes);
+
+/**
+ * Laver et træk der erstatter medarbejderen på en plads med candidate, hvis det er tilladt
+ * @returns false hvis candidate allerede er på blokken, eller er den syge medarbejder på en af de blokke de ikke kan dække
+ */
+bool replan_move(const LocalSearchState* state, unsigned int block, unsigned int slot, unsigned int candidate, unsigned int sick_worker, unsigned long forbidden_blocks, LocalSearchMove* move);
+
+/**
+ * @returns hvor meget trækket ændrer antallet af pladser der er forskellige fra den udgivne vagtplan
+ */
+int replan_change_delta(const LocalSearchMove* move, const unsigned long* published_occupancy);
+
+/**
+ * @returns en bit for hver blok der er tæt nok på block til at genplanlægningen må ændre den
+ */
+unsigned long replan_nearby_blocks(unsigned int block);
+
+void replan_add_vacated(VagtplanContext* context, unsigned int* vacated_block, unsigned int* vacated_slot, unsigned int* vacated_count, unsigned int block, unsigned int slot);
+
+VagtplanContext* vagtplan_create(const VagtplanAllocator* allocator, unsigned long seed) {
+	VagtplanAllocator standard;
+	VagtplanContext* context;
+
+	if (allocator == NULL) {
+		standard.allocate = default_allocate;
+		standard.reallocate = default_reallocate;
+		standard.release = default_release;
+		standard.user = NULL;
+		allocator = &standard;
+	}
+	context = allocator->allocate(allocator->user, sizeof(VagtplanContext));
+	if (context == NULL) {
+		return NULL;
+	}
+	context->allocator = *allocator;
+	context->allocations = NULL;
+	context->allocation_serial = 0;
+	context->status = VAGTPLAN_OK;
+	context->error_message[0] = 0;
+	/*xorshift må aldrig have en tilstand der er 0*/
+	context->random_state = seed & 0xFFFFFFFFUL;
+	if (context->random_state == 0) {
+		context->random_state = 0x9E3779B9UL;
+	}
+	context->log = NULL;
+	context->workers = NULL;
+	context->worker_count = 0;
+	context->pools.workers = NULL;
+	context->pools.stamps = NULL;
+	context->static_scores = NULL;
+	context->pools.stamp = 0;
+	context->directory.department_count = 0;
+	return context;
+}
+
+void vagtplan_destroy(VagtplanContext* context) {
+	VagtplanAllocator allocator;
+	if (context == NULL) {
+		return;
+	}
+	allocator = context->allocator;
+	while (context->allocations != NULL) {
+		Allocation* next = context->allocations->links.next;
+		allocator.release(allocator.user, context->allocations);
+		context->allocations = next;
+	}
+	allocator.release(allocator.user, context);
+}
+
+void vagtplan_set_log(VagtplanContext* context, FILE* log) {
+	context->log = log;
+}
+
+enum VagtplanStatus vagtplan_parallel_for(VagtplanContext* context, unsigned int threads, unsigned long count, unsigned long grain, VagtplanTaskFunction function, void* argument) {
+	unsigned long mark = context_begin(context);
+#ifdef THREADS_SUPPORTED
+	TaskPool* pool;
+	TaskGroup group;
+#endif
+
+	if (setjmp(context->error_jump) != 0) {
+		return context_rollback(context, mark);
+	}
+	if (threads > MAX_THREADS) {
+		context_fail(context, VAGTPLAN_ERROR_ARGUMENT, "Ugyldigt antal tråde");
+	}
+	if (count == 0) {
+		return VAGTPLAN_OK;
+	}
+#ifdef THREADS_SUPPORTED
+	if (threads == 0) {
+		long processors = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = processors < 1 ? 1 : processors > MAX_THREADS ? MAX_THREADS : (unsigned int) processors;
+	}
+	if (threads > count) {
+		threads = (unsigned int) count;
+	}
+	if (threads > 1) {
+		pool = task_pool_create(context, threads);
+		group.pending = 0;
+		task_pool_submit(pool, 0, &group, function, argument, 0, count, grain);
+		task_pool_join(pool, 0, &group);
+		task_pool_destroy(context, pool);
+		return VAGTPLAN_OK;
+	}
+#endif
+	function(argument, 0, 0, count);
+	return VAGTPLAN_OK;
+}
+
+const char* vagtplan_error_message(const VagtplanContext* context) {
+	return context->error_message;
+}
+
+void vagtplan_default_options(SolverOptions* options) {
+	options->engine = ENGINE_GENERATIONAL;
+	options->generations = MAX_GENERATIONS;
+	options->tournament_size = DEFAULT_TOURNAMENT_SIZE;
+	options->population_size = DEFAULT_POPULATION_SIZE;
+	options->elite_size = DEFAULT_ELITE_SIZE;
+	options->children_per_elite = DEFAULT_CHILDREN_PER_ELITE;
+	options->threads = 1;
+	options->adaptive_mutation = true;
+	options->crossover = CROSSOVER_ADAPTIVE;
+	options->islands = 1;
+	options->time_limit = 0;
+	options->alternatives = 1;
+	options->min_distance = 0;
+	options->parallel_departments = 4;
+	options->greedy_fraction = DEFAULT_GREEDY_FRACTION;
+	options->progress = NULL;
+}
+
+enum VagtplanStatus vagtplan_read_workers(VagtplanContext* context, FILE* file) {
+	unsigned long mark = context_begin(context);
+	Worker* workers;
+	unsigned int worker_count = 0;
+
+	if (context->workers != NULL) {
+		return context_error(context, VAGTPLAN_ERROR_ARGUMENT, "Konteksten har allerede en medarbejderliste");
+	}
+	if (setjmp(context->error_jump) != 0) {
+		/*Puljerne bliver bygget efter medarbejderne er sat, så de skal fjernes igen hvis det fejler*/
+		context->workers = NULL;
+		context->worker_count = 0;
+		context->pools.workers = NULL;
+		context->pools.stamps = NULL;
+		context->static_scores = NULL;
+		return context_rollback(context, mark);
+	}
+	workers = read_workers(context, file, &worker_count, &context->directory);
+	context->workers = workers;
+	context->worker_count = worker_count;
+	build_candidate_pools(context);
+	return VAGTPLAN_OK;
+}
+
+enum VagtplanStatus vagtplan_read_workers_cached(VagtplanContext* context, const char* file_name, const char* cache_name, bool* used_cache) {
+	WorkerCacheHeader source;
+	WorkerCacheHeader cached;
+	enum VagtplanStatus status;
+	char reason[160];
+	bool have_cache;
+	FILE* file;
+
+	context_begin(context);
+	if (used_cache != NULL) {
+		*used_cache = false;
+	}
+	if (context->workers != NULL) {
+		return context_error(context, VAGTPLAN_ERROR_ARGUMENT, "Konteksten har allerede en medarbejderliste");
+	}
+	sprintf(reason, "Kunne ikke åbne %.120s", file_name);
+	if (!read_source_key(file_name, &source.source_size, &source.source_time)) {
+		return context_error(context, VAGTPLAN_ERROR_SYSTEM, reason);
+	}
+	have_cache = read_worker_cache_header(cache_name, &cached) && cached.source_size == source.source_size;
+	/*Tidspunktet kan kun bruges hvis CSV filen blev ændret i et tidligere sekund end cachen blev
+	skrevet, ellers kan den være ændret igen i samme sekund*/
+	if (have_cache && source.source_time != 0 && cached.source_time == source.source_time && cached.source_time < cached.written_time) {
+		if (load_worker_cache(context, cache_name, &cached) == VAGTPLAN_OK) {
+			if (used_cache != NULL) {
+				*used_cache = true;
+			}
+			return VAGTPLAN_OK;
+		}
+		have_cache = false;
+	}
+	if (!hash_file(file_name, &source.source_hash)) {
+		return context_error(context, VAGTPLAN_ERROR_SYSTEM, reason);
+	}
+	if (have_cache && cached.source_hash == source.source_hash && load_worker_cache(context, cache_name, &cached) == VAGTPLAN_OK) {
+		/*Indholdet er det samme, så cachen får det nye tidspunkt og næste gang skal filen ikke hashes*/
+		write_worker_cache(context, cache_name, &source);
+		if (used_cache != NULL) {
+			*used_cache = true;
+		}
+		return VAGTPLAN_OK;
+	}
+
+	file = fopen(file_name, "r");
+	if (file == NULL) {
+		return context_error(context, VAGTPLAN_ERROR_SYSTEM, reason);
+	}
+	status = vagtplan_read_workers(context, file);
+	fclose(file);
+	if (status != VAGTPLAN_OK) {
+		return status;
+	}
+	/*Cachen er kun en genvej, så det er ikke en fejl hvis den ikke kan skrives*/
+	write_worker_cache(context, cache_name, &source);
+	return VAGTPLAN_OK;
+}
+
+enum VagtplanStatus vagtplan_copy_workers(VagtplanContext* context, const VagtplanContext* source) {
+	unsigned long mark = context_begin(context);
+	const WorkerDirectory* from = &source->directory;
+	WorkerDirectory* to = &context->directory;
+	unsigned int count = source->worker_count;
+
+	if (context->workers != NULL) {
+		return context_error(context, VAGTPLAN_ERROR_ARGUMENT, "Konteksten har allerede en medarbejderliste");
+	}
+	if (setjmp(context->error_jump) != 0) {
+		context->workers = NULL;
+		context->worker_count = 0;
+		context->pools.workers = NULL;
+		context->pools.stamps = NULL;
+		context->static_scores = NULL;
+		return context_rollback(context, mark);
+	}
+	if (source->workers == NULL) {
+		context_fail(context, VAGTPLAN_ERROR_ARGUMENT, "Der er ikke læst nogen medarbejderliste");
+	}
+	context->workers = context_allocate(context, count * sizeof(Worker));
+	to->uuids = context_allocate(context, count * sizeof(unsigned int));
+	to->name_offsets = context_allocate(context, count * sizeof(unsigned int));
+	to->names = context_allocate(context, from->names_length);
+	to->departments = context_allocate(context, count * sizeof(unsigned short));
+	to->department_offsets = context_allocate(context, from->department_count * sizeof(unsigned int));
+	memcpy(context->workers, source->workers, count * sizeof(Worker));
+	memcpy(to->uuids, from->uuids, count * sizeof(unsigned int));
+	memcpy(to->name_offsets, from->name_offsets, count * sizeof(unsigned int));
+	memcpy(to->names, from->names, from->names_length);
+	to->uuid_index = context_allocate(context, count * sizeof(UuidEntry));
+	memcpy(to->departments, from->departments, count * sizeof(unsigned short));
+	memcpy(to->department_offsets, from->department_offsets, from->department_count * sizeof(unsigned int));
+	memcpy(to->uuid_index, from->uuid_index, count * sizeof(UuidEntry));
+	to->worker_count = count;
+	to->department_count = from->department_count;
+	to->names_length = from->names_length;
+	to->names_allocated = from->names_length;
+	context->worker_count = count;
+	build_candidate_pools(context);
+	return VAGTPLAN_OK;
+}
+
+enum VagtplanStatus copy_department_workers(VagtplanContext* context, const VagtplanContext* source, unsigned int department, unsigned short** global_ids) {
+	unsigned long mark = context_begin(context);
+	const WorkerDirectory* from = &source->directory;
+	WorkerDirectory* to = &context->directory;
+	NameIndex names;
+	unsigned int count = 0;
+	unsigned int i;
+
+	if (context->workers != NULL) {
+		return context_error(context, VAGTPLAN_ERROR_ARGUMENT, "Konteksten har allerede en medarbejderliste");
+	}
+	if (setjmp(context->error_jump) != 0) {
+		context->workers = NULL;
+		context->worker_count = 0;
+		context->directory.department_count = 0;
+		context->pools.workers = NULL;
+		context->pools.stamps = NULL;
+		context->static_scores = NULL;
+		return context_rollback(context, mark);
+	}
+	for (i = 0; i < source->worker_count; i++) {
+		if (from->departments[i] == department) {
+			count++;
+		}
+	}
+	context->workers = context_allocate(context, count * sizeof(Worker));
+	to->uuids = context_allocate(context, count * sizeof(unsigned int));
+	to->name_offsets = context_allocate(context, count * sizeof(unsigned int));
+	to->departments = context_allocate_zero(context, count, sizeof(unsigned short));
+	to->department_offsets = context_allocate(context, sizeof(unsigned int));
+	to->names_allocated = count * 16 + 1;
+	to->names = context_allocate(context, to->names_allocated);
+	to->names_length = 0;
+	to->worker_count = 0;
+	name_index_init(context, &names);
+	*global_ids = context_allocate(context, count * sizeof(unsigned short));
+	for (i = 0; i < source->worker_count; i++) {
+		unsigned int local = to->worker_count;
+		if (from->departments[i] != department) {
+			continue;
+		}
+		/*Kvalifikationerne og fraværet følger med, kun id skifter*/
+		context->workers[local] = source->workers[i];
+		context->workers[local].id = (unsigned short) local;
+		to->uuids[local] = from->uuids[i];
+		to->name_offsets[local] = intern_worker_name(context, to, &names, from->names + from->name_offsets[i]);
+		(*global_ids)[local] = (unsigned short) i;
+		to->worker_count = local + 1;
+	}
+	to->department_count = 1;
+	to->department_offsets[0] = intern_worker_name(context, to, &names, from->names + from->department_offsets[department]);
+	context_free(context, names.slots);
+	build_uuid_index(context, to);
+	context->worker_count = count;
+	build_candidate_pools(context);
+	return VAGTPLAN_OK;
+}
+
+unsigned int vagtplan_worker_count(const VagtplanContext* context) {
+	return context->worker_count;
+}
+
+const char* vagtplan_worker_name(const VagtplanContext* context, unsigned int worker) {
+	return worker_name(&context->directory, &context->workers[worker]);
+}
+
+unsigned int vagtplan_worker_uuid(const VagtplanContext* context, unsigned int worker) {
+	return worker_uuid(&context->directory, &context->workers[worker]);
+}
+
+unsigned int vagtplan_department_count(const VagtplanContext* context) {
+	return context->directory.department_count;
+}
+
+const char* vagtplan_department_name(const VagtplanContext* context, unsigned int department) {
+	return context->directory.names + context->directory.department_offsets[department];
+}
+
+unsigned int vagtplan_worker_department(const VagtplanContext* context, unsigned int worker) {
+	return context->directory.departments[worker];
+}
+
+enum VagtplanStatus vagtplan_find_worker(VagtplanContext* context, unsigned int uuid, unsigned int* worker) {
+	context_begin(context);
+	if (context->workers != NULL && find_uuid(&context->directory, uuid, worker)) {
+		return VAGTPLAN_OK;
+	}
+	return context_error(context, VAGTPLAN_ERROR_UNKNOWN_WORKER, "Der er ingen medarbejder med det uuid");
+}
+
+enum VagtplanStatus vagtplan_set_forbidden_blocks(VagtplanContext* context, unsigned int worker, unsigned long blocks) {
+	unsigned long mark = context_begin(context);
+	unsigned long previous;
+
+	if (worker >= context->worker_count) {
+		return context_error(context, VAGTPLAN_ERROR_ARGUMENT, "Der er ingen medarbejder med det nummer");
+	}
+	previous = context->workers[worker].forbidden_blocks;
+	if (setjmp(context->error_jump) != 0) {
+		context->workers[worker].forbidden_blocks = previous;
+		return context_rollback(context, mark);
+	}
+	context->workers[worker].forbidden_blocks = blocks & ALL_BLOCKS;
+	build_candidate_pools(context);
+	return VAGTPLAN_OK;
+}
+
+enum VagtplanStatus vagtplan_read_availability(VagtplanContext* context, FILE* file) {
+	unsigned long mark = context_begin(context);
+	unsigned long* forbidden;
+	char text[MAX_AVAILABILITY_TEXT + 1];
+	char reason[160];
+	unsigned int line = 0;
+	unsigned int uuid;
+	unsigned int i;
+	int res;
+
+	if (setjmp(context->error_jump) != 0) {
+		return context_rollback(context, mark);
+	}
+	context_require_workers(context);
+	/*Masken bliver bygget for sig selv, så medarbejderne er urørte hvis filen har en fejl*/
+	forbidden = context_allocate(context, context->worker_count * sizeof(unsigned long));
+	for (i = 0; i < context->worker_count; i++) {
+		forbidden[i] = context->workers[i].forbidden_blocks;
+	}
+	while ((res = fscanf(file, " %u %*1[;,] %255[^\n]", &uuid, text)) != EOF) {
+		unsigned long blocks;
+		char* end;
+		line++;
+		if (res != 2) {
+			sprintf(reason, "Fejl i fraværet på linje %u", line);
+			context_fail(context, VAGTPLAN_ERROR_FORMAT, reason);
+		}
+		text[MAX_AVAILABILITY_TEXT] = 0;
+		/*Listen af blokke bruger komma, så semikolon bliver lavet om, og linjeskift fra Windows fjernet*/
+		for (end = text; *end != 0; end++) {
+			if (*end == ';') {
+				*end = ',';
+			}
+		}
+		while (end > text && (end[-1] == '\r' || end[-1] == ' ' || end[-1] == ',')) {
+			*--end = 0;
+		}
+		if (!vagtplan_parse_block_list(text, &blocks)) {
+			sprintf(reason, "Fejl i fraværet på linje %u ved blokkene: %.64s", line, text);
+			context_fail(context, VAGTPLAN_ERROR_FORMAT, reason);
+		}
+		if (!find_uuid(&context->directory, uuid, &i)) {
+			sprintf(reason, "Fejl i fraværet på linje %u, der er ingen medarbejder med uuid %u", line, uuid);
+			context_fail(context, VAGTPLAN_ERROR_UNKNOWN_WORKER, reason);
+		}
+		forbidden[i] |= blocks;
+	}
+
+	for (i = 0; i < context->worker_count; i++) {
+		unsigned long previous = context->workers[i].forbidden_blocks;
+		context->workers[i].forbidden_blocks = forbidden[i];
+		forbidden[i] = previous;
+	}
+	if (setjmp(context->error_jump) != 0) {
+		/*De nye puljer kunne ikke allokeres, så medarbejderne får deres gamle masker igen*/
+		for (i = 0; i < context->worker_count; i++) {
+			context->workers[i].forbidden_blocks = forbidden[i];
+		}
+		return context_rollback(context, mark);
+	}
+	build_candidate_pools(context);
+	context_free(context, forbidden);
+	return VAGTPLAN_OK;
+}
+
+RequiredWorkers vagtplan_required_per_shift(unsigned int night_workers, unsigned int day_workers, unsigned int evening_workers) {
+	RequiredWorkers rv;
+	unsigned int counts[21];
+	unsigned int day;
+	for (day = 0; day < 7; day++) {
+		counts[day * 3 + SHIFT_NIGHT] = night_workers;
+		counts[day * 3 + SHIFT_DAY] = day_workers;
+		counts[day * 3 + SHIFT_EVENING] = evening_workers;
+	}
+	set_required_offsets(&rv, counts);
+	return rv;
+}
+
+RequiredWorkers vagtplan_required_per_block(const unsigned int* counts) {
+	RequiredWorkers rv;
+	set_required_offsets(&rv, counts);
+	return rv;
+}
+
+unsigned int vagtplan_required_count(const RequiredWorkers* required_workers, unsigned int block) {
+	return required_for_block(required_workers, block);
+}
+
+enum VagtplanStatus vagtplan_read_required_workers(VagtplanContext* context, FILE* file, RequiredWorkers* out) {
+	unsigned int counts[21];
+	bool seen[7] = {false, false, false, false, false, false, false};
+	unsigned int line = 0;
+	unsigned int day;
+	char day_text[33];
+	char reason[128];
+	unsigned int night;
+	unsigned int day_count;
+	unsigned int evening;
+	int res;
+
+	context_begin(context);
+	while ((res = fscanf(file, " %32[^;,] %*1[;,] %u %*1[;,] %u %*1[;,] %u%*[^\n]", day_text, &night, &day_count, &evening)) != EOF) {
+		enum Day parsed;
+		line++;
+		if (res != 4) {
+			sprintf(reason, "Fejl i bemandingen på linje %u", line);
+			return context_error(context, VAGTPLAN_ERROR_FORMAT, reason);
+		}
+		day_text[32] = 0;
+		parsed = string_to_day(day_text);
+		if (parsed == DAY_INVALID || seen[parsed]) {
+			sprintf(reason, "Fejl i bemandingen på linje %u, %s er ikke en ny dag", line, day_text);
+			return context_error(context, VAGTPLAN_ERROR_FORMAT, reason);
+		}
+		if (night == 0 || day_count == 0 || evening == 0) {
+			sprintf(reason, "Fejl i bemandingen på linje %u, der skal være mindst en på hver vagt", line);
+			return context_error(context, VAGTPLAN_ERROR_FORMAT, reason);
+		}
+		seen[parsed] = true;
+		counts[parsed * 3 + SHIFT_NIGHT] = night;
+		counts[parsed * 3 + SHIFT_DAY] = day_count;
+		counts[parsed * 3 + SHIFT_EVENING] = evening;
+	}
+	for (day = 0; day < 7; day++) {
+		if (!seen[day]) {
+			sprintf(reason, "Bemandingen mangler %s", get_day_as_string(day));
+			return context_error(context, VAGTPLAN_ERROR_FORMAT, reason);
+		}
+	}
+	set_required_offsets(out, counts);
+	return VAGTPLAN_OK;
+}
+
+enum VagtplanStatus vagtplan_read_skill_requirements(VagtplanContext* context, FILE* file, RequiredWorkers* required_workers) {
+	unsigned char skills[21][VAGTPLAN_SKILL_COUNT];
+	unsigned int line = 0;
+	char day_text[33];
+	char shift_text[33];
+	char skill_text[33];
+	char reason[160];
+	unsigned int minimum;
+	int res;
+
+	context_begin(context);
+	memcpy(skills, required_workers->skills, sizeof(skills));
+	while ((res = fscanf(file, " %32[^;,] %*1[;,] %32[^;,] %*1[;,] %32[^;,] %*1[;,] %u%*[^\n]", day_text, shift_text, skill_text, &minimum)) != EOF) {
+		enum Day day;
+		enum Shift shift;
+		enum Skill skill;
+		unsigned int first_day;
+		unsigned int last_day;
+		line++;
+		if (res != 4) {
+			sprintf(reason, "Fejl i kvalifikationskravene på linje %u", line);
+			return context_error(context, VAGTPLAN_ERROR_FORMAT, reason);
+		}
+		day_text[32] = 0;
+		shift_text[32] = 0;
+		skill_text[32] = 0;
+		day = string_to_day(day_text);
+		shift = string_to_shift(shift_text);
+		skill = string_to_skill(skill_text);
+		if ((day == DAY_INVALID && strcmp(day_text, "alle") != 0) || shift == SHIFT_INVALID || skill == SKILL_INVALID) {
+			sprintf(reason, "Fejl i kvalifikationskravene på linje %u, ukendt dag, vagt eller kvalifikation", line);
+			return context_error(context, VAGTPLAN_ERROR_FORMAT, reason);
+		}
+		first_day = day == DAY_INVALID ? 0 : day;
+		last_day = day == DAY_INVALID ? 6 : day;
+		for (; first_day <= last_day; first_day++) {
+			unsigned int block = first_day * 3 + shift;
+			if (minimum > required_for_block(required_workers, block) || minimum > 255) {
+				sprintf(reason, "Fejl i kvalifikationskravene på linje %u, der er kun %u på %s %s", line, required_for_block(required_workers, block), get_day_as_string(first_day), get_shift_as_string(shift));
+				return context_error(context, VAGTPLAN_ERROR_FORMAT, reason);
+			}
+			skills[block][skill] = (unsigned char) minimum;
+		}
+	}
+	memcpy(required_workers->skills, skills, sizeof(skills));
+	return VAGTPLAN_OK;
+}
+
+enum VagtplanStatus vagtplan_read_schedule(VagtplanContext* context, FILE* file, VagtplanSchedule** out) {
+	unsigned long mark = context_begin(context);
+	VagtplanSchedule* schedule;
+	Worker** workers;
+
+	if (setjmp(context->error_jump) != 0) {
+		return context_rollback(context, mark);
+	}
+	context_require_workers(context);
+	workers = context_worker_array(context);
+	schedule = context_allocate(context, sizeof(VagtplanSchedule));
+	schedule->schedule = read_schedule(context, file, &schedule->required_workers, workers, context->worker_count, &context->directory);
+	context_free(context, workers);
+	*out = schedule;
+	return VAGTPLAN_OK;
+}
+
+enum VagtplanStatus vagtplan_read_seed(VagtplanContext* context, FILE* file, RequiredWorkers required_workers, VagtplanSchedule** out) {
+	unsigned long mark = context_begin(context);
+	VagtplanSchedule* schedule;
+	Worker** workers;
+
+	if (setjmp(context->error_jump) != 0) {
+		return context_rollback(context, mark);
+	}
+	context_require_workers(context);
+	workers = context_worker_array(context);
+	schedule = context_allocate(context, sizeof(VagtplanSchedule));
+	schedule->required_workers = required_workers;
+	load_seed_schedule(context, file, workers, context->worker_count, required_workers, &context->directory, &schedule->schedule);
+	context_free(context, workers);
+	*out = schedule;
+	return VAGTPLAN_OK;
+}
+
+enum VagtplanStatus vagtplan_write_schedule(VagtplanContext* context, FILE* file, const VagtplanSchedule* schedule) {
+	context_begin(context);
+	write_schedule(file, &schedule->schedule, schedule->required_workers, &context->directory);
+	if (ferror(file)) {
+		return context_error(context, VAGTPLAN_ERROR_SYSTEM, "Kunne ikke skrive vagtplanen");
+	}
+	return VAGTPLAN_OK;
+}
+
+enum VagtplanStatus vagtplan_evaluate_schedule(VagtplanContext* context, VagtplanSchedule* schedule, double* score) {
+	unsigned long mark = context_begin(context);
+	Worker** workers;
+
+	if (setjmp(context->error_jump) != 0) {
+		return context_rollback(context, mark);
+	}
+	context_require_workers(context);
+	workers = context_worker_array(context);
+	*score = evaluate_schedule(&schedule->schedule, schedule->required_workers, workers, context->worker_count, context->static_scores);
+	context_free(context, workers);
+	return VAGTPLAN_OK;
+}
+
+enum VagtplanStatus vagtplan_make_schedule(VagtplanContext* context, RequiredWorkers required_workers, const SolverOptions* options, VagtplanSchedule* const* seeds, unsigned int seed_count, VagtplanSchedule** out) {
+	SolverOptions single = *options;
+	unsigned int count;
+	single.alternatives = 1;
+	return vagtplan_make_schedules(context, required_workers, &single, seeds, seed_count, out, &count);
+}
+
+enum VagtplanStatus vagtplan_make_schedules(VagtplanContext* context, RequiredWorkers required_workers, const SolverOptions* options, VagtplanSchedule* const* seeds, unsigned int seed_count, VagtplanSchedule** out, unsigned int* count) {
+	unsigned long mark = context_begin(context);
+	VagtplanSchedule* result;
+	Schedule* seed_schedules = NULL;
+	ScheduleArchive archive;
+	Schedule best;
+	Worker** workers;
+	unsigned int i;
+
+	if (setjmp(context->error_jump) != 0) {
+		return context_rollback(context, mark);
+	}
+	context_require_workers(context);
+	for (i = 0; i < 21; i++) {
+		unsigned int skill;
+		char reason[160];
+		if (required_for_block(&required_workers, i) == 0) {
+			context_fail(context, VAGTPLAN_ERROR_ARGUMENT, "Der skal være mindst en medarbejder på hver blok");
+		}
+		if (required_for_block(&required_workers, i) > pool_size(&context->pools, i * POOL_KINDS)) {
+			sprintf(reason, "Der skal være %u på %s %s, men kun %u medarbejdere kan tage blokken", required_for_block(&required_workers, i), get_day_as_string(i / 3), get_shift_as_string(i % 3), pool_size(&context->pools, i * POOL_KINDS));
+			context_fail(context, VAGTPLAN_ERROR_INFEASIBLE, reason);
+		}
+		for (skill = 0; skill < VAGTPLAN_SKILL_COUNT; skill++) {
+			unsigned int available = pool_size(&context->pools, i * POOL_KINDS + 1 + skill);
+			if (required_workers.skills[i][skill] > required_for_block(&required_workers, i)) {
+				context_fail(context, VAGTPLAN_ERROR_ARGUMENT, "Der kræves flere med en kvalifikation end der er på blokken");
+			}
+			if (required_workers.skills[i][skill] > available) {
+				sprintf(reason, "Der skal være %u med kvalifikationen %s på %s %s, men der er kun %u", required_workers.skills[i][skill], get_skill_as_string(skill), get_day_as_string(i / 3), get_shift_as_string(i % 3), available);
+				context_fail(context, VAGTPLAN_ERROR_INFEASIBLE, reason);
+			}
+		}
+	}
+	if (options->generations < 1 || options->tournament_size < 1 || options->islands < 1 || options->islands > MAX_ISLANDS || options->alternatives < 1) {
+		context_fail(context, VAGTPLAN_ERROR_ARGUMENT, "Ugyldige indstillinger til motoren");
+	}
+	/*Den generationsbaserede motor tager partnerne mellem eliten og børnene, så der skal være mindst en*/
+	if (options->population_size < 2 || options->population_size > MAX_POPULATION_SIZE
+		|| options->elite_size < 1 || options->children_per_elite < 1
+		|| (double) options->elite_size * (options->children_per_elite + 1.0) >= options->population_size) {
+		context_fail(context, VAGTPLAN_ERROR_ARGUMENT, "Populationen skal være større end eliten og deres børn tilsammen");
+	}
+	if (!(options->greedy_fraction >= 0 && options->greedy_fraction <= 1)) {
+		context_fail(context, VAGTPLAN_ERROR_ARGUMENT, "Andelen af grådige startvagtplaner skal være mellem 0 og 1");
+	}
+	if (options->threads < 1 || options->threads > MAX_THREADS) {
+		context_fail(context, VAGTPLAN_ERROR_ARGUMENT, "Ugyldigt antal tråde");
+	}
+	if (options->threads > 1 && options->engine != ENGINE_GENERATIONAL) {
+		context_fail(context, VAGTPLAN_ERROR_ARGUMENT, "Kun den generationsbaserede motor kan bruge flere tråde");
+	}
+	if (options->islands > 1 && options->engine == ENGINE_EXACT) {
+		context_fail(context, VAGTPLAN_ERROR_ARGUMENT, "Den eksakte søgning kan ikke deles op i øer");
+	}
+	if (options->progress != NULL && (options->progress->worker_count != context->worker_count
+		|| memcmp(options->progress->required_workers.offsets, required_workers.offsets, sizeof(required_workers.offsets)) != 0)) {
+		context_fail(context, VAGTPLAN_ERROR_ARGUMENT, "Fremskridtet er lavet til en anden bemanding eller medarbejderliste");
+	}
+
+	/*Motorerne bytter rundt på medarbejder arrayen, så hvert kald får sin egen*/
+	workers = context_worker_array(context);
+	if (seed_count > 0) {
+		seed_schedules = context_allocate(context, seed_count * sizeof(Schedule));
+		for (i = 0; i < seed_count; i++) {
+			if (memcmp(seeds[i]->required_workers.offsets, required_workers.offsets, sizeof(required_workers.offsets)) != 0) {
+				context_fail(context, VAGTPLAN_ERROR_ARGUMENT, "En startvagtplan har et andet antal medarbejdere på blokkene");
+			}
+			seed_schedules[i] = seeds[i]->schedule;
+		}
+	}
+
+	if (options->alternatives == 1) {
+		result = context_allocate(context, sizeof(VagtplanSchedule));
+		result->required_workers = required_workers;
+		result->schedule = make_schedule(context, workers, context->worker_count, required_workers, seed_schedules, seed_count, options, NULL);
+		out[0] = result;
+		*count = 1;
+	} else {
+		archive_init(&archive, context, required_workers, options->alternatives, options->min_distance);
+		best = make_schedule(context, workers, context->worker_count, required_workers, seed_schedules, seed_count, options, &archive);
+		free_schedule(context, &best);
+		archive_finish(&archive, workers, context->worker_count);
+		for (i = 0; i < archive.count; i++) {
+			result = context_allocate(context, sizeof(VagtplanSchedule));
+			result->required_workers = required_workers;
+			result->schedule = archive.schedules[i];
+			out[i] = result;
+		}
+		*count = archive.count;
+		context_free(context, archive.schedules);
+	}
+	context_free(context, seed_schedules);
+	context_free(context, workers);
+	return VAGTPLAN_OK;
+}
+
+enum VagtplanStatus vagtplan_make_department_schedule(VagtplanContext* context, const RequiredWorkers* required_workers, const SolverOptions* options, VagtplanSchedule** out) {
+	unsigned long mark = context_begin(context);
+	unsigned int department_count = context->directory.department_count;
+	unsigned int failed = department_count;
+	enum VagtplanStatus failed_status = VAGTPLAN_OK;
+	char reason[sizeof(context->error_message)];
+	VagtplanSchedule* result;
+	DepartmentResult* results;
+	RequiredWorkers combined;
+	unsigned short* slots;
+	unsigned int* starts;
+	unsigned int* sizes;
+	Worker** workers;
+	DepartmentJob job;
+	unsigned int department;
+	unsigned int block;
+	unsigned int i;
+#ifdef THREADS_SUPPORTED
+	TaskPool* pool;
+	TaskGroup group;
+#endif
+
+	if (setjmp(context->error_jump) != 0) {
+		return context_rollback(context, mark);
+	}
+	context_require_workers(context);
+	if (options->parallel_departments < 1 || options->parallel_departments > MAX_PARALLEL_DEPARTMENTS) {
+		context_fail(context, VAGTPLAN_ERROR_ARGUMENT, "Ugyldigt antal afdelinger der løses samtidig");
+	}
+
+	/*Afdelingernes pladser ligger efter hinanden i hver blok, og kravene til kvalifikationer bliver lagt sammen*/
+	starts = context_allocate(context, department_count * 21 * sizeof(unsigned int));
+	memset(&combined, 0, sizeof(combined));
+	for (block = 0; block < 21; block++) {
+		unsigned int start = combined.offsets[block];
+		for (department = 0; department < department_count; department++) {
+			unsigned int skill;
+			starts[department * 21 + block] = start;
+			start += required_for_block(&required_workers[department], block);
+			for (skill = 0; skill < VAGTPLAN_SKILL_COUNT; skill++) {
+				unsigned int sum = combined.skills[block][skill] + required_workers[department].skills[block][skill];
+				combined.skills[block][skill] = (unsigned char) (sum > 255 ? 255 : sum);
+			}
+		}
+		combined.offsets[block + 1] = start;
+	}
+	if (combined.offsets[21] == 0) {
+		context_fail(context, VAGTPLAN_ERROR_ARGUMENT, "Der skal være mindst en medarbejder på hver blok");
+	}
+	sizes = context_allocate_zero(context, department_count, sizeof(unsigned int));
+	for (i = 0; i < context->worker_count; i++) {
+		sizes[context->directory.departments[i]]++;
+	}
+	/*Alt hvad afdelingerne skriver i bliver allokeret før puljen starter, så konteksten ikke kan hoppe ud af
+	kaldet mens trådene stadig skriver i det*/
+	result = context_allocate(context, sizeof(VagtplanSchedule));
+	result->required_workers = combined;
+	allocate_schedule(context, &result->schedule, combined);
+	workers = context_worker_array(context);
+
+	results = context_allocate(context, department_count * sizeof(DepartmentResult));
+	slots = context_allocate(context, combined.offsets[21] * sizeof(unsigned short));
+	job.context = context;
+	job.required_workers = required_workers;
+	job.options = options;
+	job.starts = starts;
+	job.results = results;
+	job.slots = slots;
+
+	context_log(context, "Løser %u afdelinger, %u ad gangen\n", department_count, options->parallel_departments);
+#ifdef THREADS_SUPPORTED
+	/*Hver afdeling er en opgave for sig, så en tråd der bliver færdig med en lille afdeling tager den næste*/
+	pool = task_pool_create(context, options->parallel_departments < department_count ? options->parallel_departments : department_count);
+	group.pending = 0;
+	task_pool_submit(pool, 0, &group, solve_departments, &job, 0, department_count, 1);
+	task_pool_join(pool, 0, &group);
+	task_pool_destroy(context, pool);
+#else
+	solve_departments(&job, 0, 0, department_count);
+#endif
+
+	for (department = 0; department < department_count; department++) {
+		const char* name = vagtplan_department_name(context, department);
+		if (results[department].status != VAGTPLAN_OK) {
+			failed = department;
+			failed_status = results[department].status;
+			sprintf(reason, "Afdelingen %.50s: %.180s", name[0] != 0 ? name : "uden navn", results[department].message);
+			break;
+		}
+		context_log(context, "Afdelingen %s med %u medarbejdere har en score på %f\n", name[0] != 0 ? name : "uden navn", sizes[department], results[department].score);
+	}
+	if (failed == department_count) {
+		for (i = 0; i < combined.offsets[21]; i++) {
+			result->schedule.workers[i] = &context->workers[slots[i]];
+		}
+	}
+	if (failed < department_count) {
+		context_fail(context, failed_status, reason);
+	}
+	evaluate_schedule(&result->schedule, combined, workers, context->worker_count, context->static_scores);
+	context_log(context, "Vagtplanen for alle afdelingerne har en score på %f\n", result->schedule.score);
+
+	context_free(context, slots);
+	context_free(context, results);
+	context_free(context, workers);
+	context_free(context, sizes);
+	context_free(context, starts);
+	*out = result;
+	return VAGTPLAN_OK;
+}
+
+void solve_departments(void* argument, unsigned int thread, unsigned long begin, unsigned long end) {
+	DepartmentJob* job = argument;
+	unsigned long department;
+	for (department = begin; department < end; department++) {
+		solve_department(job->context, (unsigned int) department, &job->required_workers[department], job->options, job->starts, &job->results[department], job->slots);
+	}
+}
+
+void solve_department(const VagtplanContext* context, unsigned int department, const RequiredWorkers* required_workers, const SolverOptions* options, const unsigned int* starts, DepartmentResult* result, unsigned short* slots) {
+	VagtplanContext* department_context = vagtplan_create(&context->allocator, context->random_state ^ ((department + 1) * 0x9E3779B9UL));
+	SolverOptions department_options = *options;
+	VagtplanSchedule* schedule;
+	unsigned short* global_ids;
+	unsigned int block;
+	unsigned int slot;
+
+	if (department_context == NULL) {
+		result->status = VAGTPLAN_ERROR_MEMORY;
+		strcpy(result->message, "ikke nok hukkomelse");
+		return;
+	}
+	department_options.alternatives = 1;
+	department_options.progress = NULL;
+	/*Afdelingerne kører i tråde, og fork fra en proces med flere tråde passer ikke sammen med allokatoren og loggen*/
+	department_options.islands = 1;
+	result->status = copy_department_workers(department_context, context, department, &global_ids);
+	if (result->status == VAGTPLAN_OK) {
+		result->status = vagtplan_make_schedule(department_context, *required_workers, &department_options, NULL, 0, &schedule);
+	}
+	if (result->status != VAGTPLAN_OK) {
+		strcpy(result->message, vagtplan_error_message(department_context));
+	} else {
+		for (block = 0; block < 21; block++) {
+			for (slot = 0; slot < required_for_block(required_workers, block); slot++) {
+				slots[starts[department * 21 + block] + slot] = global_ids[vagtplan_schedule_worker(schedule, block, slot)];
+			}
+		}
+		result->score = vagtplan_schedule_score(schedule);
+	}
+	vagtplan_destroy(department_context);
+}
+
+enum VagtplanStatus vagtplan_replan_schedule(VagtplanContext* context, const VagtplanSchedule* published, unsigned int worker, unsigned long blocks, int max_changes, VagtplanSchedule** out, unsigned int* changes) {
+	unsigned long mark = context_begin(context);
+	VagtplanSchedule* result;
+
+	if (setjmp(context->error_jump) != 0) {
+		return context_rollback(context, mark);
+	}
+	context_require_workers(context);
+	if (worker >= context->worker_count) {
+		context_fail(context, VAGTPLAN_ERROR_UNKNOWN_WORKER, "Der er ingen medarbejder med det nummer");
+	}
+	if (blocks == 0 || blocks >= (1UL << 21)) {
+		context_fail(context, VAGTPLAN_ERROR_ARGUMENT, "Forkert liste af blokke");
+	}
+	result = context_allocate(context, sizeof(VagtplanSchedule));
+	result->required_workers = published->required_workers;
+	result->schedule = replan_schedule(context, &published->schedule, published->required_workers, worker, blocks, max_changes, changes);
+	*out = result;
+	return VAGTPLAN_OK;
+}
+
+enum VagtplanStatus vagtplan_check_evaluators(VagtplanContext* context, RequiredWorkers required_workers, unsigned long schedule_count, VagtplanEvaluatorCheck* results) {
+	unsigned long mark = context_begin(context);
+	unsigned int block;
+
+	if (setjmp(context->error_jump) != 0) {
+		return context_rollback(context, mark);
+	}
+	context_require_workers(context);
+	for (block = 0; block < 21; block++) {
+		if (required_for_block(&required_workers, block) == 0) {
+			context_fail(context, VAGTPLAN_ERROR_ARGUMENT, "Der skal være mindst en medarbejder på hver blok");
+		}
+		if (required_for_block(&required_workers, block) > context->worker_count) {
+			context_fail(context, VAGTPLAN_ERROR_INFEASIBLE, "Ikke nok medarbejdere til at lave en valid plan for en dag");
+		}
+	}
+	compare_evaluators(context, required_workers, schedule_count, results);
+	return VAGTPLAN_OK;
+}
+
+void vagtplan_free_schedule(VagtplanContext* context, VagtplanSchedule* schedule) {
+	if (schedule == NULL) {
+		return;
+	}
+	free_schedule(context, &schedule->schedule);
+	context_free(context, schedule);
+}
+
+enum VagtplanStatus vagtplan_create_progress(VagtplanContext* context, RequiredWorkers required_workers, VagtplanProgress** out) {
+	unsigned long mark = context_begin(context);
+	VagtplanProgress* progress;
+
+	if (setjmp(context->error_jump) != 0) {
+		return context_rollback(context, mark);
+	}
+	context_require_workers(context);
+	progress = context_allocate(context, sizeof(VagtplanProgress));
+	progress->stop_requested = 0;
+	progress->sequence = 0;
+	progress->required_workers = required_workers;
+	progress->worker_count = context->worker_count;
+	progress->steps = 0;
+	progress->score = 0;
+	progress->workers = context_allocate(context, required_workers.offsets[21] * sizeof(unsigned short));
+	*out = progress;
+	return VAGTPLAN_OK;
+}
+
+void vagtplan_free_progress(VagtplanContext* context, VagtplanProgress* progress) {
+	if (progress == NULL) {
+		return;
+	}
+	context_free(context, progress->workers);
+	context_free(context, progress);
+}
+
+void vagtplan_request_stop(VagtplanProgress* progress) {
+	progress->stop_requested = 1;
+}
+
+enum VagtplanStatus vagtplan_progress_best(VagtplanContext* context, const VagtplanProgress* progress, VagtplanSchedule** out, unsigned int* steps) {
+	unsigned long mark = context_begin(context);
+	VagtplanSchedule* result;
+	unsigned short* workers;
+	unsigned int total_slots = progress->required_workers.offsets[21];
+	unsigned int before;
+	unsigned int i;
+
+	if (setjmp(context->error_jump) != 0) {
+		return context_rollback(context, mark);
+	}
+	context_require_workers(context);
+	if (context->worker_count != progress->worker_count) {
+		context_fail(context, VAGTPLAN_ERROR_ARGUMENT, "Konteksten har ikke de samme medarbejdere som motoren");
+	}
+	result = context_allocate(context, sizeof(VagtplanSchedule));
+	result->required_workers = progress->required_workers;
+	allocate_schedule(context, &result->schedule, progress->required_workers);
+	workers = context_allocate(context, total_slots * sizeof(unsigned short));
+	/*Kopien er kun gyldig hvis sekvensen var lige og ikke har ændret sig undervejs*/
+	do {
+		before = progress->sequence;
+		if (before == 0) {
+			context_fail(context, VAGTPLAN_ERROR_ARGUMENT, "Motoren har ikke udgivet nogen vagtplan endnu");
+		}
+		memory_barrier();
+		memcpy(workers, progress->workers, total_slots * sizeof(unsigned short));
+		result->schedule.score = progress->score;
+		*steps = progress->steps;
+		memory_barrier();
+	} while ((before & 1) != 0 || progress->sequence != before);
+	for (i = 0; i < total_slots; i++) {
+		result->schedule.workers[i] = &context->workers[workers[i]];
+	}
+	context_free(context, workers);
+	*out = result;
+	return VAGTPLAN_OK;
+}
+
+void progress_publish(VagtplanProgress* progress, const Schedule* schedule, unsigned int steps) {
+	unsigned int position;
+	progress->sequence++;
+	memory_barrier();
+	for (position = 0; position < progress->required_workers.offsets[21]; position++) {
+		progress->workers[position] = schedule->workers[position]->id;
+	}
+	progress->score = schedule->score;
+	progress->steps = steps;
+	memory_barrier();
+	progress->sequence++;
+}
+
+void memory_barrier(void) {
+#ifdef __GNUC__
+	__sync_synchronize();
+#endif
+}
+
+unsigned int vagtplan_block_size(const VagtplanSchedule* schedule, unsigned int block) {
+	return required_for_block(&schedule->required_workers, block);
+}
+
+RequiredWorkers* vagtplan_schedule_requirements(VagtplanSchedule* schedule) {
+	return &schedule->required_workers;
+}
+
+double vagtplan_schedule_score(const VagtplanSchedule* schedule) {
+	return schedule->schedule.score;
+}
+
+unsigned int vagtplan_schedule_worker(const VagtplanSchedule* schedule, unsigned int block, unsigned int slot) {
+	return schedule->schedule.workers[schedule->required_workers.offsets[block] + slot]->id;
+}
+
+const char* vagtplan_day_name(enum Day day) {
+	return day <= DAY_INVALID ? get_day_as_string(day) : get_day_as_string(DAY_INVALID);
+}
+
+const char* vagtplan_shift_name(enum Shift shift) {
+	return shift <= SHIFT_INVALID ? get_shift_as_string(shift) : get_shift_as_string(SHIFT_INVALID);
+}
+
+const char* vagtplan_skill_name(enum Skill skill) {
+	return skill <= SKILL_INVALID ? get_skill_as_string(skill) : get_skill_as_string(SKILL_INVALID);
+}
+
+unsigned long context_begin(VagtplanContext* context) {
+	context->status = VAGTPLAN_OK;
+	context->error_message[0] = 0;
+	return context->allocation_serial;
+}
+
+enum VagtplanStatus context_rollback(VagtplanContext* context, unsigned long mark) {
+	/*Listen er sorteret med de nyeste først, så alt fra det fejlede kald ligger forrest*/
+	while (context->allocations != NULL && context->allocations->links.serial > mark) {
+		Allocation* next = context->allocations->links.next;
+		context->allocator.release(context->allocator.user, context->allocations);
+		context->allocations = next;
+	}
+	if (context->allocations != NULL) {
+		context->allocations->links.previous = NULL;
+	}
+	return context->status;
+}
+
+enum VagtplanStatus context_error(VagtplanContext* context, enum VagtplanStatus status, const char* reason) {
+	context->status = status;
+	strncpy(context->error_message, reason, sizeof(context->error_message) - 1);
+	context->error_message[sizeof(context->error_message) - 1] = 0;
+	return status;
+}
+
+void context_fail(VagtplanContext* context, enum VagtplanStatus status, const char* reason) {
+	context_error(context, status, reason);
+	longjmp(context->error_jump, 1);
+}
+
+void* context_allocate(VagtplanContext* context, size_t size) {
+	Allocation* allocation = context->allocator.allocate(context->allocator.user, sizeof(Allocation) + size);
+	if (allocation == NULL) {
+		context_fail(context, VAGTPLAN_ERROR_MEMORY, "ikke nok hukkomelse");
+	}
+	context->allocation_serial++;
+	allocation->links.serial = context->allocation_serial;
+	allocation->links.previous = NULL;
+	allocation->links.next = context->allocations;
+	if (context->allocations != NULL) {
+		context->allocations->links.previous = allocation;
+	}
+	context->allocations = allocation;
+	return allocation + 1;
+}
+
+void* context_allocate_zero(VagtplanContext* context, size_t count, size_t size) {
+	void* memory = context_allocate(context, count * size);
+	memset(memory, 0, count * size);
+	return memory;
+}
+
+void* context_reallocate(VagtplanContext* context, void* memory, size_t size) {
+	Allocation* allocation;
+	if (memory == NULL) {
+		return context_allocate(context, size);
+	}
+	/*Hvis det fejler er den gamle hukommelse stadig i listen*/
+	allocation = context->allocator.reallocate(context->allocator.user, (Allocation*) memory - 1, sizeof(Allocation) + size);
+	if (allocation == NULL) {
+		context_fail(context, VAGTPLAN_ERROR_MEMORY, "ikke nok hukkomelse");
+	}
+	if (allocation->links.previous != NULL) {
+		allocation->links.previous->links.next = allocation;
+	} else {
+		context->allocations = allocation;
+	}
+	if (allocation->links.next != NULL) {
+		allocation->links.next->links.previous = allocation;
+	}
+	return allocation + 1;
+}
+
+void context_free(VagtplanContext* context, void* memory) {
+	Allocation* allocation;
+	if (memory == NULL) {
+		return;
+	}
+	allocation = (Allocation*) memory - 1;
+	if (allocation->links.previous != NULL) {
+		allocation->links.previous->links.next = allocation->links.next;
+	} else {
+		context->allocations = allocation->links.next;
+	}
+	if (allocation->links.next != NULL) {
+		allocation->links.next->links.previous = allocation->links.previous;
+	}
+	context->allocator.release(context->allocator.user, allocation);
+}
+
+void context_log(VagtplanContext* context, const char* format, ...) {
+	va_list arguments;
+	if (context->log == NULL) {
+		return;
+	}
+	va_start(arguments, format);
+	vfprintf(context->log, format, arguments);
+	va_end(arguments);
+}
+
+void context_require_workers(VagtplanContext* context) {
+	if (context->workers == NULL) {
+		context_fail(context, VAGTPLAN_ERROR_ARGUMENT, "Der er ikke læst nogen medarbejderliste");
+	}
+}
+
+Worker** context_worker_array(VagtplanContext* context) {
+	Worker** workers = context_allocate(context, context->worker_count * sizeof(Worker*));
+	unsigned int i;
+	for (i = 0; i < context->worker_count; i++) {
+		workers[i] = &context->workers[i];
+	}
+	return workers;
+}
+
+void build_candidate_pools(VagtplanContext* context) {
+	CandidatePools* pools = &context->pools;
+	unsigned int worker_count = context->worker_count;
+	unsigned int offsets[21 * POOL_KINDS + 1];
+	unsigned short* members;
+	unsigned long* stamps;
+	double* static_scores;
+	unsigned int pool;
+	unsigned int i;
+
+	offsets[0] = 0;
+	for (pool = 0; pool < 21 * POOL_KINDS; pool++) {
+		unsigned int count = 0;
+		for (i = 0; i < worker_count; i++) {
+			if (pool_accepts(&context->workers[i], pool)) {
+				count++;
+			}
+		}
+		offsets[pool + 1] = offsets[pool] + count;
+	}
+	members = context_allocate(context, (offsets[21 * POOL_KINDS] + 1) * sizeof(unsigned short));
+	stamps = context_allocate_zero(context, worker_count + 1, sizeof(unsigned long));
+	static_scores = context_allocate(context, (worker_count * 21 + 1) * sizeof(double));
+	for (pool = 0; pool < 21 * POOL_KINDS; pool++) {
+		unsigned int position = offsets[pool];
+		for (i = 0; i < worker_count; i++) {
+			if (pool_accepts(&context->workers[i], pool)) {
+				members[position++] = (unsigned short) i;
+			}
+		}
+	}
+
+	for (i = 0; i < worker_count; i++) {
+		unsigned int block;
+		for (block = 0; block < 21; block++) {
+			static_scores[i * 21 + block] = static_score(&context->workers[i], block);
+		}
+	}
+
+	context_free(context, pools->workers);
+	context_free(context, pools->stamps);
+	context_free(context, context->static_scores);
+	memcpy(pools->offsets, offsets, sizeof(offsets));
+	pools->workers = members;
+	pools->stamps = stamps;
+	pools->stamp = 0;
+	context->static_scores = static_scores;
+}
+
+bool pool_accepts(const Worker* worker, unsigned int pool) {
+	unsigned int kind = pool % POOL_KINDS;
+	if (worker->forbidden_blocks & (1UL << (pool / POOL_KINDS))) {
+		return false;
+	}
+	return kind == 0 || (worker->skills >> (kind - 1)) & 1;
+}
+
+unsigned int pool_size(const CandidatePools* pools, unsigned int pool) {
+	return pools->offsets[pool + 1] - pools->offsets[pool];
+}
+
+Worker* pool_draw(VagtplanContext* context, unsigned int pool) {
+	CandidatePools* pools = &context->pools;
+	unsigned short* members = pools->workers + pools->offsets[pool];
+	unsigned int top = pool_size(pools, pool);
+
+	/*Dem der er trukket bliver byttet om bagerst, så ingen bliver prøvet to gange i samme træk*/
+	while (top > 0) {
+		unsigned int index = random_number(context, 0, top);
+		unsigned short id = members[index];
+		members[index] = members[top - 1];
+		members[top - 1] = id;
+		top--;
+		if (pools->stamps[id] != pools->stamp) {
+			pools->stamps[id] = pools->stamp;
+			return &context->workers[id];
+		}
+	}
+	return NULL;
+}
+
+Worker* pool_draw_greedy(VagtplanContext* context, unsigned int pool, unsigned int block) {
+	CandidatePools* pools = &context->pools;
+	unsigned short* members = pools->workers + pools->offsets[pool];
+	unsigned int top = pool_size(pools, pool);
+	Worker* best = NULL;
+	double best_quality = -HUGE_VAL;
+
+	/*Puljen bliver gennemgået i tilfældig rækkefølge, så den første af de lige gode er tilfældig*/
+	while (top > 0) {
+		unsigned int index = random_number(context, 0, top);
+		unsigned short id = members[index];
+		double quality;
+		members[index] = members[top - 1];
+		members[top - 1] = id;
+		top--;
+		if (pools->stamps[id] == pools->stamp) {
+			continue;
+		}
+		quality = context->static_scores[id * 21 + block] - 1000.0 * transition_broken_rules(&context->workers[id], block);
+		if (quality > best_quality) {
+			best = &context->workers[id];
+			best_quality = quality;
+		}
+	}
+	if (best != NULL) {
+		pools->stamps[best->id] = pools->stamp;
+	}
+	return best;
+}
+
+void fill_block(VagtplanContext* context, const RequiredWorkers* required_workers, unsigned int block, Worker** block_workers, bool greedy) {
+	unsigned int needed = required_for_block(required_workers, block);
+	unsigned int filled = 0;
+	unsigned int skill;
+
+	for (skill = 0; skill < VAGTPLAN_SKILL_COUNT; skill++) {
+		unsigned int covered = 0;
+		unsigned int i;
+		/*En medarbejder der er trukket for en anden kvalifikation kan også dække denne*/
+		for (i = 0; i < filled; i++) {
+			covered += (block_workers[i]->skills >> skill) & 1;
+		}
+		while (covered < required_workers->skills[block][skill] && filled < needed) {
+			unsigned int pool = block * POOL_KINDS + 1 + skill;
+			Worker* worker = greedy ? pool_draw_greedy(context, pool, block) : pool_draw(context, pool);
+			if (worker == NULL) {
+				break;
+			}
+			block_workers[filled] = worker;
+			filled++;
+			covered++;
+		}
+	}
+	while (filled < needed) {
+		Worker* worker = greedy ? pool_draw_greedy(context, block * POOL_KINDS, block) : pool_draw(context, block * POOL_KINDS);
+		if (worker == NULL) {
+			context_fail(context, VAGTPLAN_ERROR_INFEASIBLE, "Ikke nok medarbejdere til at lave en valid plan for en dag");
+		}
+		block_workers[filled] = worker;
+		filled++;
+	}
+}
+
+double score_skill_shortage(const unsigned char* minimum, const unsigned int* counts) {
+	double score = 0;
+	unsigned int skill;
+	for (skill = 0; skill < VAGTPLAN_SKILL_COUNT; skill++) {
+		if (counts[skill] < minimum[skill]) {
+			score -= 1000 * (double) (minimum[skill] - counts[skill]);
+		}
+	}
+	return score;
+}
+
+double score_skill_coverage(const Schedule* schedule, const RequiredWorkers* required_workers) {
+	double score = 0;
+	unsigned int block;
+	for (block = 0; block < 21; block++) {
+		unsigned int counts[VAGTPLAN_SKILL_COUNT];
+		unsigned int skill;
+		unsigned int i;
+		bool required = false;
+		for (skill = 0; skill < VAGTPLAN_SKILL_COUNT; skill++) {
+			counts[skill] = 0;
+			required = required || required_workers->skills[block][skill] > 0;
+		}
+		/*De fleste blokke har ingen krav, og så skal pladserne ikke læses*/
+		if (!required) {
+			continue;
+		}
+		for (i = required_workers->offsets[block]; i < required_workers->offsets[block + 1]; i++) {
+			unsigned char skills = schedule->workers[i]->skills;
+			for (skill = 0; skill < VAGTPLAN_SKILL_COUNT; skill++) {
+				counts[skill] += (skills >> skill) & 1;
+			}
+		}
+		score += score_skill_shortage(required_workers->skills[block], counts);
+	}
+	return score;
+}
+
+void program_error(const char* reason) {
+	fprintf(stderr, "Program fejl, biblioteket kan ikke fortsætte: %s\n", reason);
+	abort();
+}
+
+void* default_allocate(void* user, size_t size) {
+	return malloc(size);
+}
+
+void* default_reallocate(void* user, void* memory, size_t size) {
+	return realloc(memory, size);
+}
+
+void default_release(void* user, void* memory) {
+	free(memory);
+}
+
+unsigned long random_next(VagtplanContext* context) {
+	/*Holdt inden for 32 bit, så det giver de samme tal hvor unsigned long er 64 bit*/
+	unsigned long x = context->random_state;
+	x ^= (x << 13) & 0xFFFFFFFFUL;
+	x ^= x >> 17;
+	x ^= (x << 5) & 0xFFFFFFFFUL;
+	context->random_state = x;
+	return x;
+}
+
+double random_unit(VagtplanContext* context) {
+	return (double) random_next(context) / 4294967296.0;
+}
+
+Schedule replan_schedule(VagtplanContext* context, const Schedule* published, RequiredWorkers required_workers, unsigned int sick_worker, unsigned long forbidden_blocks, int max_changes, unsigned int* best_changes) {
+	unsigned int worker_count = context->worker_count;
+	LocalSearchState state;
+	unsigned long nearby_blocks = 0;
+	unsigned long* published_occupancy;
+	unsigned int vacated_block[REPLAN_MAX_VACATED];
+	unsigned int vacated_slot[REPLAN_MAX_VACATED];
+	unsigned int vacated_count = 0;
+	unsigned int changes = 0;
+	double best_objective;
+	double start = wall_seconds();
+	unsigned int iteration;
+	unsigned int block;
+	unsigned int i;
+
+	state.problem.context = context;
+	state.problem.workers = context_worker_array(context);
+	state.occupancy = context_allocate_zero(context, worker_count, sizeof(unsigned long));
+	state.coverage = context_allocate(context, 21 * VAGTPLAN_SKILL_COUNT * sizeof(unsigned int));
+	state.worker_scores = context_allocate(context, worker_count * sizeof(double));
+	state.tabu_until = context_allocate_zero(context, worker_count * 21, sizeof(unsigned int));
+	published_occupancy = context_allocate_zero(context, worker_count, sizeof(unsigned long));
+
+	state.problem.worker_count = worker_count;
+	state.problem.required_workers = required_workers;
+	state.problem.archive = NULL;
+	state.step = 0;
+	allocate_schedule(context, &state.current, required_workers);
+	allocate_schedule(context, &state.best, required_workers);
+	copy_schedule(published, &state.current, required_workers);
+	state.assignment = context_allocate(context, required_workers.offsets[21] * sizeof(unsigned int));
+	/*Hvis den samme medarbejder står to gange på en blok, så skal den ene plads også fyldes igen*/
+	for (block = 0; block < 21; block++) {
+		unsigned int needed = required_for_block(&required_workers, block);
+		for (i = 0; i < needed; i++) {
+			Worker** block_workers = state.current.workers + required_workers.offsets[block];
+			unsigned int j = 0;
+			published_occupancy[find_worker_index(state.problem.workers, worker_count, block_workers[i])] |= 1UL << block;
+			if (!block_contains(block_workers, i, block_workers[i])) {
+				continue;
+			}
+			while (block_contains(block_workers, needed, state.problem.workers[j]) || (state.problem.workers[j]->forbidden_blocks & (1UL << block))) {
+				j++;
+				if (j >= worker_count) {
+					context_fail(context, VAGTPLAN_ERROR_INFEASIBLE, "Ikke nok medarbejdere til at lave en valid plan for en dag");
+				}
+			}
+			block_workers[i] = state.problem.workers[j];
+			changes++;
+			replan_add_vacated(context, vacated_block, vacated_slot, &vacated_count, block, i);
+		}
+	}
+	local_search_index(&state);
+
+	for (block = 0; block < 21; block++) {
+		for (i = 0; i < required_for_block(&required_workers, block); i++) {
+			unsigned int assigned = state.assignment[required_workers.offsets[block] + i];
+			/*Pladser hvor fraværet siger at medarbejderen ikke kan være, bliver også fyldt igen*/
+			if ((assigned == sick_worker && (forbidden_blocks & (1UL << block)))
+				|| (state.problem.workers[assigned]->forbidden_blocks & (1UL << block))) {
+				replan_add_vacated(context, vacated_block, vacated_slot, &vacated_count, block, i);
+			}
+		}
+	}
+
+	if (max_changes < 0) {
+		max_changes = vacated_count + REPLAN_DEFAULT_EXTRA_CHANGES;
+	}
+	if (vacated_count > (unsigned int) max_changes) {
+		char reason[128];
+		sprintf(reason, "Der må ikke laves nok ændringer til at dække blokkene, der skal mindst laves %u", vacated_count);
+		context_fail(context, VAGTPLAN_ERROR_INFEASIBLE, reason);
+	}
+
+	/*Først bliver hver ledig plads fyldt med den medarbejder der giver den bedste score*/
+	for (i = 0; i < vacated_count; i++) {
+		LocalSearchMove best_move;
+		bool found = false;
+		unsigned int vacated = state.assignment[required_workers.offsets[vacated_block[i]] + vacated_slot[i]];
+		bool mandatory = vacated == sick_worker || (state.problem.workers[vacated]->forbidden_blocks & (1UL << vacated_block[i]));
+		unsigned int candidate;
+		for (candidate = 0; candidate < worker_count; candidate++) {
+			LocalSearchMove move;
+			if (!replan_move(&state, vacated_block[i], vacated_slot[i], candidate, sick_worker, forbidden_blocks, &move)) {
+				continue;
+			}
+			if (!found || move.delta > best_move.delta) {
+				best_move = move;
+				found = true;
+			}
+		}
+		if (!found) {
+			context_fail(context, VAGTPLAN_ERROR_INFEASIBLE, "Ikke nok medarbejdere til at lave en valid plan for en dag");
+		}
+		if (mandatory || best_move.delta > 0) {
+			changes += replan_change_delta(&best_move, published_occupancy);
+			local_search_apply_move(&state, &best_move);
+		}
+		nearby_blocks |= replan_nearby_blocks(vacated_block[i]);
+	}
+
+	local_search_save_best(&state);
+	*best_changes = changes;
+	best_objective = state.current.score - REPLAN_CHANGE_PENALTY * changes;
+
+	/*Derefter en kort tabu søgning som kun rører blokkene omkring de ledige pladser, hvor hver ændring
+	i forhold til den udgivne vagtplan koster REPLAN_CHANGE_PENALTY*/
+	for (iteration = 1; iteration <= REPLAN_ITERATIONS; iteration++) {
+		LocalSearchMove best_move;
+		double best_move_objective = 0;
+		int best_move_changes = 0;
+		bool found = false;
+
+		if (wall_seconds() - start > REPLAN_TIME_LIMIT) {
+			break;
+		}
+
+		for (block = 0; block < 21; block++) {
+			unsigned int slot;
+			if (!(nearby_blocks & (1UL << block))) {
+				continue;
+			}
+			for (slot = 0; slot < required_for_block(&required_workers, block); slot++) {
+				unsigned int candidate;
+				for (candidate = 0; candidate < worker_count; candidate++) {
+					LocalSearchMove move;
+					int change_delta;
+					double objective;
+					if (!replan_move(&state, block, slot, candidate, sick_worker, forbidden_blocks, &move)) {
+						continue;
+					}
+					change_delta = replan_change_delta(&move, published_occupancy);
+					if ((int) changes + change_delta > max_changes) {
+						continue;
+					}
+					objective = move.delta - REPLAN_CHANGE_PENALTY * change_delta;
+					/*Et tabu træk er tilladt hvis det giver en ny bedste vagtplan*/
+					if (state.tabu_until[candidate * 21 + block] > iteration
+						&& state.current.score - REPLAN_CHANGE_PENALTY * changes + objective <= best_objective) {
+						continue;
+					}
+					if (!found || objective > best_move_objective) {
+						best_move = move;
+						best_move_objective = objective;
+						best_move_changes = change_delta;
+						found = true;
+					}
+				}
+			}
+		}
+		if (!found) {
+			break;
+		}
+
+		state.tabu_until[best_move.old_worker * 21 + best_move.block] = iteration + TABU_TENURE;
+		local_search_apply_move(&state, &best_move);
+		changes += best_move_changes;
+		if (state.current.score - REPLAN_CHANGE_PENALTY * changes > best_objective) {
+			best_objective = state.current.score - REPLAN_CHANGE_PENALTY * changes;
+			*best_changes = changes;
+			local_search_save_best(&state);
+		}
+	}
+
+	context_free(context, state.assignment);
+	free_schedule(context, &state.current);
+	context_free(context, state.problem.workers);
+	context_free(context, state.occupancy);
+	context_free(context, state.coverage);
+	context_free(context, state.worker_scores);
+	context_free(context, state.tabu_until);
+	context_free(context, published_occupancy);
+	return state.best;
+}
+
+bool replan_move(const LocalSearchState* state, unsigned int block, unsigned int slot, unsigned int candidate, unsigned int sick_worker, unsigned long forbidden_blocks, LocalSearchMove* move) {
+	/*Den syge medarbejder må ikke sættes på de blokke de ikke kan dække*/
+	if (candidate == sick_worker && (forbidden_blocks & (1UL << block))) {
+		return false;
+	}
+	if (state->problem.workers[candidate]->forbidden_blocks & (1UL << block)) {
+		return false;
+	}
+	if (state->occupancy[candidate] & (1UL << block)) {
+		return false;
+	}
+	move->block = block;
+	move->slot = slot;
+	move->old_worker = state->assignment[state->problem.required_workers.offsets[block] + slot];
+	move->new_worker = candidate;
+	move->old_worker_score = score_worker_blocks(state->problem.workers[move->old_worker], state->occupancy[move->old_worker] & ~(1UL << block), state->problem.context->static_scores);
+	move->new_worker_score = score_worker_blocks(state->problem.workers[candidate], state->occupancy[candidate] | (1UL << block), state->problem.context->static_scores);
+	move->delta = move->old_worker_score + move->new_worker_score
+		- state->worker_scores[move->old_worker] - state->worker_scores[candidate]
+		+ local_search_skill_delta(state, block, move->old_worker, candidate);
+	return true;
+}
+
+int replan_change_delta(const LocalSearchMove* move, const unsigned long* published_occupancy) {
+	int delta = 0;
+	if (!(published_occupancy[move->new_worker] & (1UL << move->block))) {
+		delta++;
+	}
+	if (!(published_occupancy[move->old_worker] & (1UL << move->block))) {
+		delta--;
+	}
+	return delta;
+}
+
+unsigned long replan_nearby_blocks(unsigned int block) {
+	unsigned long mask = 0;
+	int nearby;
+	for (nearby = (int) block - REPLAN_RADIUS; nearby <= (int) block + REPLAN_RADIUS; nearby++) {
+		if (nearby >= 0 && nearby < 21) {
+			mask |= 1UL << nearby;
+		}
+	}
+	return mask;
+}
+
+void replan_add_vacated(VagtplanContext* context, unsigned int* vacated_block, unsigned int* vacated_slot, unsigned int* vacated_count, unsigned int block, unsigned int slot) {
+	if (*vacated_count >= REPLAN_MAX_VACATED) {
+		context_fail(context, VAGTPLAN_ERROR_INFEASIBLE, "For mange ledige pladser");
+	}
+	vacated_block[*vacated_count] = block;
+	vacated_slot[*vacated_count] = slot;
+	*vacated_count += 1;
+}
+
+bool vagtplan_parse_block_list(const char* text, unsigned long* blocks) {
+	char buffer[256];
+	char* token;
+
+	if (strlen(text) >= sizeof(buffer)) {
+		return false;
+	}
+	strcpy(buffer, text);
+	*blocks = 0;
+
+	for (token = strtok(buffer, ","); token != NULL; token = strtok(NULL, ",")) {
+		char* separator = strchr(token, ':');
+		unsigned int first;
+		unsigned int last;
+		int used = 0;
+
+		if (separator != NULL) {
+			/*dag:vagt, f.eks. tirsdag:nat*/
+			enum Day day;
+			enum Shift shift;
+			*separator = 0;
+			day = string_to_day(token);
+			shift = string_to_shift(separator + 1);
+			if (day == DAY_INVALID || shift == SHIFT_INVALID) {
+				return false;
+			}
+			*blocks |= 1UL << (day * 3 + shift);
+		} else if (string_to_day(token) != DAY_INVALID) {
+			/*En hel dag*/
+			*blocks |= 7UL << (string_to_day(token) * 3);
+		} else if (strchr(token, '-') != NULL && string_to_day(strchr(token, '-') + 1) != DAY_INVALID) {
+			/*Et interval af hele dage, f.eks. mandag-onsdag*/
+			char* dash = strchr(token, '-');
+			*dash = 0;
+			if (string_to_day(token) == DAY_INVALID || string_to_day(token) > string_to_day(dash + 1)) {
+				return false;
+			}
+			for (first = string_to_day(token); first <= (unsigned int) string_to_day(dash + 1); first++) {
+				*blocks |= 7UL << (first * 3);
+			}
+		} else if (sscanf(token, "%u-%u%n", &first, &last, &used) == 2 && token[used] == 0) {
+			if (first > last || last > 20) {
+				return false;
+			}
+			for (; first <= last; first++) {
+				*blocks |= 1UL << first;
+			}
+		} else if (sscanf(token, "%u%n", &first, &used) == 1 && token[used] == 0 && first <= 20) {
+			*blocks |= 1UL << first;
+		} else {
+			return false;
+		}
+	}
+	return *blocks != 0;
+}
+
+Worker* read_workers(VagtplanContext* context, FILE* fil, unsigned int* worker_count, WorkerDirectory* directory) {
+	unsigned int allocated_workers = 10;
+	Worker* workers = context_allocate(context, allocated_workers * sizeof( Worker));
+	NameIndex names;
+	char reason[160];
+
+	directory->uuids = context_allocate(context, allocated_workers * sizeof(unsigned int));
+	directory->name_offsets = context_allocate(context, allocated_workers * sizeof(unsigned int));
+	directory->names_allocated = allocated_workers * 16;
+	directory->names = context_allocate(context, directory->names_allocated);
+	directory->names_length = 0;
+	directory->worker_count = 0;
+	directory->departments = context_allocate(context, allocated_workers * sizeof(unsigned short));
+	directory->department_offsets = context_allocate(context, allocated_workers * sizeof(unsigned int));
+	directory->department_count = 0;
+	name_index_init(context, &names);
+
+	*worker_count = 0;
+
+	while (!feof(fil)) {
+		int res = 0;
+		char name[MAX_NAME_LENGTH + 1];
+		char shift_text[33];
+		char day_text[33];
+		char skill_text[MAX_SKILL_TEXT + 1];
+		char department[MAX_NAME_LENGTH + 1];
+		if (*worker_count + 1 >= allocated_workers) {
+			allocated_workers += 10;
+			workers = context_reallocate(context, workers, allocated_workers * sizeof( Worker));
+			directory->uuids = context_reallocate(context, directory->uuids, allocated_workers * sizeof(unsigned int));
+			directory->name_offsets = context_reallocate(context, directory->name_offsets, allocated_workers * sizeof(unsigned int));
+			/*Der er aldrig flere afdelinger end medarbejdere*/
+			directory->departments = context_reallocate(context, directory->departments, allocated_workers * sizeof(unsigned short));
+			directory->department_offsets = context_reallocate(context, directory->department_offsets, allocated_workers * sizeof(unsigned int));
+		}
+		/*id er en unsigned short*/
+		if (*worker_count >= 65535) {
+			context_fail(context, VAGTPLAN_ERROR_FORMAT, "For mange medarbejdere i medarbejder listen");
+		}
+
+		res = fscanf(fil,
+			" %50[^;,] %*1[;,] %32[^;,] %*1[;,] %32[^;,] %*1[;,] %u", 
+			name, day_text, shift_text, &directory->uuids[*worker_count]
+		);
+
+		if (res != 4) {
+			sprintf(reason, "Fejl i medarbejder liste på linje %u og kolonne %d", *worker_count + 1, res);
+			context_fail(context, VAGTPLAN_ERROR_FORMAT, reason);
+		}
+		/*Kolonnerne efter uuid er kvalifikationerne og afdelingen, resten af en for lang linje bliver sprunget over*/
+		skill_text[0] = 0;
+		fscanf(fil, "%255[^\n]", skill_text);
+		fscanf(fil, "%*[^\n]");
+		fscanf(fil, "\n");
+		skill_text[MAX_SKILL_TEXT] = 0;
+		if (!parse_worker_columns(skill_text, &workers[*worker_count].skills, department)) {
+			sprintf(reason, "Fejl i medarbejder liste på linje %u ved kvalifikationerne eller afdelingen: %.64s", *worker_count + 1, skill_text + strspn(skill_text, " ;,"));
+			context_fail(context, VAGTPLAN_ERROR_FORMAT, reason);
+		}
+
+		name[MAX_NAME_LENGTH] = 0;
+		shift_text[32] = 0;
+		day_text[32] = 0;
+
+		workers[*worker_count].id = (unsigned short) *worker_count;
+		workers[*worker_count].forbidden_blocks = 0;
+		directory->name_offsets[*worker_count] = intern_worker_name(context, directory, &names, name);
+		directory->departments[*worker_count] = intern_department(context, directory, &names, department);
+		directory->worker_count = *worker_count + 1;
+
+		workers[*worker_count].desired_day_off = string_to_day(day_text);
+		if (workers[*worker_count].desired_day_off == DAY_INVALID) {
+			sprintf(reason, "Fejl i medarbejder liste på linje %u ved dag: %s er invalid", *worker_count + 1, day_text);
+			context_fail(context, VAGTPLAN_ERROR_FORMAT, reason);
+		}
+
+		workers[*worker_count].desired_shift = string_to_shift(shift_text);
+		if (workers[*worker_count].desired_shift == SHIFT_INVALID) {
+			sprintf(reason, "Fejl i medarbejder liste på linje %u ved vagt: %s er invalid", *worker_count + 1, shift_text);
+			context_fail(context, VAGTPLAN_ERROR_FORMAT, reason);
+		}
+
+		*worker_count += 1;
+	}
+	context_free(context, names.slots);
+	build_uuid_index(context, directory);
+	return context_reallocate(context, workers, *worker_count * sizeof( Worker));
+}
+
+unsigned int intern_worker_name(VagtplanContext* context, WorkerDirectory* directory, NameIndex* index, const char* name) {
+	size_t length = strlen(name);
+	unsigned int offset;
+	unsigned int slot;
+
+	if ((index->count + 1) * 2 > index->size) {
+		name_index_grow(context, directory, index);
+	}
+	/*Tabellen er højst halvt fuld, så søgningen stopper altid ved en tom plads*/
+	slot = (unsigned int) (hash_name(name) & (index->size - 1));
+	while (index->slots[slot] != 0) {
+		offset = index->slots[slot] - 1;
+		if (strcmp(directory->names + offset, name) == 0) {
+			return offset;
+		}
+		slot = (slot + 1) & (index->size - 1);
+	}
+	if (directory->names_length + length + 1 > directory->names_allocated) {
+		directory->names_allocated = (directory->names_length + length + 1) * 2;
+		directory->names = context_reallocate(context, directory->names, directory->names_allocated);
+	}
+	offset = (unsigned int) directory->names_length;
+	memcpy(directory->names + offset, name, length + 1);
+	directory->names_length += length + 1;
+	index->slots[slot] = offset + 1;
+	index->count++;
+	return offset;
+}
+
+void name_index_init(VagtplanContext* context, NameIndex* index) {
+	index->size = 64;
+	index->count = 0;
+	index->slots = context_allocate_zero(context, index->size, sizeof(unsigned int));
+}
+
+void name_index_grow(VagtplanContext* context, const WorkerDirectory* directory, NameIndex* index) {
+	unsigned int* old_slots = index->slots;
+	unsigned int old_size = index->size;
+	unsigned int i;
+
+	index->size = old_size * 2;
+	index->slots = context_allocate_zero(context, index->size, sizeof(unsigned int));
+	for (i = 0; i < old_size; i++) {
+		unsigned int slot;
+		if (old_slots[i] == 0) {
+			continue;
+		}
+		slot = (unsigned int) (hash_name(directory->names + old_slots[i] - 1) & (index->size - 1));
+		while (index->slots[slot] != 0) {
+			slot = (slot + 1) & (index->size - 1);
+		}
+		index->slots[slot] = old_slots[i];
+	}
+	context_free(context, old_slots);
+}
+
+unsigned long hash_name(const char* name) {
+	unsigned long hash = 2166136261UL;
+	for (; *name != 0; name++) {
+		hash = ((hash ^ (unsigned char) *name) * 16777619UL) & 0xFFFFFFFFUL;
+	}
+	return hash;
+}
+
+unsigned short intern_department(VagtplanContext* context, WorkerDirectory* directory, NameIndex* index, const char* name) {
+	unsigned int i;
+	for (i = 0; i < directory->department_count; i++) {
+		if (strcmp(directory->names + directory->department_offsets[i], name) == 0) {
+			return (unsigned short) i;
+		}
+	}
+	directory->department_offsets[i] = intern_worker_name(context, directory, index, name);
+	directory->department_count++;
+	return (unsigned short) i;
+}
+
+const char* worker_name(const WorkerDirectory* directory, const Worker* worker) {
+	return directory->names + directory->name_offsets[worker->id];
+}
+
+unsigned int worker_uuid(const WorkerDirectory* directory, const Worker* worker) {
+	return directory->uuids[worker->id];
+}
+
+void build_uuid_index(VagtplanContext* context, WorkerDirectory* directory) {
+	unsigned int i;
+	directory->uuid_index = context_allocate(context, directory->worker_count * sizeof(UuidEntry));
+	for (i = 0; i < directory->worker_count; i++) {
+		directory->uuid_index[i].uuid = directory->uuids[i];
+		directory->uuid_index[i].worker = i;
+	}
+	qsort(directory->uuid_index, directory->worker_count, sizeof(UuidEntry), compare_uuid_entries);
+}
+
+int compare_uuid_entries(const void* a, const void* b) {
+	const UuidEntry* first = a;
+	const UuidEntry* second = b;
+	if (first->uuid != second->uuid) {
+		return first->uuid < second->uuid ? -1 : 1;
+	}
+	return first->worker < second->worker ? -1 : first->worker > second->worker;
+}
+
+bool find_uuid(const WorkerDirectory* directory, unsigned int uuid, unsigned int* worker) {
+	unsigned int low = 0;
+	unsigned int high = directory->worker_count;
+	/*Finder den første plads med et uuid der ikke er mindre, så det laveste id vinder*/
+	while (low < high) {
+		unsigned int middle = low + (high - low) / 2;
+		if (directory->uuid_index[middle].uuid < uuid) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+	if (low == directory->worker_count || directory->uuid_index[low].uuid != uuid) {
+		return false;
+	}
+	*worker = directory->uuid_index[low].worker;
+	return true;
+}
+
+size_t worker_cache_layout(const WorkerCacheHeader* header, size_t* offsets, size_t* lengths) {
+	size_t position = sizeof(WorkerCacheHeader);
+	unsigned int i;
+	lengths[0] = header->worker_count * sizeof(Worker);
+	lengths[1] = header->worker_count * sizeof(unsigned int);
+	lengths[2] = header->worker_count * sizeof(unsigned int);
+	lengths[3] = header->worker_count * sizeof(UuidEntry);
+	lengths[4] = header->worker_count * sizeof(unsigned short);
+	lengths[5] = header->department_count * sizeof(unsigned int);
+	lengths[6] = header->names_length;
+	for (i = 0; i < WORKER_CACHE_SECTIONS; i++) {
+		position = (position + 7) / 8 * 8;
+		offsets[i] = position;
+		position += lengths[i];
+	}
+	return position;
+}
+
+bool read_source_key(const char* file_name, unsigned long* size, unsigned long* time) {
+#ifdef POSIX_SUPPORTED
+	struct stat info;
+	if (stat(file_name, &info) != 0 || !S_ISREG(info.st_mode)) {
+		return false;
+	}
+	*size = (unsigned long) info.st_size;
+	*time = (unsigned long) info.st_mtime;
+	return true;
+#else
+	FILE* file = fopen(file_name, "rb");
+	long length;
+	if (file == NULL) {
+		return false;
+	}
+	length = fseek(file, 0, SEEK_END) == 0 ? ftell(file) : -1;
+	fclose(file);
+	*size = (unsigned long) length;
+	*time = 0;
+	return length >= 0;
+#endif
+}
+
+bool hash_file(const char* file_name, unsigned long* hash) {
+	FILE* file = fopen(file_name, "rb");
+	unsigned char buffer[4096];
+	size_t length;
+	bool ok;
+	if (file == NULL) {
+		return false;
+	}
+	*hash = 2166136261UL;
+	while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+		size_t i;
+		for (i = 0; i < length; i++) {
+			*hash = ((*hash ^ buffer[i]) * 16777619UL) & 0xFFFFFFFFUL;
+		}
+	}
+	ok = !ferror(file);
+	fclose(file);
+	return ok;
+}
+
+bool read_worker_cache_header(const char* cache_name, WorkerCacheHeader* header) {
+	FILE* file = fopen(cache_name, "rb");
+	size_t offsets[WORKER_CACHE_SECTIONS];
+	size_t lengths[WORKER_CACHE_SECTIONS];
+	long length;
+	bool ok;
+	if (file == NULL) {
+		return false;
+	}
+	ok = fread(header, sizeof(WorkerCacheHeader), 1, file) == 1 && fseek(file, 0, SEEK_END) == 0;
+	length = ok ? ftell(file) : -1;
+	fclose(file);
+	/*Grænserne holder længderne små nok til at worker_cache_layout ikke kan løbe over*/
+	return ok
+		&& memcmp(header->magic, WORKER_CACHE_MAGIC, sizeof(header->magic)) == 0
+		&& header->worker_size == sizeof(Worker)
+		&& header->worker_count <= 65535
+		&& header->department_count <= header->worker_count
+		&& header->names_length <= header->worker_count * 2 * (MAX_NAME_LENGTH + 1)
+		&& length >= 0
+		&& worker_cache_layout(header, offsets, lengths) == (size_t) length;
+}
+
+bool copy_worker_cache(const char* cache_name, size_t length, const size_t* offsets, const size_t* lengths, void* const* targets) {
+	unsigned int i;
+#ifdef POSIX_SUPPORTED
+	struct stat info;
+	const char* image;
+	int descriptor = open(cache_name, O_RDONLY);
+	if (descriptor < 0) {
+		return false;
+	}
+	if (fstat(descriptor, &info) != 0 || (size_t) info.st_size != length) {
+		close(descriptor);
+		return false;
+	}
+	image = mmap(NULL, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+	close(descriptor);
+	if (image == MAP_FAILED) {
+		return false;
+	}
+	for (i = 0; i < WORKER_CACHE_SECTIONS; i++) {
+		memcpy(targets[i], image + offsets[i], lengths[i]);
+	}
+	munmap((void*) image, length);
+	return true;
+#else
+	FILE* file = fopen(cache_name, "rb");
+	bool ok = file != NULL;
+	(void) length;
+	for (i = 0; ok && i < WORKER_CACHE_SECTIONS; i++) {
+		ok = fseek(file, (long) offsets[i], SEEK_SET) == 0 && fread(targets[i], 1, lengths[i], file) == lengths[i];
+	}
+	if (file != NULL) {
+		fclose(file);
+	}
+	return ok;
+#endif
+}
+
+bool valid_worker_cache(const Worker* workers, const WorkerDirectory* directory) {
+	unsigned int i;
+	if (directory->names_length > 0 && directory->names[directory->names_length - 1] != 0) {
+		return false;
+	}
+	for (i = 0; i < directory->department_count; i++) {
+		if (directory->department_offsets[i] >= directory->names_length) {
+			return false;
+		}
+	}
+	for (i = 0; i < directory->worker_count; i++) {
+		const UuidEntry* entry = &directory->uuid_index[i];
+		if (workers[i].id != i
+			|| workers[i].desired_day_off >= DAY_INVALID
+			|| workers[i].desired_shift >= SHIFT_INVALID
+			|| workers[i].skills >= 1 << VAGTPLAN_SKILL_COUNT
+			|| workers[i].forbidden_blocks != 0
+			|| directory->name_offsets[i] >= directory->names_length
+			|| directory->departments[i] >= directory->department_count
+			|| entry->worker >= directory->worker_count
+			|| directory->uuids[entry->worker] != entry->uuid
+			|| (i > 0 && compare_uuid_entries(entry - 1, entry) >= 0)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+enum VagtplanStatus load_worker_cache(VagtplanContext* context, const char* cache_name, const WorkerCacheHeader* header) {
+	unsigned long mark = context_begin(context);
+	WorkerDirectory* directory = &context->directory;
+	size_t offsets[WORKER_CACHE_SECTIONS];
+	size_t lengths[WORKER_CACHE_SECTIONS];
+	void* targets[WORKER_CACHE_SECTIONS];
+	size_t length = worker_cache_layout(header, offsets, lengths);
+	unsigned int i;
+
+	if (setjmp(context->error_jump) != 0) {
+		context->workers = NULL;
+		context->worker_count = 0;
+		context->directory.department_count = 0;
+		context->pools.workers = NULL;
+		context->pools.stamps = NULL;
+		context->static_scores = NULL;
+		return context_rollback(context, mark);
+	}
+	/*Alt bliver allokeret før filen bliver åbnet, så der ikke bliver hoppet ud mens den er åben*/
+	for (i = 0; i < WORKER_CACHE_SECTIONS; i++) {
+		targets[i] = context_allocate(context, lengths[i]);
+	}
+	if (!copy_worker_cache(cache_name, length, offsets, lengths, targets)) {
+		context_fail(context, VAGTPLAN_ERROR_SYSTEM, "Kunne ikke læse cachen med medarbejderlisten");
+	}
+	directory->worker_count = (unsigned int) header->worker_count;
+	directory->uuids = targets[1];
+	directory->name_offsets = targets[2];
+	directory->uuid_index = targets[3];
+	directory->departments = targets[4];
+	directory->department_offsets = targets[5];
+	directory->department_count = (unsigned int) header->department_count;
+	directory->names = targets[6];
+	directory->names_length = header->names_length;
+	directory->names_allocated = header->names_length;
+	if (!valid_worker_cache(targets[0], directory)) {
+		context_fail(context, VAGTPLAN_ERROR_FORMAT, "Cachen med medarbejderlisten er ødelagt");
+	}
+	context->workers = targets[0];
+	context->worker_count = directory->worker_count;
+	build_candidate_pools(context);
+	return VAGTPLAN_OK;
+}
+
+bool write_worker_cache(const VagtplanContext* context, const char* cache_name, const WorkerCacheHeader* source) {
+	const WorkerDirectory* directory = &context->directory;
+	const void* sections[WORKER_CACHE_SECTIONS];
+	size_t offsets[WORKER_CACHE_SECTIONS];
+	size_t lengths[WORKER_CACHE_SECTIONS];
+	char temporary_name[FILENAME_MAX];
+	WorkerCacheHeader header = *source;
+	size_t position = sizeof(WorkerCacheHeader);
+	unsigned int i;
+	FILE* file;
+	bool ok;
+
+	if (strlen(cache_name) + 5 > sizeof(temporary_name)) {
+		return false;
+	}
+	sprintf(temporary_name, "%s.tmp", cache_name);
+	memcpy(header.magic, WORKER_CACHE_MAGIC, sizeof(header.magic));
+	header.worker_size = sizeof(Worker);
+	header.written_time = (unsigned long) time(NULL);
+	header.worker_count = context->worker_count;
+	header.department_count = directory->department_count;
+	header.names_length = directory->names_length;
+	worker_cache_layout(&header, offsets, lengths);
+	sections[1] = directory->uuids;
+	sections[2] = directory->name_offsets;
+	sections[3] = directory->uuid_index;
+	sections[4] = directory->departments;
+	sections[5] = directory->department_offsets;
+	sections[6] = directory->names;
+
+	file = fopen(temporary_name, "wb");
+	if (file == NULL) {
+		return false;
+	}
+	ok = fwrite(&header, sizeof(header), 1, file) == 1;
+	for (i = 0; ok && i < WORKER_CACHE_SECTIONS; i++) {
+		for (; ok && position < offsets[i]; position++) {
+			ok = putc(0, file) != EOF;
+		}
+		if (i == 0) {
+			/*Tilstanden som scoren bruger bliver nulstillet, så den ikke følger med i filen*/
+			unsigned int worker;
+			for (worker = 0; ok && worker < context->worker_count; worker++) {
+				Worker clean = context->workers[worker];
+				clean.last_block = 0;
+				clean.consecutive_night_shifts = 0;
+				clean.day_off = 0;
+				clean.forbidden_blocks = 0;
+				ok = fwrite(&clean, sizeof(Worker), 1, file) == 1;
+			}
+		} else {
+			ok = fwrite(sections[i], 1, lengths[i], file) == lengths[i];
+		}
+		position += lengths[i];
+	}
+	ok = fclose(file) == 0 && ok;
+	/*Uden POSIX kan rename ikke erstatte en fil der findes*/
+	if (ok && rename(temporary_name, cache_name) != 0) {
+		remove(cache_name);
+		ok = rename(temporary_name, cache_name) == 0;
+	}
+	if (!ok) {
+		remove(temporary_name);
+	}
+	return ok;
+}
+
+enum Shift string_to_shift(char* input) {
+	if (strcmp(input, "nat") == 0) {
+		return SHIFT_NIGHT;
+	} else if (strcmp(input, "dag") == 0) {
+		return SHIFT_DAY;
+	} else if (strcmp(input, "aften") == 0) {
+		return SHIFT_EVENING;
+	} else {
+		return SHIFT_INVALID;
+	}
+}
+
+enum Skill string_to_skill(const char* input) {
+	if (strcmp(input, "sygeplejerske") == 0) {
+		return SKILL_NURSE;
+	} else if (strcmp(input, "læge") == 0) {
+		return SKILL_DOCTOR;
+	} else if (strcmp(input, "nattevagt") == 0) {
+		return SKILL_NIGHT;
+	} else {
+		return SKILL_INVALID;
+	}
+}
+
+bool parse_worker_columns(const char* text, unsigned char* skills, char* department) {
+	/*Plads til afdeling: og et navn på MAX_NAME_LENGTH tegn*/
+	char column[60];
+	int length;
+	*skills = 0;
+	department[0] = 0;
+	while (sscanf(text, " %*1[;,] %59[^;,\r\n]%n", column, &length) == 1) {
+		size_t end = strlen(column);
+		while (end > 0 && (column[end - 1] == ' ' || column[end - 1] == '\t')) {
+			column[--end] = 0;
+		}
+		if (strncmp(column, "afdeling:", 9) == 0) {
+			const char* name = column + 9 + strspn(column + 9, " \t");
+			if (name[0] == 0 || department[0] != 0) {
+				return false;
+			}
+			strcpy(department, name);
+		} else {
+			enum Skill skill = string_to_skill(column);
+			if (skill == SKILL_INVALID) {
+				return false;
+			}
+			*skills |= 1 << skill;
+		}
+		text += length;
+	}
+	/*Der må kun være blanktegn og tomme kolonner tilbage*/
+	return text[strspn(text, " \t\r;,")] == 0;
+}
+
+enum Day string_to_day(char* input) {
+	if (strcmp(input, "mandag") == 0) {
+		return DAY_MONDAY;
+	} else if (strcmp(input, "tirsdag") == 0) {
+		return DAY_TUESDAY;
+	} else if (strcmp(input, "onsdag") == 0) {
+		return DAY_WEDNESDAY;
+	} else if (strcmp(input, "torsdag") == 0) {
+		return DAY_THURSDAY;
+	} else if (strcmp(input, "fredag") == 0) {
+		return DAY_FRIDAY;
+	} else if (strcmp(input, "lørdag") == 0) {
+		return DAY_SATURDAY;
+	} else if (strcmp(input, "søndag") == 0) {
+		return DAY_SUNDAY;
+	} else {
+		return DAY_INVALID;
+	}
+}
+
+Schedule make_schedule(VagtplanContext* context, Worker* workers[], const unsigned int worker_count, const RequiredWorkers required_workers, Schedule* seeds, unsigned int seed_count, const SolverOptions* options, ScheduleArchive* archive) {
+	Solver solver;
+	SolverProblem problem;
+	Schedule rv;
+	double deadline = options->time_limit > 0 ? wall_seconds() + options->time_limit : 0;
+	double published = -HUGE_VAL;
+	unsigned int steps = 0;
+	unsigned int i;
+
+	problem.context = context;
+	problem.workers = workers;
+	problem.worker_count = worker_count;
+	problem.required_workers = required_workers;
+	problem.upper_bound = score_upper_bound(context, workers, worker_count, required_workers);
+	context_log(context, "Den højest mulige score er %f\n", problem.upper_bound);
+
+	for (i = 0; i < seed_count; i++) {
+		evaluate_schedule(&seeds[i], required_workers, workers, worker_count, context->static_scores);
+		context_log(context, "Startvagtplan %u har en score på %f\n", i + 1, seeds[i].score);
+	}
+	problem.seeds = seeds;
+	problem.seed_count = seed_count;
+	problem.archive = archive;
+
+	if (options->islands > 1) {
+#ifdef ISLANDS_SUPPORTED
+		return island_schedule(&problem, options);
+#else
+		context_log(context, "Øer kræver POSIX delt hukommelse, kører i en enkelt proces\n");
+#endif
+	}
+
+	select_solver(&solver, options);
+	solver.init(&solver, &problem, options);
+	while (solver.step(&solver)) {
+		steps++;
+		if (options->progress != NULL) {
+			/*Der bliver kun skrevet når der er noget nyt, så det koster næsten ingenting at holde øje*/
+			if (solver.best(&solver)->score > published) {
+				published = solver.best(&solver)->score;
+				progress_publish(options->progress, solver.best(&solver), steps);
+			}
+			if (options->progress->stop_requested) {
+				context_log(context, "Stoppet undervejs, den bedste vagtplan har en score på %f\n", published);
+				break;
+			}
+		}
+		/*Der er ingen grund til at køre videre når den bedste vagtplan ikke kan blive bedre*/
+		if (solver.best(&solver)->score >= problem.upper_bound) {
+			context_log(context, "Den bedste vagtplan har nået den højest mulige score %f, stopper tidligt\n", problem.upper_bound);
+			break;
+		}
+		if (deadline > 0 && wall_seconds() >= deadline) {
+			context_log(context, "Tiden er gået, den bedste vagtplan har en score på %f\n", solver.best(&solver)->score);
+			break;
+		}
+	}
+	rv = solver.stop(&solver);
+	/*Den eksakte søgning tilbyder ikke noget undervejs*/
+	archive_offer(archive, &rv);
+	return rv;
+}
+
+void select_solver(Solver* solver, const SolverOptions* options) {
+	solver->state = NULL;
+	solver->best = genetic_best;
+	solver->stop = genetic_stop;
+	solver->immigrate = genetic_immigrate;
+	switch (options->engine) {
+	case ENGINE_GENERATIONAL:
+		solver->init = genetic_init;
+		solver->step = generational_step;
+#ifdef THREADS_SUPPORTED
+		if (options->threads > 1) {
+			solver->init = pipeline_init;
+			solver->step = pipeline_step;
+			solver->stop = pipeline_stop;
+			solver->immigrate = pipeline_immigrate;
+		}
+#endif
+		break;
+	case ENGINE_STEADY_STATE:
+		solver->init = genetic_init;
+		solver->step = steady_state_step;
+		break;
+	case ENGINE_EXACT:
+		solver->init = exact_init;
+		solver->step = exact_step;
+		solver->best = exact_best;
+		solver->stop = exact_stop;
+		solver->immigrate = NULL;
+		break;
+	case ENGINE_ANNEALING:
+		solver->init = annealing_init;
+		solver->step = annealing_step;
+		solver->best = local_search_best;
+		solver->stop = local_search_stop;
+		solver->immigrate = local_search_immigrate;
+		break;
+	case ENGINE_TABU:
+		solver->init = tabu_init;
+		solver->step = tabu_step;
+		solver->best = local_search_best;
+		solver->stop = local_search_stop;
+		solver->immigrate = local_search_immigrate;
+		break;
+	default:
+		program_error("Program fejl5");
+	}
+}
+
+void genetic_init(Solver* solver, const SolverProblem* problem, const SolverOptions* options) {
+	GeneticState* state = context_allocate(problem->context, sizeof(GeneticState));
+	genetic_setup(state, problem, options);
+	solver->state = state;
+}
+
+void genetic_setup(GeneticState* state, const SolverProblem* problem, const SolverOptions* options) {
+	VagtplanContext* context = problem->context;
+	Population* population = &state->population;
+	unsigned int seeded = problem->seed_count > 0 ? (unsigned int) (options->population_size * SEED_FRACTION) : 0;
+	unsigned int greedy = seeded + (unsigned int) ((options->population_size - seeded) * options->greedy_fraction);
+	unsigned int i;
+	state->problem = *problem;
+	state->options = *options;
+	state->generation = 1;
+	state->best = 0;
+	state->ranks = NULL;
+	init_mutation_control(&state->mutation, options->adaptive_mutation);
+	init_crossover_control(&state->crossover, options->crossover);
+
+	init_population(context, population, problem->workers, problem->worker_count, options->population_size, problem->required_workers.offsets[21]);
+	allocate_schedule(context, &state->parents[0], problem->required_workers);
+	allocate_schedule(context, &state->parents[1], problem->required_workers);
+	allocate_schedule(context, &state->child, problem->required_workers);
+	allocate_schedule(context, &state->best_schedule, problem->required_workers);
+	if (options->engine == ENGINE_GENERATIONAL) {
+		state->ranks = context_allocate(context, options->population_size * sizeof(PopulationRank));
+	}
+	context_log(context, "Populationen har %u individer på %u bit og fylder %.1f MB\n", population->size, population->gene_size * 8, (double) population->size * population->total_slots * population->gene_size / 1e6);
+
+	/*En del af populationen starter som kopier af startvagtplanerne, og dem der ikke er direkte kopier bliver muteret lidt.
+	Af resten bliver greedy_fraction lavet grådigt og de andre tilfældigt, så der stadig er forskellighed nok*/
+	for (i = 0; i < population->size; i++) {
+		if (i < seeded) {
+			copy_schedule(&problem->seeds[i % problem->seed_count], &state->child, problem->required_workers);
+			if (i >= problem->seed_count) {
+				mutate_schedule(context, problem->required_workers, &state->child, random_number(context, 1, SEED_MAX_MUTATED_BLOCKS + 1));
+			}
+		} else if (i < greedy) {
+			fill_greedy_schedule(context, problem->required_workers, &state->child);
+		} else {
+			fill_random_schedule(context, problem->required_workers, &state->child);
+		}
+		evaluate_schedule(&state->child, problem->required_workers, problem->workers, problem->worker_count, context->static_scores);
+		archive_offer(problem->archive, &state->child);
+		pack_individual(population, i, &state->child);
+		if (state->child.score > population->scores[state->best]) {
+			state->best = i;
+		}
+		if (state->ranks != NULL) {
+			state->ranks[i].individual = i;
+		}
+	}
+}
+
+bool generational_step(Solver* solver) {
+	GeneticState* state = solver->state;
+	VagtplanContext* context = state->problem.context;
+	Population* population = &state->population;
+	PopulationRank* ranks = state->ranks;
+	Worker** workers = state->problem.workers;
+	unsigned int worker_count = state->problem.worker_count;
+	RequiredWorkers required_workers = state->problem.required_workers;
+	unsigned int elite = state->options.elite_size;
+	unsigned int children = state->options.elite_size * state->options.children_per_elite;
+	unsigned int i;
+
+	if (state->generation >= state->options.generations) {
+		return false;
+	}
+
+	/*Individerne bliver evalueret når de bliver pakket, så kun rangordenen skal sorteres*/
+	for (i = 0; i < population->size; i++) {
+		ranks[i].score = population->scores[ranks[i].individual];
+	}
+	qsort(ranks, population->size, sizeof(PopulationRank), compare_ranks);
+	state->best = ranks[0].individual;
+	if (state->generation % 1000 == 0) {
+		context_log(context, "Generation nummer %u. Max fitness er %f, værste: %f, gab: %f, mutation: %.2f på %u blokke, crossover: %.2f %.2f %.2f %.2f\n", state->generation, ranks[0].score, ranks[population->size - 1].score, state->problem.upper_bound - ranks[0].score, state->mutation.probability, state->mutation.blocks, state->crossover.probabilities[0], state->crossover.probabilities[1], state->crossover.probabilities[2], state->crossover.probabilities[3]);
+	}
+	if (update_mutation_control(&state->mutation, ranks[0].score, population_diversity(context, population, required_workers))) {
+		/*Eliten beholdes, resten af de nye individer bliver sorteret på plads i næste generation*/
+		inject_immigrants(context, population, ranks, elite, state->best, &state->child, workers, worker_count, required_workers);
+	}
+	/*Børnene erstatter de dårligste, så eliten og deres partnere bliver aldrig overskrevet undervejs*/
+	for (i = 0; i < elite; i++) {
+		unsigned int partner = ranks[random_number(context, elite, population->size - children)].individual;
+		double parent_score;
+		unsigned int j;
+		unpack_individual(population, ranks[i].individual, &state->parents[0]);
+		unpack_individual(population, partner, &state->parents[1]);
+		parent_score = state->parents[0].score > state->parents[1].score ? state->parents[0].score : state->parents[1].score;
+		for (j = 0; j < state->options.children_per_elite; j++) {
+			unsigned int target = ranks[population->size - children + i * state->options.children_per_elite + j].individual;
+			enum CrossoverOperator crossover = choose_crossover(context, &state->crossover);
+			combine_schedule(context, required_workers, &state->parents[0], &state->parents[1], &state->child, &state->mutation, crossover);
+			evaluate_schedule(&state->child, required_workers, workers, worker_count, context->static_scores);
+			archive_offer(state->problem.archive, &state->child);
+			record_crossover(&state->crossover, crossover, state->child.score > parent_score);
+			pack_individual(population, target, &state->child);
+			if (state->child.score > population->scores[state->best]) {
+				state->best = target;
+			}
+		}
+	}
+	update_crossover_control(&state->crossover);
+	state->generation++;
+	return true;
+}
+
+bool steady_state_step(Solver* solver) {
+	GeneticState* state = solver->state;
+	VagtplanContext* context = state->problem.context;
+	Population* population = &state->population;
+	Worker** workers = state->problem.workers;
+	unsigned int worker_count = state->problem.worker_count;
+	RequiredWorkers required_workers = state->problem.required_workers;
+	unsigned int tournament_size = state->options.tournament_size;
+	unsigned int children = state->options.elite_size * state->options.children_per_elite;
+	unsigned int step;
+	unsigned int i;
+
+	if (state->generation >= state->options.generations) {
+		return false;
+	}
+
+	for (step = 0; step < children; step++) {
+		unsigned int a = tournament_select(context, population->scores, population->size, tournament_size);
+		unsigned int b = tournament_select(context, population->scores, population->size, tournament_size);
+		unsigned int loser = tournament_select_loser(context, population->scores, population->size, tournament_size, state->best);
+		enum CrossoverOperator crossover = choose_crossover(context, &state->crossover);
+
+		unpack_individual(population, a, &state->parents[0]);
+		unpack_individual(population, b, &state->parents[1]);
+		combine_schedule(context, required_workers, &state->parents[0], &state->parents[1], &state->child, &state->mutation, crossover);
+		evaluate_schedule(&state->child, required_workers, workers, worker_count, context->static_scores);
+		archive_offer(state->problem.archive, &state->child);
+
+		record_crossover(&state->crossover, crossover, state->child.score > population->scores[a] && state->child.score > population->scores[b]);
+		if (state->child.score < population->scores[loser]) {
+			continue;
+		}
+
+		/*Barnet bliver pakket ind på taberens plads*/
+		pack_individual(population, loser, &state->child);
+		if (state->child.score > population->scores[state->best]) {
+			state->best = loser;
+		}
+	}
+
+	if (state->generation % 1000 == 0) {
+		double worst = population->scores[0];
+		for (i = 1; i < population->size; i++) {
+			if (population->scores[i] < worst) {
+				worst = population->scores[i];
+			}
+		}
+		context_log(context, "Generation nummer %u. Max fitness er %f, værste: %f, gab: %f, mutation: %.2f på %u blokke, crossover: %.2f %.2f %.2f %.2f\n", state->generation, population->scores[state->best], worst, state->problem.upper_bound - population->scores[state->best], state->mutation.probability, state->mutation.blocks, state->crossover.probabilities[0], state->crossover.probabilities[1], state->crossover.probabilities[2], state->crossover.probabilities[3]);
+	}
+	update_crossover_control(&state->crossover);
+	if (update_mutation_control(&state->mutation, population->scores[state->best], population_diversity(context, population, required_workers))) {
+		inject_immigrants(context, population, NULL, 0, state->best, &state->child, workers, worker_count, required_workers);
+	}
+	state->generation++;
+	return true;
+}
+
+void genetic_immigrate(Solver* solver, const Schedule* migrant) {
+	GeneticState* state = solver->state;
+	Population* population = &state->population;
+	unsigned int loser = tournament_select_loser(state->problem.context, population->scores, population->size, state->options.tournament_size, state->best);
+	pack_individual(population, loser, migrant);
+	if (migrant->score > population->scores[state->best]) {
+		state->best = loser;
+	}
+}
+
+const Schedule* genetic_best(const Solver* solver) {
+	GeneticState* state = solver->state;
+	unpack_individual(&state->population, state->best, &state->best_schedule);
+	return &state->best_schedule;
+}
+
+Schedule genetic_stop(Solver* solver) {
+	GeneticState* state = solver->state;
+	VagtplanContext* context = state->problem.context;
+	Schedule rv;
+
+	/*Alle individer er allerede evalueret, så den bedste bliver bare pakket ud og resten frigivet*/
+	unpack_individual(&state->population, state->best, &state->best_schedule);
+	rv = state->best_schedule;
+	free_schedule(context, &state->parents[0]);
+	free_schedule(context, &state->parents[1]);
+	free_schedule(context, &state->child);
+	free_population(context, &state->population);
+	if (state->ranks != NULL) {
+		context_free(context, state->ranks);
+	}
+	context_free(context, state);
+	solver->state = NULL;
+	return rv;
+}
+
+void init_population(VagtplanContext* context, Population* population, Worker** workers, unsigned int worker_count, unsigned int size, unsigned int total_slots) {
+	unsigned int i;
+	population->size = size;
+	population->total_slots = total_slots;
+	population->gene_size = worker_count <= 256 ? 1 : 2;
+	population->genes = context_allocate(context, (size_t) size * total_slots * population->gene_size);
+	population->scores = context_allocate(context, size * sizeof(double));
+	population->workers = context_allocate(context, worker_count * sizeof(Worker*));
+	for (i = 0; i < worker_count; i++) {
+		population->workers[workers[i]->id] = workers[i];
+	}
+}
+
+void free_population(VagtplanContext* context, Population* population) {
+	context_free(context, population->genes);
+	context_free(context, population->scores);
+	context_free(context, population->workers);
+}
+
+void pack_individual(Population* population, unsigned int individual, const Schedule* schedule) {
+	size_t individual_length = (size_t) population->total_slots * population->gene_size;
+	encode_genes(schedule, population->gene_size, population->total_slots, population->genes + individual * individual_length);
+	population->scores[individual] = schedule->score;
+}
+
+void unpack_individual(const Population* population, unsigned int individual, Schedule* out) {
+	size_t individual_length = (size_t) population->total_slots * population->gene_size;
+	decode_genes(population->genes + individual * individual_length, population->gene_size, population->total_slots, population->workers, out);
+	out->score = population->scores[individual];
+}
+
+void encode_genes(const Schedule* schedule, unsigned int gene_size, unsigned int total_slots, unsigned char* genes) {
+	unsigned int position;
+	if (gene_size == 1) {
+		for (position = 0; position < total_slots; position++) {
+			genes[position] = (unsigned char) schedule->workers[position]->id;
+		}
+	} else {
+		unsigned short* wide_genes = (unsigned short*) genes;
+		for (position = 0; position < total_slots; position++) {
+			wide_genes[position] = schedule->workers[position]->id;
+		}
+	}
+}
+
+void decode_genes(const unsigned char* genes, unsigned int gene_size, unsigned int total_slots, Worker** workers, Schedule* out) {
+	unsigned int position;
+	if (gene_size == 1) {
+		for (position = 0; position < total_slots; position++) {
+			out->workers[position] = workers[genes[position]];
+		}
+	} else {
+		const unsigned short* wide_genes = (const unsigned short*) genes;
+		for (position = 0; position < total_slots; position++) {
+			out->workers[position] = workers[wide_genes[position]];
+		}
+	}
+}
+
+void copy_individual(const Population* from, unsigned int from_individual, Population* to, unsigned int to_individual) {
+	size_t individual_length = (size_t) from->total_slots * from->gene_size;
+	memcpy(to->genes + to_individual * individual_length, from->genes + from_individual * individual_length, individual_length);
+	to->scores[to_individual] = from->scores[from_individual];
+}
+
+int compare_ranks(const void* a, const void* b) {
+	const PopulationRank* first = a;
+	const PopulationRank* second = b;
+	if (first->score != second->score) {
+		return first->score > second->score ? -1 : 1;
+	}
+	/*Lige scorer bliver ordnet efter individ, så sorteringen er den samme på alle platforme*/
+	return first->individual < second->individual ? -1 : first->individual > second->individual;
+}
+
+void rank_population(const Population* population, PopulationRank* ranks) {
+	unsigned int i;
+	for (i = 0; i < population->size; i++) {
+		ranks[i].score = population->scores[i];
+		ranks[i].individual = i;
+	}
+	qsort(ranks, population->size, sizeof(PopulationRank), compare_ranks);
+}
+#ifdef THREADS_SUPPORTED
+TaskPool* task_pool_create(VagtplanContext* context, unsigned int threads) {
+	TaskPool* pool = context_allocate(context, sizeof(TaskPool));
+	unsigned int i;
+	pool->thread_count = threads;
+	pool->queued = 0;
+	pool->stopping = false;
+	pool->deques = context_allocate(context, threads * sizeof(TaskDeque));
+	pool->threads = context_allocate(context, threads * sizeof(TaskThread));
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_cond_init(&pool->wake, NULL);
+	for (i = 0; i < threads; i++) {
+		pthread_mutex_init(&pool->deques[i].lock, NULL);
+		pool->deques[i].top = 0;
+		pool->deques[i].count = 0;
+		pool->threads[i].pool = pool;
+		pool->threads[i].index = i;
+	}
+	/*Tråd 0 er den der har lavet puljen, så kun de andre bliver startet*/
+	for (i = 1; i < threads; i++) {
+		if (pthread_create(&pool->threads[i].thread, NULL, task_pool_thread, &pool->threads[i]) != 0) {
+			task_pool_stop(pool, i);
+			context_fail(context, VAGTPLAN_ERROR_SYSTEM, "Kunne ikke starte trådene");
+		}
+	}
+	return pool;
+}
+
+void task_pool_stop(TaskPool* pool, unsigned int started) {
+	unsigned int i;
+	pthread_mutex_lock(&pool->lock);
+	pool->stopping = true;
+	pthread_cond_broadcast(&pool->wake);
+	pthread_mutex_unlock(&pool->lock);
+	for (i = 1; i < started; i++) {
+		pthread_join(pool->threads[i].thread, NULL);
+	}
+	for (i = 0; i < pool->thread_count; i++) {
+		pthread_mutex_destroy(&pool->deques[i].lock);
+	}
+	pthread_mutex_destroy(&pool->lock);
+	pthread_cond_destroy(&pool->wake);
+}
+
+void task_pool_destroy(VagtplanContext* context, TaskPool* pool) {
+	task_pool_stop(pool, pool->thread_count);
+	context_free(context, pool->threads);
+	context_free(context, pool->deques);
+	context_free(context, pool);
+}
+
+void task_pool_submit(TaskPool* pool, unsigned int thread, TaskGroup* group, VagtplanTaskFunction function, void* argument, unsigned long begin, unsigned long end, unsigned long grain) {
+	Task task;
+	task.function = function;
+	task.argument = argument;
+	task.begin = begin;
+	task.end = end;
+	task.grain = grain > 0 ? grain : 1;
+	task.group = group;
+	pthread_mutex_lock(&pool->lock);
+	group->pending++;
+	pthread_mutex_unlock(&pool->lock);
+	if (!task_pool_push(pool, thread, &task)) {
+		task_pool_execute(pool, thread, &task);
+	}
+}
+
+bool task_pool_push(TaskPool* pool, unsigned int thread, const Task* task) {
+	TaskDeque* deque = &pool->deques[thread];
+	bool pushed = false;
+	pthread_mutex_lock(&deque->lock);
+	if (deque->count < TASK_DEQUE_SIZE) {
+		deque->tasks[(deque->top + deque->count) % TASK_DEQUE_SIZE] = *task;
+		deque->count++;
+		pushed = true;
+	}
+	pthread_mutex_unlock(&deque->lock);
+	if (pushed) {
+		pthread_mutex_lock(&pool->lock);
+		pool->queued++;
+		pthread_cond_broadcast(&pool->wake);
+		pthread_mutex_unlock(&pool->lock);
+	}
+	return pushed;
+}
+
+bool task_pool_run_one(TaskPool* pool, unsigned int thread) {
+	Task task;
+	unsigned int i;
+	for (i = 0; i < pool->thread_count; i++) {
+		TaskDeque* deque = &pool->deques[(thread + i) % pool->thread_count];
+		bool taken = false;
+		pthread_mutex_lock(&deque->lock);
+		if (deque->count > 0) {
+			/*Trådens egen kø bliver taget fra bunden, de andres fra toppen*/
+			if (i == 0) {
+				task = deque->tasks[(deque->top + deque->count - 1) % TASK_DEQUE_SIZE];
+			} else {
+				task = deque->tasks[deque->top];
+				deque->top = (deque->top + 1) % TASK_DEQUE_SIZE;
+			}
+			deque->count--;
+			taken = true;
+		}
+		pthread_mutex_unlock(&deque->lock);
+		if (taken) {
+			pthread_mutex_lock(&pool->lock);
+			pool->queued--;
+			pthread_mutex_unlock(&pool->lock);
+			task_pool_execute(pool, thread, &task);
+			return true;
+		}
+	}
+	return false;
+}
+
+void task_pool_execute(TaskPool* pool, unsigned int thread, Task* task) {
+	/*Den øverste halvdel bliver lagt i køen indtil stykket er nede på grain. Er køen fuld kører tråden bare resten selv*/
+	while (task->end - task->begin > task->grain) {
+		Task upper = *task;
+		upper.begin = task->begin + (task->end - task->begin) / 2;
+		pthread_mutex_lock(&pool->lock);
+		task->group->pending++;
+		pthread_mutex_unlock(&pool->lock);
+		if (!task_pool_push(pool, thread, &upper)) {
+			pthread_mutex_lock(&pool->lock);
+			task->group->pending--;
+			pthread_mutex_unlock(&pool->lock);
+			break;
+		}
+		task->end = upper.begin;
+	}
+	task->function(task->argument, thread, task->begin, task->end);
+	pthread_mutex_lock(&pool->lock);
+	task->group->pending--;
+	if (task->group->pending == 0) {
+		pthread_cond_broadcast(&pool->wake);
+	}
+	pthread_mutex_unlock(&pool->lock);
+}
+
+void task_pool_join(TaskPool* pool, unsigned int thread, TaskGroup* group) {
+	for (;;) {
+		if (task_pool_run_one(pool, thread)) {
+			continue;
+		}
+		pthread_mutex_lock(&pool->lock);
+		while (group->pending > 0 && pool->queued <= 0) {
+			pthread_cond_wait(&pool->wake, &pool->lock);
+		}
+		if (group->pending == 0) {
+			pthread_mutex_unlock(&pool->lock);
+			return;
+		}
+		pthread_mutex_unlock(&pool->lock);
+	}
+}
+
+void* task_pool_thread(void* argument) {
+	TaskThread* self = argument;
+	TaskPool* pool = self->pool;
+	for (;;) {
+		if (task_pool_run_one(pool, self->index)) {
+			continue;
+		}
+		pthread_mutex_lock(&pool->lock);
+		while (pool->queued <= 0 && !pool->stopping) {
+			pthread_cond_wait(&pool->wake, &pool->lock);
+		}
+		if (pool->stopping) {
+			pthread_mutex_unlock(&pool->lock);
+			return NULL;
+		}
+		pthread_mutex_unlock(&pool->lock);
+	}
+}
+#endif
+
+#ifdef THREADS_SUPPORTED
+void pipeline_init(Solver* solver, const SolverProblem* problem, const SolverOptions* options) {
+	VagtplanContext* context = problem->context;
+	PipelineState* pipeline = context_allocate(context, sizeof(PipelineState));
+	GeneticState* genetic = &pipeline->genetic;
+	unsigned int total_slots = problem->required_workers.offsets[21];
+	unsigned int batch_children = CHILD_BATCH_PAIRS * options->children_per_elite;
+	size_t individual_length;
+	unsigned int i;
+
+	genetic_setup(genetic, problem, options);
+	rank_population(&genetic->population, genetic->ranks);
+	genetic->best = genetic->ranks[0].individual;
+	individual_length = (size_t) total_slots * genetic->population.gene_size;
+	init_population(context, &pipeline->back, problem->workers, problem->worker_count, options->population_size, total_slots);
+	pipeline->back_ranks = context_allocate(context, options->population_size * sizeof(PopulationRank));
+	pipeline->mutation = genetic->mutation;
+	pipeline->crossover = genetic->crossover;
+	pipeline->pending = NULL;
+	pipeline->pending_used = 0;
+	pipeline->next_elite = 0;
+	pipeline->stopping = false;
+	pipeline->batches_group.pending = 0;
+
+	pipeline->batch_count = options->threads * BATCHES_PER_THREAD;
+	pipeline->batches = context_allocate(context, pipeline->batch_count * sizeof(ChildBatch));
+	pipeline->full_batches = context_allocate(context, pipeline->batch_count * sizeof(ChildBatch*));
+	for (i = 0; i < pipeline->batch_count; i++) {
+		ChildBatch* batch = &pipeline->batches[i];
+		batch->count = 0;
+		batch->genes = context_allocate(context, batch_children * individual_length);
+		batch->scores = context_allocate(context, batch_children * sizeof(double));
+		batch->operators = context_allocate(context, batch_children);
+		batch->improved = context_allocate(context, batch_children);
+	}
+	pipeline->full_first = 0;
+	pipeline->full_count = 0;
+
+	pipeline->producer_count = options->threads;
+	pipeline->producers = context_allocate(context, options->threads * sizeof(PipelineProducer));
+	for (i = 0; i < options->threads; i++) {
+		PipelineProducer* producer = &pipeline->producers[i];
+		producer->workers = context_allocate(context, problem->worker_count * sizeof(Worker*));
+		producer->parent_genes = context_allocate(context, 2 * CHILD_BATCH_PAIRS * individual_length);
+		allocate_schedule(context, &producer->parents[0], problem->required_workers);
+		allocate_schedule(context, &producer->parents[1], problem->required_workers);
+		allocate_schedule(context, &producer->child, problem->required_workers);
+	}
+	/*Alt i hovedkonteksten bliver allokeret først, så et fejlet kald ikke efterlader avlernes kontekster*/
+	pipeline->pool = task_pool_create(context, options->threads);
+	for (i = 0; i < options->threads; i++) {
+		PipelineProducer* producer = &pipeline->producers[i];
+		unsigned int worker;
+		producer->context = vagtplan_create(&context->allocator, random_next(context));
+		if (producer->context == NULL || vagtplan_copy_workers(producer->context, context) != VAGTPLAN_OK) {
+			vagtplan_destroy(producer->context);
+			task_pool_destroy(context, pipeline->pool);
+			for (worker = 0; worker < i; worker++) {
+				vagtplan_destroy(pipeline->producers[worker].context);
+			}
+			context_fail(context, VAGTPLAN_ERROR_MEMORY, "Ikke nok hukommelse til trådene");
+		}
+		for (worker = 0; worker < problem->worker_count; worker++) {
+			producer->workers[worker] = &producer->context->workers[worker];
+		}
+	}
+
+	pthread_mutex_init(&pipeline->lock, NULL);
+	pthread_cond_init(&pipeline->batch_ready, NULL);
+	for (i = 0; i < pipeline->batch_count; i++) {
+		task_pool_submit(pipeline->pool, 0, &pipeline->batches_group, pipeline_produce, pipeline, i, i + 1, 1);
+	}
+	context_log(context, "Avler børn i %u tråde\n", options->threads);
+	solver->state = pipeline;
+}
+
+void pipeline_produce(void* argument, unsigned int thread, unsigned long begin, unsigned long end) {
+	PipelineState* pipeline = argument;
+	PipelineProducer* producer = &pipeline->producers[thread];
+	ChildBatch* batch = &pipeline->batches[begin];
+	GeneticState* genetic = &pipeline->genetic;
+	VagtplanContext* context = producer->context;
+	RequiredWorkers required_workers = genetic->problem.required_workers;
+	unsigned int elite_size = genetic->options.elite_size;
+	unsigned int children_per_elite = genetic->options.children_per_elite;
+	unsigned int total_slots = required_workers.offsets[21];
+	unsigned int gene_size;
+	size_t individual_length;
+	double parent_scores[CHILD_BATCH_PAIRS];
+	MutationControl mutation;
+	CrossoverControl crossover;
+	unsigned int pair;
+
+	pthread_mutex_lock(&pipeline->lock);
+	if (pipeline->stopping) {
+		pthread_mutex_unlock(&pipeline->lock);
+		return;
+	}
+	/*Hovedtråden bytter populationerne mens låsen holdes, så selv genstørrelsen bliver læst her*/
+	gene_size = genetic->population.gene_size;
+	individual_length = (size_t) total_slots * gene_size;
+	mutation = pipeline->mutation;
+	crossover = pipeline->crossover;
+	/*Forældrene bliver kopieret mens låsen holdes, så hovedtråden kan bytte bufferne når den vil*/
+	for (pair = 0; pair < CHILD_BATCH_PAIRS; pair++) {
+		const Population* front = &genetic->population;
+		unsigned int parent = genetic->ranks[pipeline->next_elite].individual;
+		unsigned int partner = genetic->ranks[random_number(context, elite_size, front->size - elite_size * children_per_elite)].individual;
+		pipeline->next_elite = (pipeline->next_elite + 1) % elite_size;
+		memcpy(producer->parent_genes + 2 * pair * individual_length, front->genes + parent * individual_length, individual_length);
+		memcpy(producer->parent_genes + (2 * pair + 1) * individual_length, front->genes + partner * individual_length, individual_length);
+		parent_scores[pair] = front->scores[parent] > front->scores[partner] ? front->scores[parent] : front->scores[partner];
+	}
+	pthread_mutex_unlock(&pipeline->lock);
+
+	batch->count = 0;
+	for (pair = 0; pair < CHILD_BATCH_PAIRS; pair++) {
+		unsigned int j;
+		decode_genes(producer->parent_genes + 2 * pair * individual_length, gene_size, total_slots, producer->workers, &producer->parents[0]);
+		decode_genes(producer->parent_genes + (2 * pair + 1) * individual_length, gene_size, total_slots, producer->workers, &producer->parents[1]);
+		for (j = 0; j < children_per_elite; j++) {
+			enum CrossoverOperator operator = choose_crossover(context, &crossover);
+			combine_schedule(context, required_workers, &producer->parents[0], &producer->parents[1], &producer->child, &mutation, operator);
+			evaluate_schedule(&producer->child, required_workers, producer->workers, context->worker_count, context->static_scores);
+			encode_genes(&producer->child, gene_size, total_slots, batch->genes + batch->count * individual_length);
+			batch->scores[batch->count] = producer->child.score;
+			batch->operators[batch->count] = (unsigned char) operator;
+			batch->improved[batch->count] = producer->child.score > parent_scores[pair];
+			batch->count++;
+		}
+	}
+
+	pthread_mutex_lock(&pipeline->lock);
+	pipeline->full_batches[(pipeline->full_first + pipeline->full_count) % pipeline->batch_count] = batch;
+	pipeline->full_count++;
+	pthread_cond_signal(&pipeline->batch_ready);
+	pthread_mutex_unlock(&pipeline->lock);
+}
+
+bool pipeline_step(Solver* solver) {
+	PipelineState* pipeline = solver->state;
+	GeneticState* genetic = &pipeline->genetic;
+	VagtplanContext* context = genetic->problem.context;
+	Population* front = &genetic->population;
+	Population* back = &pipeline->back;
+	Worker** workers = genetic->problem.workers;
+	unsigned int worker_count = genetic->problem.worker_count;
+	RequiredWorkers required_workers = genetic->problem.required_workers;
+	size_t individual_length = (size_t) back->total_slots * back->gene_size;
+	unsigned int elite = genetic->options.elite_size;
+	unsigned int filled;
+	PopulationRank* ranks;
+	Population population;
+
+	if (genetic->generation >= genetic->options.generations) {
+		return false;
+	}
+
+	/*Forbufferen bliver kun skrevet af denne tråd, så de overlevende kan kopieres uden lås*/
+	for (filled = 0; filled < front->size - elite * genetic->options.children_per_elite; filled++) {
+		copy_individual(front, genetic->ranks[filled].individual, back, filled);
+	}
+	while (filled < back->size) {
+		ChildBatch* batch = pipeline->pending;
+		if (batch == NULL) {
+			/*Mens der ikke er nogen færdig portion avler hovedtråden selv en af dem der står i kø*/
+			pthread_mutex_lock(&pipeline->lock);
+			while (pipeline->full_count == 0) {
+				bool ran;
+				pthread_mutex_unlock(&pipeline->lock);
+				ran = task_pool_run_one(pipeline->pool, 0);
+				pthread_mutex_lock(&pipeline->lock);
+				if (!ran && pipeline->full_count == 0) {
+					pthread_cond_wait(&pipeline->batch_ready, &pipeline->lock);
+				}
+			}
+			batch = pipeline->full_batches[pipeline->full_first];
+			pipeline->full_first = (pipeline->full_first + 1) % pipeline->batch_count;
+			pipeline->full_count--;
+			pthread_mutex_unlock(&pipeline->lock);
+			pipeline->pending = batch;
+			pipeline->pending_used = 0;
+		}
+		/*En portion kan række ind i næste generation, resten bliver brugt der*/
+		for (; filled < back->size && pipeline->pending_used < batch->count; filled++) {
+			unsigned int child = pipeline->pending_used++;
+			memcpy(back->genes + filled * individual_length, batch->genes + child * individual_length, individual_length);
+			back->scores[filled] = batch->scores[child];
+			record_crossover(&genetic->crossover, batch->operators[child], batch->improved[child]);
+			if (genetic->problem.archive != NULL) {
+				unpack_individual(back, filled, &genetic->child);
+				archive_offer(genetic->problem.archive, &genetic->child);
+			}
+		}
+		if (pipeline->pending_used == batch->count) {
+			unsigned int index = (unsigned int) (batch - pipeline->batches);
+			task_pool_submit(pipeline->pool, 0, &pipeline->batches_group, pipeline_produce, pipeline, index, index + 1, 1);
+			pipeline->pending = NULL;
+		}
+	}
+	update_crossover_control(&genetic->crossover);
+	rank_population(back, pipeline->back_ranks);
+	if (genetic->generation % 1000 == 0) {
+		context_log(context, "Generation nummer %u. Max fitness er %f, værste: %f, gab: %f, mutation: %.2f på %u blokke, crossover: %.2f %.2f %.2f %.2f\n", genetic->generation, pipeline->back_ranks[0].score, pipeline->back_ranks[back->size - 1].score, genetic->problem.upper_bound - pipeline->back_ranks[0].score, genetic->mutation.probability, genetic->mutation.blocks, genetic->crossover.probabilities[0], genetic->crossover.probabilities[1], genetic->crossover.probabilities[2], genetic->crossover.probabilities[3]);
+	}
+	if (update_mutation_control(&genetic->mutation, pipeline->back_ranks[0].score, population_diversity(context, back, required_workers))) {
+		inject_immigrants(context, back, pipeline->back_ranks, elite, pipeline->back_ranks[0].individual, &genetic->child, workers, worker_count, required_workers);
+		rank_population(back, pipeline->back_ranks);
+	}
+
+	/*Den nye generation bliver forbufferen, og avlerne får de nye sandsynligheder med næste portion*/
+	pthread_mutex_lock(&pipeline->lock);
+	population = *front;
+	*front = *back;
+	*back = population;
+	ranks = genetic->ranks;
+	genetic->ranks = pipeline->back_ranks;
+	pipeline->back_ranks = ranks;
+	genetic->best = genetic->ranks[0].individual;
+	pipeline->mutation = genetic->mutation;
+	pipeline->crossover = genetic->crossover;
+	pthread_mutex_unlock(&pipeline->lock);
+	genetic->generation++;
+	return true;
+}
+
+void pipeline_immigrate(Solver* solver, const Schedule* migrant) {
+	PipelineState* pipeline = solver->state;
+	pthread_mutex_lock(&pipeline->lock);
+	genetic_immigrate(solver, migrant);
+	pthread_mutex_unlock(&pipeline->lock);
+}
+
+Schedule pipeline_stop(Solver* solver) {
+	PipelineState* pipeline = solver->state;
+	VagtplanContext* context = pipeline->genetic.problem.context;
+	unsigned int i;
+
+	/*Portioner der stadig står i kø bliver sprunget over, så der kun ventes på dem der er i gang*/
+	pthread_mutex_lock(&pipeline->lock);
+	pipeline->stopping = true;
+	pthread_mutex_unlock(&pipeline->lock);
+	task_pool_join(pipeline->pool, 0, &pipeline->batches_group);
+	task_pool_destroy(context, pipeline->pool);
+	pthread_mutex_destroy(&pipeline->lock);
+	pthread_cond_destroy(&pipeline->batch_ready);
+	for (i = 0; i < pipeline->producer_count; i++) {
+		vagtplan_destroy(pipeline->producers[i].context);
+		context_free(context, pipeline->producers[i].workers);
+		context_free(context, pipeline->producers[i].parent_genes);
+		free_schedule(context, &pipeline->producers[i].parents[0]);
+		free_schedule(context, &pipeline->producers[i].parents[1]);
+		free_schedule(context, &pipeline->producers[i].child);
+	}
+	for (i = 0; i < pipeline->batch_count; i++) {
+		context_free(context, pipeline->batches[i].genes);
+		context_free(context, pipeline->batches[i].scores);
+		context_free(context, pipeline->batches[i].operators);
+		context_free(context, pipeline->batches[i].improved);
+	}
+	context_free(context, pipeline->producers);
+	context_free(context, pipeline->batches);
+	context_free(context, pipeline->full_batches);
+	context_free(context, pipeline->back_ranks);
+	free_population(context, &pipeline->back);
+	/*genetic ligger først i tilstanden, så genetic_stop frigiver resten og selve tilstanden*/
+	return genetic_stop(solver);
+}
+#endif
+
+void load_seed_schedule(VagtplanContext* context, FILE* file, Worker* workers[], unsigned int worker_count, RequiredWorkers required_workers, const WorkerDirectory* directory, Schedule* out) {
+	RequiredWorkers seed_required;
+	Schedule seed;
+	unsigned int unknown_workers = 0;
+	unsigned int block;
+
+	seed = read_schedule_lenient(context, file, &seed_required, workers, worker_count, directory, &unknown_workers);
+
+	/*Den tilfældige vagtplan giver hukommelsen, og bliver derefter overskrevet med startvagtplanen*/
+	generate_random_schedule(context, required_workers, out);
+	for (block = 0; block < 21; block++) {
+		unsigned int needed = required_for_block(&required_workers, block);
+		unsigned int available = required_for_block(&seed_required, block);
+		Worker** seed_block = seed.workers + seed_required.offsets[block];
+		Worker** out_block = out->workers + required_workers.offsets[block];
+		unsigned int filled = 0;
+		unsigned int i;
+
+		context->pools.stamp++;
+		for (i = 0; i < available && filled < needed; i++) {
+			Worker* worker = seed_block[i];
+			if (worker != NULL && !block_contains(out_block, filled, worker) && !(worker->forbidden_blocks & (1UL << block))) {
+				out_block[filled] = worker;
+				context->pools.stamps[worker->id] = context->pools.stamp;
+				filled++;
+			}
+		}
+		/*Pladser til fjernede medarbejdere, medarbejdere med fravær eller ekstra pladser bliver fyldt
+		fra blokkens pulje med nogen der ikke allerede er på blokken*/
+		while (filled < needed) {
+			Worker* worker = pool_draw(context, block * POOL_KINDS);
+			if (worker == NULL) {
+				context_fail(context, VAGTPLAN_ERROR_INFEASIBLE, "Ikke nok medarbejdere til at lave en valid plan for en dag");
+			}
+			out_block[filled] = worker;
+			filled++;
+		}
+	}
+	free_schedule(context, &seed);
+
+	if (unknown_workers > 0) {
+		context_log(context, "%u pladser i startvagtplanen havde medarbejdere som ikke findes længere, de er blevet erstattet\n", unknown_workers);
+	}
+}
+
+const Schedule* best_seed(const SolverProblem* problem) {
+	const Schedule* best = NULL;
+	unsigned int i;
+	for (i = 0; i < problem->seed_count; i++) {
+		if (best == NULL || problem->seeds[i].score > best->score) {
+			best = &problem->seeds[i];
+		}
+	}
+	return best;
+}
+
+void copy_schedule(const Schedule* from, Schedule* to, RequiredWorkers required_workers) {
+	memcpy(to->workers, from->workers, required_workers.offsets[21] * sizeof(Worker*));
+	to->score = from->score;
+}
+
+void allocate_schedule(VagtplanContext* context, Schedule* schedule, RequiredWorkers required_workers) {
+	schedule->workers = context_allocate(context, required_workers.offsets[21] * sizeof(Worker*));
+	schedule->score = 0;
+}
+
+unsigned int find_worker_index(Worker** workers, unsigned int worker_count, const Worker* worker) {
+	unsigned int i;
+	for (i = 0; i < worker_count; i++) {
+		if (workers[i] == worker) {
+			return i;
+		}
+	}
+	program_error("Program fejl6");
+	return 0;
+}
+
+bool block_contains(Worker** block, unsigned int count, const Worker* worker) {
+	unsigned int i;
+	for (i = 0; i < count; i++) {
+		if (block[i] == worker) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void archive_init(ScheduleArchive* archive, VagtplanContext* context, RequiredWorkers required_workers, unsigned int capacity, unsigned int min_distance) {
+	unsigned int i;
+	archive->context = context;
+	archive->required_workers = required_workers;
+	archive->capacity = capacity;
+	archive->count = 0;
+	archive->min_distance = min_distance;
+	archive->total_slots = required_workers.offsets[21];
+	archive->schedules = context_allocate(context, capacity * sizeof(Schedule));
+	archive->hashes = context_allocate(context, capacity * sizeof(unsigned long));
+	archive->keys = context_allocate(context, (capacity + 1) * sizeof(unsigned long*));
+	for (i = 0; i < capacity; i++) {
+		allocate_schedule(context, &archive->schedules[i], required_workers);
+	}
+	for (i = 0; i <= capacity; i++) {
+		archive->keys[i] = context_allocate(context, archive->total_slots * sizeof(unsigned long));
+	}
+}
+
+void archive_offer(ScheduleArchive* archive, const Schedule* schedule) {
+	unsigned long* keys;
+	unsigned long hash = 2166136261UL;
+	unsigned int min_distance;
+	unsigned int position;
+	unsigned int block;
+	unsigned int slot = 0;
+	unsigned int i;
+
+	if (archive == NULL || (archive->count == archive->capacity && schedule->score <= archive->schedules[archive->count - 1].score)) {
+		return;
+	}
+
+	keys = archive->keys[archive->capacity];
+	for (block = 0; block < 21; block++) {
+		for (; slot < archive->required_workers.offsets[block + 1]; slot++) {
+			keys[slot] = ((unsigned long) block << 16) | schedule->workers[slot]->id;
+		}
+	}
+	qsort(keys, archive->total_slots, sizeof(unsigned long), compare_assignment_keys);
+	for (i = 0; i < archive->total_slots; i++) {
+		hash = ((hash ^ keys[i]) * 16777619UL) & 0xFFFFFFFFUL;
+	}
+
+	/*To ens vagtplaner har afstanden 0, så uden en mindste afstand er det nok at sammenligne dem med samme hash*/
+	min_distance = archive->min_distance > 1 ? archive->min_distance : 1;
+	for (i = 0; i < archive->count; i++) {
+		if (min_distance == 1 && archive->hashes[i] != hash) {
+			continue;
+		}
+		if (archive_distance(archive->keys[i], keys, archive->total_slots) < min_distance && archive->schedules[i].score >= schedule->score) {
+			return;
+		}
+	}
+	/*De dårligere vagtplaner der ligger for tæt på bliver fjernet, de er alle dårligere end den nye*/
+	i = 0;
+	while (i < archive->count) {
+		if ((min_distance > 1 || archive->hashes[i] == hash) && archive_distance(archive->keys[i], keys, archive->total_slots) < min_distance) {
+			archive_move(archive, i, archive->count - 1);
+			archive->count--;
+		} else {
+			i++;
+		}
+	}
+
+	/*Den nye vagtplan bliver lagt på den første ledige plads, eller over den dårligste, og flyttet op på plads*/
+	position = archive->count < archive->capacity ? archive->count : archive->capacity - 1;
+	copy_schedule(schedule, &archive->schedules[position], archive->required_workers);
+	archive->hashes[position] = hash;
+	archive->keys[archive->capacity] = archive->keys[position];
+	archive->keys[position] = keys;
+	if (archive->count < archive->capacity) {
+		archive->count++;
+	}
+	i = position;
+	while (i > 0 && archive->schedules[i - 1].score < schedule->score) {
+		i--;
+	}
+	archive_move(archive, position, i);
+}
+
+unsigned int archive_distance(const unsigned long* a, const unsigned long* b, unsigned int length) {
+	unsigned int same = 0;
+	unsigned int i = 0;
+	unsigned int j = 0;
+	while (i < length && j < length) {
+		if (a[i] == b[j]) {
+			same++;
+			i++;
+			j++;
+		} else if (a[i] < b[j]) {
+			i++;
+		} else {
+			j++;
+		}
+	}
+	return length - same;
+}
+
+void archive_move(ScheduleArchive* archive, unsigned int from, unsigned int to) {
+	Schedule schedule = archive->schedules[from];
+	unsigned long hash = archive->hashes[from];
+	unsigned long* keys = archive->keys[from];
+	unsigned int i;
+	for (i = from; i < to; i++) {
+		archive->schedules[i] = archive->schedules[i + 1];
+		archive->hashes[i] = archive->hashes[i + 1];
+		archive->keys[i] = archive->keys[i + 1];
+	}
+	for (i = from; i > to; i--) {
+		archive->schedules[i] = archive->schedules[i - 1];
+		archive->hashes[i] = archive->hashes[i - 1];
+		archive->keys[i] = archive->keys[i - 1];
+	}
+	archive->schedules[to] = schedule;
+	archive->hashes[to] = hash;
+	archive->keys[to] = keys;
+}
+
+void archive_finish(ScheduleArchive* archive, Worker** workers, unsigned int worker_count) {
+	unsigned int i;
+	for (i = 0; i < archive->count; i++) {
+		evaluate_schedule(&archive->schedules[i], archive->required_workers, workers, worker_count, archive->context->static_scores);
+	}
+	for (i = 1; i < archive->count; i++) {
+		unsigned int j = i;
+		while (j > 0 && archive->schedules[j - 1].score < archive->schedules[i].score) {
+			j--;
+		}
+		archive_move(archive, i, j);
+	}
+	for (i = archive->count; i < archive->capacity; i++) {
+		free_schedule(archive->context, &archive->schedules[i]);
+	}
+	for (i = 0; i <= archive->capacity; i++) {
+		context_free(archive->context, archive->keys[i]);
+	}
+	context_free(archive->context, archive->keys);
+	context_free(archive->context, archive->hashes);
+}
+
+int compare_assignment_keys(const void* a, const void* b) {
+	unsigned long ka = *(const unsigned long*) a;
+	unsigned long kb = *(const unsigned long*) b;
+	return ka < kb ? -1 : ka > kb;
+}
+
+void compare_evaluators(VagtplanContext* context, RequiredWorkers required_workers, unsigned long schedule_count, VagtplanEvaluatorCheck* results) {
+	unsigned int worker_count = context->worker_count;
+	Worker** workers = context_worker_array(context);
+	Schedule* batch = context_allocate(context, CHECK_BATCH_SIZE * sizeof(Schedule));
+	double* expected = context_allocate(context, CHECK_BATCH_SIZE * sizeof(double));
+	double* actual = context_allocate(context, (CHECK_BATCH_SIZE + 1) * sizeof(double));
+	LocalSearchMove* moves = context_allocate(context, CHECK_BATCH_SIZE * sizeof(LocalSearchMove));
+	unsigned long* occupancy = context_allocate(context, worker_count * sizeof(unsigned long));
+	int* scratch = context_allocate(context, 3 * worker_count * sizeof(int));
+	LocalSearchState* walk = context_allocate(context, sizeof(LocalSearchState));
+	double seconds[VAGTPLAN_EVALUATOR_COUNT];
+	unsigned int max_required = 0;
+	unsigned long done = 0;
+	SolverProblem problem;
+	SolverOptions options;
+	Solver solver;
+	Schedule replay;
+	double start;
+	unsigned int block;
+	unsigned int i;
+	unsigned int j;
+
+	for (i = 0; i < VAGTPLAN_EVALUATOR_COUNT; i++) {
+		results[i].evaluations = 0;
+		results[i].mismatches = 0;
+		results[i].evaluations_per_second = 0;
+		seconds[i] = 0;
+	}
+	results[0].name = "reference";
+	results[1].name = "evaluate_schedule";
+	results[2].name = "score_worker_blocks";
+	results[3].name = "lokalsøgning";
+	for (block = 0; block < 21; block++) {
+		if (required_for_block(&required_workers, block) > max_required) {
+			max_required = required_for_block(&required_workers, block);
+		}
+	}
+	for (i = 0; i < CHECK_BATCH_SIZE; i++) {
+		allocate_schedule(context, &batch[i], required_workers);
+	}
+	allocate_schedule(context, &replay, required_workers);
+
+	/*Lokalsøgningen går tilfældigt rundt fra starten af hver portion og bruger sin egen medarbejder array*/
+	problem.context = context;
+	problem.workers = workers;
+	problem.worker_count = worker_count;
+	problem.required_workers = required_workers;
+	problem.upper_bound = 0;
+	problem.seeds = NULL;
+	problem.seed_count = 0;
+	problem.archive = NULL;
+	vagtplan_default_options(&options);
+	local_search_init(walk, &problem, &options);
+
+	while (done < schedule_count) {
+		unsigned int size = schedule_count - done < CHECK_BATCH_SIZE ? (unsigned int) (schedule_count - done) : CHECK_BATCH_SIZE;
+		/*Hver anden portion er modstandere, hvor så få medarbejdere dækker alle blokkene at de ofte står på blokke lige efter hinanden*/
+		bool narrow = (done / CHECK_BATCH_SIZE) % 2 == 1;
+		for (i = 0; i < size; i++) {
+			unsigned int pool_size = narrow ? max_required + random_number(context, 0, 3) : worker_count;
+			fill_check_schedule(context, workers, worker_count, required_workers, pool_size < worker_count ? pool_size : worker_count, &batch[i]);
+		}
+
+		start = wall_seconds();
+		for (i = 0; i < size; i++) {
+			expected[i] = reference_evaluate_schedule(&batch[i], required_workers, context->workers, worker_count, scratch);
+		}
+		seconds[0] += wall_seconds() - start;
+		results[0].evaluations += size;
+
+		start = wall_seconds();
+		for (i = 0; i < size; i++) {
+			actual[i] = evaluate_schedule(&batch[i], required_workers, workers, worker_count, context->static_scores);
+		}
+		seconds[1] += wall_seconds() - start;
+		for (i = 0; i < size; i++) {
+			check_evaluator_result(context, &results[1], expected[i], actual[i]);
+		}
+
+		start = wall_seconds();
+		for (i = 0; i < size; i++) {
+			double score = 0;
+			memset(occupancy, 0, worker_count * sizeof(unsigned long));
+			for (block = 0; block < 21; block++) {
+				for (j = required_workers.offsets[block]; j < required_workers.offsets[block + 1]; j++) {
+					occupancy[batch[i].workers[j]->id] |= 1UL << block;
+				}
+			}
+			for (j = 0; j < worker_count; j++) {
+				score += score_worker_blocks(&context->workers[j], occupancy[j], context->static_scores);
+			}
+			actual[i] = score + score_skill_coverage(&batch[i], &required_workers);
+		}
+		seconds[2] += wall_seconds() - start;
+		for (i = 0; i < size; i++) {
+			check_evaluator_result(context, &results[2], expected[i], actual[i]);
+		}
+
+		/*Trækkene bliver gemt og spillet igen bagefter, så referencen ikke bliver timet med*/
+		copy_schedule(&batch[0], &walk->current, required_workers);
+		copy_schedule(&batch[0], &replay, required_workers);
+		start = wall_seconds();
+		local_search_index(walk);
+		actual[0] = walk->current.score;
+		for (i = 0; i < size; i++) {
+			if (!local_search_random_move(walk, &moves[i])) {
+				break;
+			}
+			local_search_apply_move(walk, &moves[i]);
+			actual[i + 1] = walk->current.score;
+		}
+		seconds[3] += wall_seconds() - start;
+		check_evaluator_result(context, &results[3], expected[0], actual[0]);
+		for (j = 0; j < i; j++) {
+			replay.workers[required_workers.offsets[moves[j].block] + moves[j].slot] = walk->problem.workers[moves[j].new_worker];
+			check_evaluator_result(context, &results[3], reference_evaluate_schedule(&replay, required_workers, context->workers, worker_count, scratch), actual[j + 1]);
+		}
+		done += size;
+	}
+
+	for (i = 0; i < VAGTPLAN_EVALUATOR_COUNT; i++) {
+		if (seconds[i] > 0) {
+			results[i].evaluations_per_second = results[i].evaluations / seconds[i];
+		}
+	}
+
+	solver.state = walk;
+	free_schedule(context, &replay);
+	replay = local_search_stop(&solver);
+	free_schedule(context, &replay);
+	for (i = 0; i < CHECK_BATCH_SIZE; i++) {
+		free_schedule(context, &batch[i]);
+	}
+	context_free(context, batch);
+	context_free(context, expected);
+	context_free(context, actual);
+	context_free(context, moves);
+	context_free(context, occupancy);
+	context_free(context, scratch);
+	context_free(context, workers);
+}
+
+void fill_check_schedule(VagtplanContext* context, Worker** workers, unsigned int worker_count, RequiredWorkers required_workers, unsigned int pool_size, Schedule* schedule) {
+	unsigned int block;
+	unsigned int i;
+	Worker* tmp;
+
+	for (i = 0; i < pool_size; i++) {
+		unsigned int other = random_number(context, i, worker_count);
+		tmp = workers[i];
+		workers[i] = workers[other];
+		workers[other] = tmp;
+	}
+	/*Hver blok tager de første fra en delvis blanding af puljen, så de er forskellige*/
+	for (block = 0; block < 21; block++) {
+		unsigned int needed = required_for_block(&required_workers, block);
+		for (i = 0; i < needed; i++) {
+			unsigned int other = random_number(context, i, pool_size);
+			tmp = workers[i];
+			workers[i] = workers[other];
+			workers[other] = tmp;
+			schedule->workers[required_workers.offsets[block] + i] = workers[i];
+		}
+	}
+}
+
+double reference_evaluate_schedule(const Schedule* schedule, RequiredWorkers required_workers, const Worker* workers, unsigned int worker_count, int* scratch) {
+	int* last_block = scratch;
+	int* night_streak = scratch + worker_count;
+	int* had_day_off = scratch + 2 * worker_count;
+	double score = 0;
+	int block;
+	unsigned int i;
+	unsigned int skill;
+
+	for (i = 0; i < worker_count; i++) {
+		last_block[i] = -1;
+		night_streak[i] = 0;
+		had_day_off[i] = 0;
+	}
+
+	for (block = 0; block < 21; block++) {
+		int day = block / 3;
+		int shift = block % 3;
+		for (i = required_workers.offsets[block]; i < required_workers.offsets[block + 1]; i++) {
+			unsigned int id = schedule->workers[i]->id;
+			const Worker* worker = &workers[id];
+			int previous = last_block[id];
+
+			if (worker->desired_shift == shift) {
+				score += 1;
+			}
+			if (worker->desired_day_off == day) {
+				score -= 2;
+			}
+			/*Fravær fra fraværsfilen*/
+			if ((worker->forbidden_blocks >> block) & 1) {
+				score -= 1000;
+			}
+			/*Mindst 11 timers hvile, altså to blokke fri mellem to vagter*/
+			if (previous >= 0 && block - previous <= 2) {
+				score -= 1000;
+			}
+			/*Vagten dagen efter må ikke ligge præcis 5 blokke efter den forrige*/
+			if (previous >= 0 && day - previous / 3 == 1 && block - previous == 5) {
+				score -= 1000;
+			}
+			/*Højst to nattevagter i træk*/
+			if (shift == SHIFT_NIGHT && previous >= 0 && previous == block - 3) {
+				if (night_streak[id] >= 2) {
+					score -= 1000;
+				}
+				night_streak[id]++;
+			} else if (shift == SHIFT_NIGHT) {
+				night_streak[id] = 1;
+			} else {
+				night_streak[id] = 0;
+			}
+			/*Mere end 5 blokke uden vagt er et fridøgn, også fra starten af ugen*/
+			if (block - previous > 5) {
+				had_day_off[id] = 1;
+			}
+			last_block[id] = block;
+		}
+		/*Hver medarbejder der mangler med en kvalifikation koster 1000*/
+		for (skill = 0; skill < VAGTPLAN_SKILL_COUNT; skill++) {
+			int have = 0;
+			for (i = required_workers.offsets[block]; i < required_workers.offsets[block + 1]; i++) {
+				if (workers[schedule->workers[i]->id].skills & (1 << skill)) {
+					have++;
+				}
+			}
+			if (have < required_workers.skills[block][skill]) {
+				score -= 1000 * (required_workers.skills[block][skill] - have);
+			}
+		}
+	}
+
+	/*En medarbejder der har arbejdet skal have et fridøgn, eller have fri efter sin sidste vagt*/
+	for (i = 0; i < worker_count; i++) {
+		if (last_block[i] >= 0 && !had_day_off[i] && !(last_block[i] > 0 && 21 - last_block[i] > 5)) {
+			score -= 1000;
+		}
+	}
+	return score;
+}
+
+void check_evaluator_result(VagtplanContext* context, VagtplanEvaluatorCheck* result, double expected, double actual) {
+	result->evaluations++;
+	if (fabs(expected - actual) < 1e-6) {
+		return;
+	}
+	result->mismatches++;
+	if (result->mismatches <= CHECK_MAX_REPORTED) {
+		context_log(context, "%s gav %f, referencen gav %f\n", result->name, actual, expected);
+	}
+}
+
+#ifdef ISLANDS_SUPPORTED
+void* map_shared_segment(VagtplanContext* context, size_t size) {
+	char segment_name[64];
+	int segment_fd;
+	void* segment;
+
+	sprintf(segment_name, "/vagtplanlaegger-%ld", (long) getpid());
+	segment_fd = shm_open(segment_name, O_CREAT | O_EXCL | O_RDWR, 0600);
+	if (segment_fd < 0) {
+		context_fail(context, VAGTPLAN_ERROR_SYSTEM, "Kunne ikke lave det delte hukommelsessegment");
+	}
+	if (ftruncate(segment_fd, size) != 0) {
+		close(segment_fd);
+		shm_unlink(segment_name);
+		context_fail(context, VAGTPLAN_ERROR_SYSTEM, "Kunne ikke lave det delte hukommelsessegment");
+	}
+	segment = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, segment_fd, 0);
+	close(segment_fd);
+	/*Navnet bliver fjernet med det samme, segmentet lever videre så længe nogen har det mappet*/
+	shm_unlink(segment_name);
+	if (segment == MAP_FAILED) {
+		context_fail(context, VAGTPLAN_ERROR_SYSTEM, "Kunne ikke mappe det delte hukommelsessegment");
+	}
+	memset(segment, 0, size);
+	return segment;
+}
+
+Schedule island_schedule(const SolverProblem* problem, const SolverOptions* options) {
+	VagtplanContext* context = problem->context;
+	unsigned int total_slots = problem->required_workers.offsets[21];
+	unsigned int island;
+	unsigned int i;
+	size_t slot_size;
+	size_t segment_size;
+	IslandSegment* segment;
+	SolverProblem island_problem = *problem;
+	Worker** stable_workers;
+	unsigned short* buffer;
+	pid_t* children;
+	Schedule rv;
+	Schedule candidate;
+	double best_score = -HUGE_VAL;
+	double published = -HUGE_VAL;
+	struct timespec watch_interval;
+
+	if (problem->worker_count > 65535) {
+		context_fail(context, VAGTPLAN_ERROR_ARGUMENT, "For mange medarbejdere til øerne");
+	}
+	allocate_schedule(context, &rv, problem->required_workers);
+	allocate_schedule(context, &candidate, problem->required_workers);
+	/*Hver plads i segmentet er en header efterfulgt af medarbejdernes index, rundet op så headeren altid er justeret*/
+	slot_size = sizeof(MigrantHeader) + total_slots * sizeof(unsigned short);
+	slot_size = (slot_size + sizeof(double) - 1) / sizeof(double) * sizeof(double);
+	segment_size = sizeof(IslandSegment) + (size_t) options->islands * MIGRANTS_PER_ISLAND * slot_size;
+
+	segment = map_shared_segment(context, segment_size);
+	segment->island_count = options->islands;
+	segment->total_slots = total_slots;
+	segment->slot_size = slot_size;
+
+	/*Den kompakte form gemmer medarbejdernes id, og denne kopi står i id rækkefølge, da motorerne bytter
+	rundt på deres egen medarbejder array*/
+	stable_workers = context_allocate(context, problem->worker_count * sizeof(Worker*));
+	buffer = context_allocate(context, total_slots * sizeof(unsigned short));
+	children = context_allocate(context, options->islands * sizeof(pid_t));
+	for (i = 0; i < problem->worker_count; i++) {
+		stable_workers[problem->workers[i]->id] = problem->workers[i];
+	}
+
+	context_log(context, "Starter %u øer\n", options->islands);
+	/*Ellers bliver det der ligger i bufferen skrevet en gang for hver ø*/
+	if (context->log != NULL) {
+		fflush(context->log);
+	}
+	for (island = 0; island < options->islands; island++) {
+		children[island] = fork();
+		if (children[island] < 0) {
+			/*Øerne der allerede kører bliver stoppet, så der ikke ligger nogen tilbage*/
+			unsigned int started;
+			segment->stop_requested = 1;
+			for (started = 0; started < island; started++) {
+				waitpid(children[started], NULL, 0);
+			}
+			munmap(segment, segment_size);
+			context_fail(context, VAGTPLAN_ERROR_SYSTEM, "Kunne ikke starte en ø");
+		}
+		if (children[island] == 0) {
+			/*En fejl i en ø må ikke hoppe tilbage ind i koordinatorens kald*/
+			if (setjmp(context->error_jump) != 0) {
+				_exit(EXIT_FAILURE);
+			}
+			/*Øens arkiv ville forsvinde med processen, så alternativerne bliver taget fra pladserne bagefter*/
+			island_problem.archive = NULL;
+			island_run(segment, island, &island_problem, options, stable_workers);
+			if (context->log != NULL) {
+				fflush(context->log);
+			}
+			_exit(EXIT_SUCCESS);
+		}
+	}
+
+	/*Koordinatoren venter på alle øerne, hvis en ø dør bliver dens sidst udgivne individer stadig brugt.
+	Holder nogen øje med fremskridtet ser den efter øerne imens*/
+	watch_interval.tv_sec = 0;
+	watch_interval.tv_nsec = ISLAND_WATCH_NANOSECONDS;
+	for (island = 0; island < options->islands; island++) {
+		int status;
+		pid_t waited;
+		if (options->progress != NULL) {
+			while ((waited = waitpid(children[island], &status, WNOHANG)) == 0) {
+				island_watch(segment, options->progress, buffer, stable_workers, problem, &candidate, &published);
+				nanosleep(&watch_interval, NULL);
+			}
+		} else {
+			waited = waitpid(children[island], &status, 0);
+		}
+		if (waited < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+			context_log(context, "Ø %u stoppede uventet, fortsætter med de andre øer\n", island);
+		}
+	}
+
+	for (island = 0; island < options->islands; island++) {
+		unsigned int slot;
+		for (slot = 0; slot < MIGRANTS_PER_ISLAND; slot++) {
+			double score;
+			unsigned int generation;
+			if (!island_read(segment, island, slot, buffer, &score, &generation)) {
+				continue;
+			}
+			island_decode(context, buffer, stable_workers, problem->worker_count, problem->required_workers, &candidate);
+			candidate.score = score;
+			archive_offer(problem->archive, &candidate);
+			if (score > best_score) {
+				copy_schedule(&candidate, &rv, problem->required_workers);
+				best_score = score;
+			}
+		}
+	}
+	free_schedule(context, &candidate);
+	munmap(segment, segment_size);
+	if (best_score == -HUGE_VAL) {
+		context_fail(context, VAGTPLAN_ERROR_SYSTEM, "Ingen af øerne udgav en vagtplan");
+	}
+	evaluate_schedule(&rv, problem->required_workers, stable_workers, problem->worker_count, context->static_scores);
+	context_log(context, "Den bedste vagtplan fra øerne har en score på %f\n", rv.score);
+
+	context_free(context, stable_workers);
+	context_free(context, buffer);
+	context_free(context, children);
+	return rv;
+}
+
+void island_run(IslandSegment* segment, unsigned int island, const SolverProblem* problem, const SolverOptions* options, Worker** stable_workers) {
+	VagtplanContext* context = problem->context;
+	Solver solver;
+	Schedule migrant;
+	unsigned int* seen_generation = context_allocate_zero(context, segment->island_count * MIGRANTS_PER_ISLAND, sizeof(unsigned int));
+	unsigned short* buffer = context_allocate(context, segment->total_slots * sizeof(unsigned short));
+	unsigned int next_slot = 0;
+	unsigned int step = 0;
+	double deadline = options->time_limit > 0 ? wall_seconds() + options->time_limit : 0;
+
+	/*Hver ø har sin egen kopi af konteksten efter fork, så de skal ikke alle trække de samme tal*/
+	context->random_state = (context->random_state ^ (unsigned long) time(NULL) ^ ((unsigned long) getpid() << 8)) & 0xFFFFFFFFUL;
+	if (context->random_state == 0) {
+		context->random_state = 0x9E3779B9UL;
+	}
+	allocate_schedule(context, &migrant, problem->required_workers);
+
+	select_solver(&solver, options);
+	solver.init(&solver, problem, options);
+	while (solver.step(&solver)) {
+		step++;
+		if (solver.best(&solver)->score >= problem->upper_bound) {
+			/*De andre øer kan heller ikke finde noget bedre*/
+			segment->stop_requested = 1;
+		}
+		if (deadline > 0 && wall_seconds() >= deadline) {
+			segment->stop_requested = 1;
+		}
+		if (segment->stop_requested) {
+			break;
+		}
+		if (step % MIGRATION_INTERVAL != 0) {
+			continue;
+		}
+
+		/*Udgiver den bedste, pladserne bliver brugt i ring så de andre øer kan nå at læse dem*/
+		island_publish(segment, island, next_slot, solver.best(&solver), problem->required_workers, step);
+		next_slot = (next_slot + 1) % MIGRANTS_PER_ISLAND;
+
+		island_immigrate(&solver, segment, island, seen_generation, buffer, &migrant, stable_workers, problem);
+	}
+
+	island_publish(segment, island, next_slot, solver.best(&solver), problem->required_workers, step + 1);
+	migrant = solver.stop(&solver);
+	free_schedule(context, &migrant);
+	context_free(context, seen_generation);
+	context_free(context, buffer);
+}
+
+void island_watch(IslandSegment* segment, VagtplanProgress* progress, unsigned short* buffer, Worker** stable_workers, const SolverProblem* problem, Schedule* candidate, double* published) {
+	unsigned int island;
+	if (progress->stop_requested) {
+		segment->stop_requested = 1;
+	}
+	for (island = 0; island < segment->island_count; island++) {
+		unsigned int slot;
+		for (slot = 0; slot < MIGRANTS_PER_ISLAND; slot++) {
+			unsigned int generation;
+			if (!island_read(segment, island, slot, buffer, &candidate->score, &generation) || candidate->score <= *published) {
+				continue;
+			}
+			island_decode(problem->context, buffer, stable_workers, problem->worker_count, problem->required_workers, candidate);
+			progress_publish(progress, candidate, generation);
+			*published = candidate->score;
+		}
+	}
+}
+
+void island_immigrate(Solver* solver, IslandSegment* segment, unsigned int island, unsigned int* seen_generation, unsigned short* buffer, Schedule* migrant, Worker** stable_workers, const SolverProblem* problem) {
+	unsigned int other;
+	for (other = 0; other < segment->island_count; other++) {
+		unsigned int slot;
+		if (other == island) {
+			continue;
+		}
+		for (slot = 0; slot < MIGRANTS_PER_ISLAND; slot++) {
+			unsigned int generation;
+			unsigned int* seen = &seen_generation[other * MIGRANTS_PER_ISLAND + slot];
+			if (!island_read(segment, other, slot, buffer, &migrant->score, &generation) || generation <= *seen) {
+				continue;
+			}
+			*seen = generation;
+			island_decode(problem->context, buffer, stable_workers, problem->worker_count, problem->required_workers, migrant);
+			solver->immigrate(solver, migrant);
+		}
+	}
+}
+
+MigrantHeader* island_slot(IslandSegment* segment, unsigned int island, unsigned int slot) {
+	unsigned char* slots = (unsigned char*) (segment + 1);
+	return (MigrantHeader*) (slots + (island * MIGRANTS_PER_ISLAND + slot) * segment->slot_size);
+}
+
+void island_publish(IslandSegment* segment, unsigned int island, unsigned int slot, const Schedule* schedule, RequiredWorkers required_workers, unsigned int generation) {
+	MigrantHeader* header = island_slot(segment, island, slot);
+	unsigned short* indices = (unsigned short*) (header + 1);
+	unsigned int position;
+
+	/*Seqlock, kun øen selv skriver i sine pladser. Et ulige tal betyder at pladsen er ved at blive skrevet*/
+	header->sequence++;
+	__sync_synchronize();
+	for (position = 0; position < required_workers.offsets[21]; position++) {
+		indices[position] = schedule->workers[position]->id;
+	}
+	header->score = schedule->score;
+	header->generation = generation;
+	__sync_synchronize();
+	header->sequence++;
+}
+
+bool island_read(IslandSegment* segment, unsigned int island, unsigned int slot, unsigned short* buffer, double* score, unsigned int* generation) {
+	MigrantHeader* header = island_slot(segment, island, slot);
+	unsigned int before = header->sequence;
+	__sync_synchronize();
+	/*0 er en plads der aldrig er skrevet, ulige er en plads der er ved at blive skrevet*/
+	if (before == 0 || (before & 1) != 0) {
+		return false;
+	}
+	memcpy(buffer, (unsigned short*) (header + 1), segment->total_slots * sizeof(unsigned short));
+	*score = header->score;
+	*generation = header->generation;
+	__sync_synchronize();
+	return header->sequence == before;
+}
+
+void island_decode(VagtplanContext* context, const unsigned short* buffer, Worker** stable_workers, unsigned int worker_count, RequiredWorkers required_workers, Schedule* out) {
+	unsigned int position;
+	for (position = 0; position < required_workers.offsets[21]; position++) {
+		if (buffer[position] >= worker_count) {
+			context_fail(context, VAGTPLAN_ERROR_SYSTEM, "Forkert index i det delte hukommelsessegment");
+		}
+		out->workers[position] = stable_workers[buffer[position]];
+	}
+}
+#endif
+
+unsigned int tournament_select(VagtplanContext* context, const double* scores, unsigned int population_size, unsigned int tournament_size) {
+	unsigned int winner = random_number(context, 0, population_size);
+	unsigned int i;
+	for (i = 1; i < tournament_size; i++) {
+		unsigned int challenger = random_number(context, 0, population_size);
+		if (scores[challenger] > scores[winner]) {
+			winner = challenger;
+		}
+	}
+	return winner;
+}
+
+unsigned int tournament_select_loser(VagtplanContext* context, const double* scores, unsigned int population_size, unsigned int tournament_size, unsigned int protected_index) {
+	unsigned int loser;
+	unsigned int i;
+	do {
+		loser = random_number(context, 0, population_size);
+	} while (loser == protected_index);
+
+	for (i = 1; i < tournament_size; i++) {
+		unsigned int challenger = random_number(context, 0, population_size);
+		if (challenger != protected_index && scores[challenger] < scores[loser]) {
+			loser = challenger;
+		}
+	}
+	return loser;
+}
+
+Schedule exact_schedule(VagtplanContext* context, Worker* workers[], unsigned int worker_count, RequiredWorkers required_workers, double upper_bound, const Schedule* incumbent) {
+	ExactSearch search;
+	unsigned int block;
+	unsigned int i;
+
+	search.context = context;
+	search.workers = workers;
+	search.worker_count = worker_count;
+	search.required_workers = required_workers;
+	search.best_score = -HUGE_VAL;
+	search.upper_bound = upper_bound;
+	search.nodes = 0;
+	search.proven = true;
+	search.bound_table = context_allocate(context, WORKER_BOUND_TABLE_SIZE * sizeof(double));
+	build_worker_bound_table(search.bound_table);
+
+	search.order_keys = context_allocate(context, worker_count * sizeof(double));
+	memset(search.coverage, 0, sizeof(search.coverage));
+	allocate_schedule(context, &search.current, required_workers);
+	allocate_schedule(context, &search.best, required_workers);
+	for (block = 0; block < 21; block++) {
+		if (required_for_block(&required_workers, block) > worker_count) {
+			context_fail(context, VAGTPLAN_ERROR_INFEASIBLE, "Ikke nok medarbejdere til at lave en valid plan for en dag");
+		}
+		search.order[block] = context_allocate(context, worker_count * sizeof(Worker*));
+		memcpy(search.order[block], workers, worker_count * sizeof(Worker*));
+	}
+
+	/*En startvagtplan gør at søgningen kan beskære fra starten*/
+	if (incumbent != NULL) {
+		copy_schedule(incumbent, &search.best, required_workers);
+		search.best_score = incumbent->score;
+	}
+
+	for (i = 0; i < worker_count; i++) {
+		reset_worker_state(workers[i]);
+	}
+
+	exact_search(&search, 0, 0, 0, 0);
+
+	if (search.best_score == -HUGE_VAL) {
+		context_fail(context, VAGTPLAN_ERROR_INFEASIBLE, "Den eksakte søgning fandt ingen vagtplan");
+	}
+	if (search.proven) {
+		context_log(context, "Fandt en bevist optimal vagtplan med score %f efter %lu knuder\n", search.best_score, search.nodes);
+	} else {
+		context_log(context, "Knudegrænsen blev nået, den bedste vagtplan har score %f men er ikke bevist optimal\n", search.best_score);
+	}
+
+	free_schedule(context, &search.current);
+	for (block = 0; block < 21; block++) {
+		context_free(context, search.order[block]);
+	}
+	context_free(context, search.bound_table);
+	context_free(context, search.order_keys);
+	search.best.score = search.best_score;
+	return search.best;
+}
+
+void exact_search(ExactSearch* search, unsigned int block, unsigned int slot, unsigned int min_position, double score) {
+	unsigned int needed;
+	unsigned int position;
+
+	if (block == 21) {
+		unsigned int i;
+		for (i = 0; i < search->worker_count; i++) {
+			score += score_week_end(search->workers[i]);
+		}
+		if (score > search->best_score) {
+			search->best_score = score;
+			copy_schedule(&search->current, &search->best, search->required_workers);
+		}
+		return;
+	}
+
+	/*Når den øvre grænse er nået kan ingen anden gren blive bedre*/
+	if (search->best_score >= search->upper_bound) {
+		return;
+	}
+
+	needed = required_for_block(&search->required_workers, block);
+	/*Grene hvor de ledige pladser ikke kan nå at dække en kvalifikation bliver aldrig gyldige*/
+	for (position = 0; position < VAGTPLAN_SKILL_COUNT; position++) {
+		if (search->required_workers.skills[block][position] > search->coverage[block][position] + (needed - slot)) {
+			return;
+		}
+	}
+	if (slot == needed) {
+		exact_search(search, block + 1, 0, 0, score);
+		return;
+	}
+
+	search->nodes++;
+	if (search->nodes > EXACT_NODE_LIMIT) {
+		search->proven = false;
+		return;
+	}
+	if (search->nodes % 10000000 == 0) {
+		context_log(search->context, "%lu knuder undersøgt, bedste score indtil videre er %f\n", search->nodes, search->best_score);
+	}
+
+	/*Scorerne er heltal, så en gren der ikke kan blive bedre end den bedste er færdig*/
+	if (score + exact_bound(search, block, needed - slot) <= search->best_score) {
+		return;
+	}
+
+	if (slot == 0) {
+		exact_order_block(search, block);
+	}
+
+	/*Medarbejderne i en blok vælges i stigende rækkefølge, så den samme blok ikke bliver prøvet i flere ombytninger*/
+	for (position = min_position; position + (needed - slot) <= search->worker_count; position++) {
+		Worker* worker = search->order[block][position];
+		int last_block = worker->last_block;
+		unsigned int consecutive_night_shifts = worker->consecutive_night_shifts;
+		int day_off = worker->day_off;
+		unsigned int skipped;
+		bool symmetric = false;
+		double delta;
+
+		if (worker->forbidden_blocks & (1UL << block)) {
+			continue;
+		}
+		/*Hvis en tidligere medarbejder med samme ønsker og samme tilstand er sprunget over, så er
+		denne gren den samme som en der allerede er undersøgt*/
+		for (skipped = min_position; skipped < position; skipped++) {
+			if (exact_equivalent_workers(search->order[block][skipped], worker)) {
+				symmetric = true;
+				break;
+			}
+		}
+		if (symmetric) {
+			continue;
+		}
+
+		delta = search->context->static_scores[worker->id * 21 + block] + score_transition(worker, block);
+		search->current.workers[search->required_workers.offsets[block] + slot] = worker;
+		exact_cover(search, block, worker, 1);
+		exact_search(search, block, slot + 1, position + 1, score + delta);
+		exact_cover(search, block, worker, -1);
+
+		worker->last_block = last_block;
+		worker->consecutive_night_shifts = consecutive_night_shifts;
+		worker->day_off = day_off;
+	}
+}
+
+double exact_bound(const ExactSearch* search, unsigned int block, unsigned int slots_left_in_block) {
+	double worker_side[3] = {0, 0, 0};
+	unsigned int slots_side[3] = {0, 0, 0};
+	double bound = 0;
+	unsigned int shift;
+	unsigned int b;
+	unsigned int i;
+
+	for (i = 0; i < search->worker_count; i++) {
+		const Worker* worker = search->workers[i];
+		worker_side[worker->desired_shift] += search->bound_table[worker_bound_index(worker, block)];
+	}
+
+	slots_side[block % 3] = slots_left_in_block;
+	for (b = block + 1; b < 21; b++) {
+		slots_side[b % 3] += required_for_block(&search->required_workers, b);
+	}
+
+	/*Medarbejderne der ønsker en vagt kan højst få et point for hver plads der er tilbage på den vagt,
+	og hver medarbejder kan højst få det som de kunne få alene*/
+	for (shift = 0; shift < 3; shift++) {
+		bound += worker_side[shift] < slots_side[shift] ? worker_side[shift] : slots_side[shift];
+	}
+	return bound;
+}
+
+void build_worker_bound_table(double* table) {
+	Worker worker;
+	unsigned int desired_shift;
+	unsigned int desired_day_off;
+	unsigned int block;
+	unsigned int last;
+	unsigned int nights;
+	unsigned int day_off;
+
+	/*Fraværet bliver ikke talt med, så tabellen er en grænse for alle medarbejdere*/
+	worker.forbidden_blocks = 0;
+	for (desired_shift = 0; desired_shift < 3; desired_shift++) {
+		for (desired_day_off = 0; desired_day_off < 7; desired_day_off++) {
+			worker.desired_shift = desired_shift;
+			worker.desired_day_off = desired_day_off;
+			block = 22;
+			while (block-- > 0) {
+				for (last = 0; last < 22; last++) {
+					for (nights = 0; nights < 3; nights++) {
+						for (day_off = 0; day_off < 3; day_off++) {
+							double skip;
+							double take;
+							unsigned int index;
+							/*En forrige vagt efter blokken kan ikke nås. En på selve blokken kan, når grænsen
+							bliver regnet midt i en blok for en medarbejder der allerede er sat på den*/
+							if (last > block + 1) {
+								continue;
+							}
+							worker.last_block = last == 0 ? -10 : (int) last - 1;
+							worker.consecutive_night_shifts = nights;
+							worker.day_off = (int) day_off - 1;
+							index = worker_bound_index(&worker, block);
+
+							if (block == 21) {
+								table[index] = score_week_end(&worker);
+								continue;
+							}
+							skip = table[worker_bound_index(&worker, block + 1)];
+							take = score_assignment(&worker, block);
+							take += table[worker_bound_index(&worker, block + 1)];
+							table[index] = take > skip ? take : skip;
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+double score_upper_bound(VagtplanContext* context, Worker* workers[], unsigned int worker_count, RequiredWorkers required_workers) {
+	double* table = context_allocate(context, WORKER_BOUND_TABLE_SIZE * sizeof(double));
+	double bound = 0;
+	unsigned int shift;
+	build_worker_bound_table(table);
+
+	for (shift = 0; shift < 3; shift++) {
+		unsigned int slots[7];
+		double best_cut = HUGE_VAL;
+		double full_slots = 0;
+		unsigned int full_blocks;
+		unsigned int day;
+		/*De mindste blokke er de billigste at skære, så de bliver sorteret først*/
+		for (day = 0; day < 7; day++) {
+			unsigned int size = required_for_block(&required_workers, day * 3 + shift);
+			unsigned int j = day;
+			while (j > 0 && slots[j - 1] > size) {
+				slots[j] = slots[j - 1];
+				j--;
+			}
+			slots[j] = size;
+		}
+		/*Minimalt snit i et flownetværk fra medarbejderne til de 7 blokke med vagten. Hvis de full_blocks
+		mindste blokke er fyldt helt op, så kan hver af de andre medarbejdere højst få en plads i de resterende blokke*/
+		for (full_blocks = 0; full_blocks <= 7; full_blocks++) {
+			double cut = full_slots;
+			unsigned int i;
+			for (i = 0; i < worker_count; i++) {
+				Worker worker = *workers[i];
+				double alone;
+				if (worker.desired_shift != shift) {
+					continue;
+				}
+				reset_worker_state(&worker);
+				alone = table[worker_bound_index(&worker, 0)];
+				cut += alone < 7 - full_blocks ? alone : 7 - full_blocks;
+			}
+			if (cut < best_cut) {
+				best_cut = cut;
+			}
+			if (full_blocks < 7) {
+				full_slots += slots[full_blocks];
+			}
+		}
+		bound += best_cut;
+	}
+
+	context_free(context, table);
+	return bound;
+}
+
+unsigned int worker_bound_index(const Worker* worker, unsigned int block) {
+	unsigned int last = worker->last_block < 0 ? 0 : worker->last_block + 1;
+	/*Reglen for nattevagter ser kun på om der har været mindst 2, så flere end 2 er den samme tilstand*/
+	unsigned int nights = worker->consecutive_night_shifts > 2 ? 2 : worker->consecutive_night_shifts;
+	unsigned int type = worker->desired_shift * 7 + worker->desired_day_off;
+	return ((((type * 22 + block) * 22 + last) * 3 + nights) * 3) + (worker->day_off + 1);
+}
+
+void exact_cover(ExactSearch* search, unsigned int block, const Worker* worker, int direction) {
+	unsigned int skill;
+	for (skill = 0; skill < VAGTPLAN_SKILL_COUNT; skill++) {
+		if (worker->skills & (1 << skill)) {
+			search->coverage[block][skill] += direction;
+		}
+	}
+}
+
+bool exact_equivalent_workers(const Worker* a, const Worker* b) {
+	unsigned int a_nights = a->consecutive_night_shifts > 2 ? 2 : a->consecutive_night_shifts;
+	unsigned int b_nights = b->consecutive_night_shifts > 2 ? 2 : b->consecutive_night_shifts;
+	return a->desired_shift == b->desired_shift
+		&& a->desired_day_off == b->desired_day_off
+		&& a->skills == b->skills
+		&& a->forbidden_blocks == b->forbidden_blocks
+		&& a->last_block == b->last_block
+		&& a_nights == b_nights
+		&& a->day_off == b->day_off;
+}
+
+void exact_order_block(ExactSearch* search, unsigned int block) {
+	Worker** order = search->order[block];
+	unsigned int i;
+
+	/*Nøglen er hvor meget medarbejderen bedst kan få i resten af ugen hvis de tager blokken,
+	minus hvad de kan få hvis de ikke gør. Dem der mister mindst prøves først, så de første
+	blade i søgningen allerede er gode skemaer der kan beskære resten*/
+	for (i = 0; i < search->worker_count; i++) {
+		Worker worker = *order[i];
+		double skip = search->bound_table[worker_bound_index(&worker, block + 1)];
+		double take = score_assignment(&worker, block);
+		take += search->bound_table[worker_bound_index(&worker, block + 1)];
+		search->order_keys[i] = take - skip;
+	}
+
+	for (i = 1; i < search->worker_count; i++) {
+		unsigned int j = i;
+		while (j > 0 && search->order_keys[j] > search->order_keys[j - 1]) {
+			Worker* tmp_worker = order[j];
+			double tmp_key = search->order_keys[j];
+			order[j] = order[j - 1];
+			order[j - 1] = tmp_worker;
+			search->order_keys[j] = search->order_keys[j - 1];
+			search->order_keys[j - 1] = tmp_key;
+			j--;
+		}
+	}
+}
+
+void exact_init(Solver* solver, const SolverProblem* problem, const SolverOptions* options) {
+	ExactState* state = context_allocate(problem->context, sizeof(ExactState));
+	state->context = problem->context;
+	state->result = exact_schedule(problem->context, problem->workers, problem->worker_count, problem->required_workers, problem->upper_bound, best_seed(problem));
+	solver->state = state;
+}
+
+bool exact_step(Solver* solver) {
+	/*Hele søgningen bliver lavet i exact_init*/
+	return false;
+}
+
+const Schedule* exact_best(const Solver* solver) {
+	const ExactState* state = solver->state;
+	return &state->result;
+}
+
+Schedule exact_stop(Solver* solver) {
+	ExactState* state = solver->state;
+	Schedule rv = state->result;
+	context_free(state->context, state);
+	solver->state = NULL;
+	return rv;
+}
+
+void local_search_init(LocalSearchState* state, const SolverProblem* problem, const SolverOptions* options) {
+	unsigned int i;
+	state->problem = *problem;
+	state->options = *options;
+	state->step = 0;
+	state->tabu_until = NULL;
+
+	/*Vores egen kopi af medarbejder arrayen er sorteret efter id, så et id fra puljerne også er et index*/
+	state->problem.workers = context_allocate(problem->context, problem->worker_count * sizeof(Worker*));
+	state->assignment = context_allocate(problem->context, problem->required_workers.offsets[21] * sizeof(unsigned int));
+	state->occupancy = context_allocate_zero(problem->context, problem->worker_count, sizeof(unsigned long));
+	state->coverage = context_allocate(problem->context, 21 * VAGTPLAN_SKILL_COUNT * sizeof(unsigned int));
+	state->worker_scores = context_allocate(problem->context, problem->worker_count * sizeof(double));
+	for (i = 0; i < problem->worker_count; i++) {
+		state->problem.workers[problem->workers[i]->id] = problem->workers[i];
+	}
+
+	generate_random_schedule(problem->context, problem->required_workers, &state->current);
+	generate_random_schedule(problem->context, problem->required_workers, &state->best);
+	if (best_seed(problem) != NULL) {
+		copy_schedule(best_seed(problem), &state->current, problem->required_workers);
+	}
+	local_search_index(state);
+	local_search_save_best(state);
+}
+
+void local_search_index(LocalSearchState* state) {
+	const SolverProblem* problem = &state->problem;
+	unsigned int block;
+	unsigned int i;
+
+	for (i = 0; i < problem->worker_count; i++) {
+		state->occupancy[i] = 0;
+	}
+	state->current.score = 0;
+	for (block = 0; block < 21; block++) {
+		unsigned int* coverage = state->coverage + block * VAGTPLAN_SKILL_COUNT;
+		unsigned int skill;
+		for (skill = 0; skill < VAGTPLAN_SKILL_COUNT; skill++) {
+			coverage[skill] = 0;
+		}
+		for (i = problem->required_workers.offsets[block]; i < problem->required_workers.offsets[block + 1]; i++) {
+			/*problem->workers er i id rækkefølge, så id er også index*/
+			unsigned int worker_index = state->current.workers[i]->id;
+			state->assignment[i] = worker_index;
+			state->occupancy[worker_index] |= 1UL << block;
+			for (skill = 0; skill < VAGTPLAN_SKILL_COUNT; skill++) {
+				coverage[skill] += (problem->workers[worker_index]->skills >> skill) & 1;
+			}
+		}
+		state->current.score += score_skill_shortage(problem->required_workers.skills[block], coverage);
+	}
+
+	for (i = 0; i < problem->worker_count; i++) {
+		state->worker_scores[i] = score_worker_blocks(problem->workers[i], state->occupancy[i], problem->context->static_scores);
+		state->current.score += state->worker_scores[i];
+	}
+}
+
+bool local_search_random_move(const LocalSearchState* state, LocalSearchMove* move) {
+	VagtplanContext* context = state->problem.context;
+	unsigned int attempt;
+	for (attempt = 0; attempt < 100; attempt++) {
+		unsigned int needed;
+		unsigned int candidates;
+		unsigned int pool;
+		move->block = random_number(context, 0, 21);
+		pool = move->block * POOL_KINDS;
+		needed = required_for_block(&state->problem.required_workers, move->block);
+		candidates = pool_size(&context->pools, pool);
+		if (needed == 0 || needed >= candidates) {
+			continue;
+		}
+		move->slot = random_number(context, 0, needed);
+		move->old_worker = state->assignment[state->problem.required_workers.offsets[move->block] + move->slot];
+		move->new_worker = context->pools.workers[context->pools.offsets[pool] + random_number(context, 0, candidates)];
+		/*Den nye medarbejder må ikke allerede være på blokken*/
+		if (state->occupancy[move->new_worker] & (1UL << move->block)) {
+			continue;
+		}
+		move->old_worker_score = score_worker_blocks(state->problem.workers[move->old_worker], state->occupancy[move->old_worker] & ~(1UL << move->block), state->problem.context->static_scores);
+		move->new_worker_score = score_worker_blocks(state->problem.workers[move->new_worker], state->occupancy[move->new_worker] | (1UL << move->block), state->problem.context->static_scores);
+		move->delta = move->old_worker_score + move->new_worker_score
+			- state->worker_scores[move->old_worker] - state->worker_scores[move->new_worker]
+			+ local_search_skill_delta(state, move->block, move->old_worker, move->new_worker);
+		return true;
+	}
+	return false;
+}
+
+double local_search_skill_delta(const LocalSearchState* state, unsigned int block, unsigned int old_worker, unsigned int new_worker) {
+	const unsigned char* minimum = state->problem.required_workers.skills[block];
+	const unsigned int* coverage = state->coverage + block * VAGTPLAN_SKILL_COUNT;
+	unsigned char old_skills = state->problem.workers[old_worker]->skills;
+	unsigned char new_skills = state->problem.workers[new_worker]->skills;
+	unsigned int after[VAGTPLAN_SKILL_COUNT];
+	unsigned int skill;
+
+	if (old_skills == new_skills) {
+		return 0;
+	}
+	for (skill = 0; skill < VAGTPLAN_SKILL_COUNT; skill++) {
+		after[skill] = coverage[skill] - ((old_skills >> skill) & 1) + ((new_skills >> skill) & 1);
+	}
+	return score_skill_shortage(minimum, after) - score_skill_shortage(minimum, coverage);
+}
+
+void local_search_apply_move(LocalSearchState* state, const LocalSearchMove* move) {
+	unsigned int* coverage = state->coverage + move->block * VAGTPLAN_SKILL_COUNT;
+	unsigned int skill;
+	for (skill = 0; skill < VAGTPLAN_SKILL_COUNT; skill++) {
+		coverage[skill] += ((state->problem.workers[move->new_worker]->skills >> skill) & 1) - ((state->problem.workers[move->old_worker]->skills >> skill) & 1);
+	}
+	state->occupancy[move->old_worker] &= ~(1UL << move->block);
+	state->occupancy[move->new_worker] |= 1UL << move->block;
+	state->worker_scores[move->old_worker] = move->old_worker_score;
+	state->worker_scores[move->new_worker] = move->new_worker_score;
+	state->assignment[state->problem.required_workers.offsets[move->block] + move->slot] = move->new_worker;
+	state->current.workers[state->problem.required_workers.offsets[move->block] + move->slot] = state->problem.workers[move->new_worker];
+	state->current.score += move->delta;
+}
+
+void local_search_save_best(LocalSearchState* state) {
+	copy_schedule(&state->current, &state->best, state->problem.required_workers);
+}
+
+const Schedule* local_search_best(const Solver* solver) {
+	const LocalSearchState* state = solver->state;
+	return &state->best;
+}
+
+Schedule local_search_stop(Solver* solver) {
+	LocalSearchState* state = solver->state;
+	VagtplanContext* context = state->problem.context;
+	Schedule rv = state->best;
+
+	context_free(context, state->assignment);
+	context_free(context, state->coverage);
+	free_schedule(context, &state->current);
+	context_free(context, state->problem.workers);
+	context_free(context, state->occupancy);
+	context_free(context, state->worker_scores);
+	context_free(context, state->tabu_until);
+	context_free(context, state);
+	solver->state = NULL;
+	return rv;
+}
+
+void local_search_immigrate(Solver* solver, const Schedule* migrant) {
+	LocalSearchState* state = solver->state;
+	if (migrant->score <= state->current.score) {
+		return;
+	}
+	copy_schedule(migrant, &state->current, state->problem.required_workers);
+	local_search_index(state);
+	if (state->current.score > state->best.score) {
+		local_search_save_best(state);
+	}
+}
+
+double score_worker_blocks(const Worker* worker, unsigned long blocks, const double* static_scores) {
+	const double* row = static_scores + worker->id * 21;
+	Worker state = *worker;
+	unsigned int block;
+	double score = 0;
+
+	reset_worker_state(&state);
+	for (block = 0; block < 21; block++) {
+		if (blocks & (1UL << block)) {
+			score += row[block] + score_transition(&state, block);
+		}
+	}
+	return score + score_week_end(&state);
+}
+
+void annealing_init(Solver* solver, const SolverProblem* problem, const SolverOptions* options) {
+	LocalSearchState* state = context_allocate(problem->context, sizeof(LocalSearchState));
+	double total_moves = (double) options->generations * ANNEALING_MOVES_PER_STEP;
+	local_search_init(state, problem, options);
+	/*Temperaturen falder geometrisk så den når sluttemperaturen ved det sidste træk*/
+	state->temperature = ANNEALING_START_TEMPERATURE;
+	state->cooling = pow(ANNEALING_END_TEMPERATURE / ANNEALING_START_TEMPERATURE, 1.0 / total_moves);
+	solver->state = state;
+}
+
+bool annealing_step(Solver* solver) {
+	LocalSearchState* state = solver->state;
+	unsigned int i;
+
+	if (state->step >= state->options.generations) {
+		return false;
+	}
+
+	for (i = 0; i < ANNEALING_MOVES_PER_STEP; i++) {
+		LocalSearchMove move;
+		state->temperature *= state->cooling;
+		if (!local_search_random_move(state, &move)) {
+			return false;
+		}
+		if (move.delta >= 0 || random_unit(state->problem.context) < exp(move.delta / state->temperature)) {
+			local_search_apply_move(state, &move);
+			archive_offer(state->problem.archive, &state->current);
+			if (state->current.score > state->best.score) {
+				local_search_save_best(state);
+			}
+		}
+	}
+
+	state->step++;
+	if (state->step % 1000 == 0) {
+		context_log(state->problem.context, "Skridt nummer %u. Max fitness er %f, nuværende: %f, gab: %f, temperatur: %f\n", state->step, state->best.score, state->current.score, state->problem.upper_bound - state->best.score, state->temperature);
+	}
+	return true;
+}
+
+void tabu_init(Solver* solver, const SolverProblem* problem, const SolverOptions* options) {
+	LocalSearchState* state = context_allocate(problem->context, sizeof(LocalSearchState));
+	local_search_init(state, problem, options);
+	state->tabu_until = context_allocate_zero(problem->context, problem->worker_count * 21, sizeof(unsigned int));
+	solver->state = state;
+}
+
+bool tabu_step(Solver* solver) {
+	LocalSearchState* state = solver->state;
+	LocalSearchMove best_move;
+	bool found = false;
+	unsigned int i;
+
+	if (state->step >= state->options.generations) {
+		return false;
+	}
+	state->step++;
+
+	/*Det bedste af et tilfældigt udsnit af naboerne bliver valgt, også selvom det er dårligere end det nuværende*/
+	for (i = 0; i < TABU_CANDIDATES; i++) {
+		LocalSearchMove move;
+		bool tabu;
+		if (!local_search_random_move(state, &move)) {
+			return false;
+		}
+		tabu = state->tabu_until[move.new_worker * 21 + move.block] > state->step;
+		/*Et tabu træk er tilladt hvis det giver en ny bedste vagtplan*/
+		if (tabu && state->current.score + move.delta <= state->best.score) {
+			continue;
+		}
+		if (!found || move.delta > best_move.delta) {
+			best_move = move;
+			found = true;
+		}
+	}
+
+	if (found) {
+		/*Medarbejderen der blev fjernet må ikke komme tilbage på blokken i et stykke tid*/
+		state->tabu_until[best_move.old_worker * 21 + best_move.block] = state->step + TABU_TENURE + random_number(state->problem.context, 0, TABU_TENURE);
+		local_search_apply_move(state, &best_move);
+		archive_offer(state->problem.archive, &state->current);
+		if (state->current.score > state->best.score) {
+			local_search_save_best(state);
+		}
+	}
+
+	if (state->step % 1000 == 0) {
+		context_log(state->problem.context, "Skridt nummer %u. Max fitness er %f, nuværende: %f, gab: %f\n", state->step, state->best.score, state->current.score, state->problem.upper_bound - state->best.score);
+	}
+	return true;
+}
+
+void generate_random_schedule(
+	VagtplanContext* context,
+	const RequiredWorkers required_workers,
+	Schedule *schedule
+) {
+	allocate_schedule(context, schedule, required_workers);
+	fill_random_schedule(context, required_workers, schedule);
+}
+
+void fill_random_schedule(VagtplanContext* context, const RequiredWorkers required_workers, Schedule* schedule) {
+	int day;
+
+	/*Foerste forloekke, repræsenterer de 7 dage i en uge.*/
+	for (day = 0; day < 7; day++)
+	{
+		int shift;
+
+		/*En ny stamp for hver dag, så en medarbejder der er trukket på dagen ikke kan trækkes igen før i morgen*/
+		context->pools.stamp++;
+
+		/*Denne forloekke repræsenterer de 3 vagter på en dag, dette vil sige denne funktionen goere 3*7 gange.*/
+		for (shift = 0; shift < 3; shift++) {
+			fill_block(context, &required_workers, day * 3 + shift, schedule->workers + required_workers.offsets[day * 3 + shift], false);
+		}
+	}
+}
+
+void fill_greedy_schedule(VagtplanContext* context, const RequiredWorkers required_workers, Schedule* schedule) {
+	unsigned int block;
+	unsigned int i;
+
+	for (i = 0; i < context->worker_count; i++) {
+		reset_worker_state(&context->workers[i]);
+	}
+	for (block = 0; block < 21; block++) {
+		Worker** block_workers = schedule->workers + required_workers.offsets[block];
+		/*Ligesom i fill_random_schedule kan en medarbejder kun trækkes en gang om dagen*/
+		if (block % 3 == 0) {
+			context->pools.stamp++;
+		}
+		fill_block(context, &required_workers, block, block_workers, true);
+		/*Først når hele blokken er fyldt, så medarbejderne på blokken bliver vurderet ud fra den samme forrige vagt*/
+		for (i = 0; i < required_for_block(&required_workers, block); i++) {
+			score_transition(block_workers[i], block);
+		}
+	}
+}
+
+unsigned int required_for_block(const RequiredWorkers* required_workers, unsigned int block) {
+	if (block >= 21) {
+		program_error("Program fejl1337");
+	}
+	return required_workers->offsets[block + 1] - required_workers->offsets[block];
+}
+
+void set_required_offsets(RequiredWorkers* required_workers, const unsigned int* counts) {
+	unsigned int block;
+	memset(required_workers->skills, 0, sizeof(required_workers->skills));
+	required_workers->offsets[0] = 0;
+	for (block = 0; block < 21; block++) {
+		required_workers->offsets[block + 1] = required_workers->offsets[block] + counts[block];
+	}
+}
+
+int random_number(VagtplanContext* context, int min, int max) {
+	return (int) floor((double) min + random_unit(context) * ((double) max - (double) min));
+}
+
+double evaluate_schedule(Schedule* schedule, const RequiredWorkers required_workers, Worker* worker[], unsigned int amount_of_workers, const double* static_scores){
+	unsigned int block_number, worker_number;
+
+	unsigned int worker_i = 0;
+	for (worker_i = 0; worker_i < amount_of_workers; worker_i++) {
+		reset_worker_state(worker[worker_i]);
+	}
+
+	schedule->score = 0;
+	for (block_number = 0; block_number < 21; block_number++) {
+		/*Blokkens pladser ligger lige efter den forriges i den pakkede array*/
+		for (worker_number = required_workers.offsets[block_number]; worker_number < required_workers.offsets[block_number + 1]; worker_number++) {
+			Worker* current_worker = schedule->workers[worker_number];
+			schedule->score += static_scores[current_worker->id * 21 + block_number] + score_transition(current_worker, block_number);
+		}
+	}
+	
+	/* Tjekker om der har været fridøgn*/
+	for (worker_i = 0; worker_i < amount_of_workers; worker_i++) {
+		schedule->score += score_week_end(worker[worker_i]);
+	}
+
+	schedule->score += score_skill_coverage(schedule, &required_workers);
+
+	return schedule->score;
+}
+
+void reset_worker_state(Worker* worker) {
+	worker->last_block = -10;
+	worker->consecutive_night_shifts = 0;
+	worker->day_off = -1;
+}
+
+double score_assignment(Worker* current_worker, unsigned int block_number) {
+	return static_score(current_worker, block_number) + score_transition(current_worker, block_number);
+}
+
+double static_score(const Worker* worker, unsigned int block) {
+	double score = 0;
+
+	/* Tjekker preferred shift */
+	if (worker->desired_shift == block % 3) {
+		score += 1;
+	}
+	/*Medarbejderen kan ikke tage blokken*/
+	if (worker->forbidden_blocks & (1UL << block)) {
+		score -= 1000;
+	}
+	/*Tjek preferred day*/
+	if (worker->desired_day_off == block / 3) {
+		score -= 2;
+	}
+	return score;
+}
+
+double score_transition(Worker* current_worker, unsigned int block_number) {
+	unsigned int shift = block_number % 3;
+	unsigned int gap = (unsigned int) ((int) block_number - current_worker->last_block);
+	unsigned int broken = transition_broken_rules(current_worker, block_number);
+
+	/* Alle workers starter med day_off sat til minus 1, så hvis en worker ikke er i skemaet er værdien -1
+	Hvis de er med i skemaet og ikke får et fridøgn er den lig 0 */
+	if (current_worker->day_off == -1){
+		current_worker->day_off = 0;
+	}
+
+	/* Tæller nattevagter i streg*/
+	if (shift == SHIFT_NIGHT) {
+		if (gap != 3) {
+			current_worker->consecutive_night_shifts = 0;
+		}
+		current_worker->consecutive_night_shifts += 1;
+	} else {
+		current_worker->consecutive_night_shifts = 0;
+	}
+
+	/* Tjekker fridøgn, max af last_block og 0 fordi, hvis din første vagt er blok 6 har du haft et fridøgn */
+	if (block_number - maxi(current_worker->last_block, -1) > 5){
+		current_worker->day_off = 1;
+	}
+
+	/* Sætter last shift*/
+	current_worker->last_block = block_number;
+	return -1000.0 * broken;
+}
+
+unsigned int transition_broken_rules(const Worker* worker, unsigned int block_number) {
+	/*For hver vagt en bit for hver afstand til den forrige blok som altid bryder en regel: 11 timers
+	reglen ved 0 til 2 blokke, og den cykliske regel fra en nattevagt til aftenvagten dagen efter*/
+	const unsigned long hard_rule_gaps[3] = {0x07UL, 0x07UL, 0x27UL};
+	unsigned int shift = block_number % 3;
+	/*Før den første blok er last_block -10, så afstanden er for stor til at bryde en regel. Afstande
+	på 8 eller mere har ingen bit, og kun dem må skiftes, ellers er skiftet udefineret*/
+	unsigned int gap = (unsigned int) ((int) block_number - worker->last_block);
+	unsigned int broken = gap < 8 ? (unsigned int) ((hard_rule_gaps[shift] >> gap) & 1) : 0;
+
+	/* Højst to nattevagter i streg*/
+	if (shift == SHIFT_NIGHT && gap == 3 && worker->consecutive_night_shifts >= 2) {
+		broken++;
+	}
+	return broken;
+}
+
+double score_week_end(const Worker* worker) {
+	if (worker->day_off == 0) {
+		if (!(worker->last_block > 0 && 21 - worker->last_block > 5)) {
+			return -1000;
+		}
+	}
+	return 0;
+}
+
+void combine_schedule(VagtplanContext* context, RequiredWorkers required_workers, const  Schedule* a, const  Schedule* b,  Schedule* out, const MutationControl* mutation, enum CrossoverOperator crossover) {
+	int crossover_start;
+	int crossover_end;
+	unsigned int b_start;
+	unsigned int b_end;
+	unsigned long days;
+	unsigned int day;
+
+	switch (crossover) {
+	case CROSSOVER_BLOCKS:
+	case CROSSOVER_DAYS:
+		if (crossover == CROSSOVER_BLOCKS) {
+			crossover_start = random_number(context, 0, 20);
+			crossover_end = random_number(context, crossover_start + 1, 21);
+		} else {
+			/*Grænserne ligger mellem to dage, så en dags tre vagter altid kommer fra samme forælder.
+			random_number tager ikke max med, så 8 giver en slutning der kan være 21 og tage søndag med*/
+			crossover_start = random_number(context, 0, 6) * 3;
+			crossover_end = random_number(context, crossover_start / 3 + 1, 8) * 3;
+		}
+		/*Blokkene fra b ligger samlet i midten, så barnet er tre sammenhængende kopier*/
+		b_start = required_workers.offsets[crossover_start];
+		b_end = required_workers.offsets[crossover_end];
+		memcpy(out->workers, a->workers, b_start * sizeof(Worker*));
+		memcpy(out->workers + b_start, b->workers + b_start, (b_end - b_start) * sizeof(Worker*));
+		memcpy(out->workers + b_end, a->workers + b_end, (required_workers.offsets[21] - b_end) * sizeof(Worker*));
+		break;
+	case CROSSOVER_UNIFORM_DAYS:
+		days = random_next(context);
+		for (day = 0; day < 7; day++) {
+			const Schedule* parent = (days >> day) & 1 ? b : a;
+			b_start = required_workers.offsets[day * 3];
+			b_end = required_workers.offsets[day * 3 + 3];
+			memcpy(out->workers + b_start, parent->workers + b_start, (b_end - b_start) * sizeof(Worker*));
+		}
+		break;
+	case CROSSOVER_WORKERS:
+		combine_worker_rows(context, &required_workers, a, b, out);
+		break;
+	default:
+		program_error("Program fejl7");
+	}
+	if (random_unit(context) < mutation->probability) {
+		mutate_schedule(context, required_workers, out, mutation->blocks);
+	}
+}
+
+void combine_worker_rows(VagtplanContext* context, const RequiredWorkers* required_workers, const Schedule* a, const Schedule* b, Schedule* out) {
+	/*Hvilken halvdel af medarbejderne der kommer fra b afgøres af en hash af id, så der ikke skal allokeres*/
+	unsigned long key = random_next(context);
+	unsigned int block;
+
+	for (block = 0; block < 21; block++) {
+		unsigned int offset = required_workers->offsets[block];
+		unsigned int needed = required_for_block(required_workers, block);
+		Worker** block_workers = out->workers + offset;
+		unsigned int filled = 0;
+		unsigned int pass;
+		unsigned int i;
+
+		context->pools.stamp++;
+		/*Først b's medarbejdere fra b's halvdel, så a's fra a's halvdel, og til sidst resten af a's*/
+		for (pass = 0; pass < 3 && filled < needed; pass++) {
+			const Schedule* parent = pass == 0 ? b : a;
+			for (i = 0; i < needed && filled < needed; i++) {
+				Worker* worker = parent->workers[offset + i];
+				bool from_b = ((((unsigned long) worker->id ^ key) * 2654435761UL) & 0xFFFFFFFFUL) >> 31;
+				if (context->pools.stamps[worker->id] == context->pools.stamp) {
+					continue;
+				}
+				if ((pass == 0 && !from_b) || (pass == 1 && from_b)) {
+					continue;
+				}
+				context->pools.stamps[worker->id] = context->pools.stamp;
+				block_workers[filled] = worker;
+				filled++;
+			}
+		}
+	}
+}
+
+void init_crossover_control(CrossoverControl* crossover, enum CrossoverOperator fixed) {
+	unsigned int i;
+	crossover->fixed = fixed;
+	for (i = 0; i < CROSSOVER_OPERATOR_COUNT; i++) {
+		crossover->probabilities[i] = 1.0 / CROSSOVER_OPERATOR_COUNT;
+		crossover->quality[i] = 0.5;
+		crossover->children[i] = 0;
+		crossover->survivors[i] = 0;
+	}
+}
+
+enum CrossoverOperator choose_crossover(VagtplanContext* context, const CrossoverControl* crossover) {
+	double roll;
+	unsigned int i;
+	if (crossover->fixed != CROSSOVER_ADAPTIVE) {
+		return crossover->fixed;
+	}
+	roll = random_unit(context);
+	for (i = 0; i + 1 < CROSSOVER_OPERATOR_COUNT; i++) {
+		if (roll < crossover->probabilities[i]) {
+			break;
+		}
+		roll -= crossover->probabilities[i];
+	}
+	return (enum CrossoverOperator) (i + 1);
+}
+
+void record_crossover(CrossoverControl* crossover, enum CrossoverOperator operator, bool survived) {
+	crossover->children[operator - 1]++;
+	if (survived) {
+		crossover->survivors[operator - 1]++;
+	}
+}
+
+void update_crossover_control(CrossoverControl* crossover) {
+	double total = 0;
+	unsigned int i;
+	if (crossover->fixed != CROSSOVER_ADAPTIVE) {
+		return;
+	}
+	for (i = 0; i < CROSSOVER_OPERATOR_COUNT; i++) {
+		/*En operator der ikke blev brugt i denne generation beholder sin kvalitet*/
+		if (crossover->children[i] > 0) {
+			double reward = (double) crossover->survivors[i] / crossover->children[i];
+			crossover->quality[i] += CROSSOVER_LEARNING_RATE * (reward - crossover->quality[i]);
+		}
+		crossover->children[i] = 0;
+		crossover->survivors[i] = 0;
+		total += crossover->quality[i];
+	}
+	for (i = 0; i < CROSSOVER_OPERATOR_COUNT; i++) {
+		double share = total > 0 ? crossover->quality[i] / total : 1.0 / CROSSOVER_OPERATOR_COUNT;
+		crossover->probabilities[i] = CROSSOVER_MIN_PROBABILITY + (1 - CROSSOVER_OPERATOR_COUNT * CROSSOVER_MIN_PROBABILITY) * share;
+	}
+}
+
+void mutate_schedule(VagtplanContext* context, RequiredWorkers required_workers, Schedule* schedule, unsigned int blocks) {
+	unsigned int block;
+	for (block = 0; block < blocks; block++) {
+		int random_block_index = random_number(context, 0, 21);
+		/*Blokken bliver skrevet helt om, så kun medarbejderne på selve blokken skal være forskellige*/
+		context->pools.stamp++;
+		fill_block(context, &required_workers, random_block_index, schedule->workers + required_workers.offsets[random_block_index], false);
+	}
+}
+
+void init_mutation_control(MutationControl* mutation, bool adaptive) {
+	mutation->probability = MUTATION_MIN_PROBABILITY;
+	mutation->blocks = 1;
+	mutation->adaptive = adaptive;
+	mutation->best_score = -HUGE_VAL;
+	mutation->stalled_generations = 0;
+	mutation->diversity = 1;
+}
+
+bool update_mutation_control(MutationControl* mutation, double best_score, double diversity) {
+	mutation->diversity = diversity;
+	if (!mutation->adaptive) {
+		return false;
+	}
+
+	if (best_score > mutation->best_score) {
+		/*Der er fremskridt, så vi går langsomt tilbage mod den laveste rate*/
+		mutation->best_score = best_score;
+		mutation->stalled_generations = 0;
+		mutation->probability = mutation->probability * 0.9;
+		if (mutation->probability < MUTATION_MIN_PROBABILITY) {
+			mutation->probability = MUTATION_MIN_PROBABILITY;
+		}
+		if (mutation->blocks > 1) {
+			mutation->blocks--;
+		}
+		return false;
+	}
+
+	mutation->stalled_generations++;
+	if (mutation->stalled_generations % STALL_GENERATIONS == 0 || diversity < MIN_DIVERSITY) {
+		mutation->probability = mutation->probability * 1.5;
+		if (mutation->probability > MUTATION_MAX_PROBABILITY) {
+			mutation->probability = MUTATION_MAX_PROBABILITY;
+		}
+		if (mutation->blocks < MUTATION_MAX_BLOCKS && mutation->stalled_generations % STALL_GENERATIONS == 0) {
+			mutation->blocks++;
+		}
+	}
+
+	if (mutation->stalled_generations >= RESTART_GENERATIONS) {
+		/*Efter genstarten starter raten forfra, men den bedste score bliver husket*/
+		mutation->stalled_generations = 0;
+		mutation->probability = MUTATION_MIN_PROBABILITY;
+		mutation->blocks = 1;
+		return true;
+	}
+	return false;
+}
+
+double population_diversity(VagtplanContext* context, const Population* population, RequiredWorkers required_workers) {
+	size_t individual_length = (size_t) population->total_slots * population->gene_size;
+	unsigned int sample;
+	unsigned int different_blocks = 0;
+	for (sample = 0; sample < DIVERSITY_SAMPLES; sample++) {
+		const unsigned char* a = population->genes + random_number(context, 0, population->size) * individual_length;
+		const unsigned char* b = population->genes + random_number(context, 0, population->size) * individual_length;
+		unsigned int block;
+		for (block = 0; block < 21; block++) {
+			size_t offset = required_workers.offsets[block] * population->gene_size;
+			if (memcmp(a + offset, b + offset, required_for_block(&required_workers, block) * population->gene_size) != 0) {
+				different_blocks++;
+			}
+		}
+	}
+	return (double) different_blocks / (DIVERSITY_SAMPLES * 21);
+}
+
+void inject_immigrants(VagtplanContext* context, Population* population, const PopulationRank* ranks, unsigned int first, unsigned int protected_index, Schedule* scratch, Worker* workers[], unsigned int worker_count, RequiredWorkers required_workers) {
+	unsigned int immigrants = (unsigned int) (population->size * IMMIGRANT_FRACTION);
+	unsigned int i;
+	for (i = 0; i < immigrants; i++) {
+		unsigned int index = random_number(context, first, population->size);
+		if (ranks != NULL) {
+			index = ranks[index].individual;
+		}
+		if (index == protected_index) {
+			continue;
+		}
+		fill_random_schedule(context, required_workers, scratch);
+		evaluate_schedule(scratch, required_workers, workers, worker_count, context->static_scores);
+		pack_individual(population, index, scratch);
+	}
+}
+
+Schedule read_schedule(VagtplanContext* context, FILE* file, RequiredWorkers* out, Worker** workers, unsigned int worker_count, const WorkerDirectory* directory) {
+	unsigned int unknown_workers = 0;
+	Schedule rv = read_schedule_lenient(context, file, out, workers, worker_count, directory, &unknown_workers);
+	if (unknown_workers > 0) {
+		context_fail(context, VAGTPLAN_ERROR_UNKNOWN_WORKER, "Forkert uuid");
+	}
+	return rv;
+}
+
+Schedule read_schedule_lenient(VagtplanContext* context, FILE* file, RequiredWorkers* out, Worker** workers, unsigned int worker_count, const WorkerDirectory* directory, unsigned int* unknown_workers) {
+	Schedule rv;
+	unsigned int block_id;
+	int res = 0;
+	char shift_string[33];
+	char day_string[33];
+	unsigned int allocated_workers = 64;
+	unsigned int workers_read = 0;
+	/*Antallet på hver blok kommer fra filen, og alle blokkene bliver læst ind i den samme array*/
+	out->offsets[0] = 0;
+	memset(out->skills, 0, sizeof(out->skills));
+	rv.workers = context_allocate(context, allocated_workers * sizeof(Worker*));
+	for (block_id = 0; block_id < 21; block_id++) {
+		if (feof(file)) {
+			context_fail(context, VAGTPLAN_ERROR_FORMAT, "Forkert formateret vagtplan");
+		}
+		
+		res = fscanf(file,
+			" %32[^;,] %*1[;,] %32[^;,] %*1[;,]", 
+			day_string, shift_string
+		);
+
+		while (true) {
+			char name_buffer[MAX_NAME_LENGTH + 1];
+			unsigned int uuid_read;
+			int end_char = 0;
+			if (feof(file)) {
+				context_fail(context, VAGTPLAN_ERROR_FORMAT, "Forkert formateret vagtplan");
+			}
+			if (workers_read + 1 > allocated_workers) {
+				allocated_workers *= 2;
+				rv.workers = context_reallocate(context, rv.workers, allocated_workers * sizeof(Worker*));
+			}
+
+			res = fscanf(file, " %50[^.].%u %*1[;,] ", name_buffer,  &uuid_read);
+			if (res != 2) {
+				context_fail(context, VAGTPLAN_ERROR_FORMAT, "Forkert formateret vagtplan");
+			}
+			name_buffer[MAX_NAME_LENGTH] = 0;
+
+			rv.workers[workers_read] = find_worker_from_uuid(workers, worker_count, directory, uuid_read);
+			if (rv.workers[workers_read] == NULL) {
+				*unknown_workers += 1;
+			}
+			workers_read++;
+			end_char = fgetc(file);
+			if (end_char == '$') {
+				break;
+			}
+			ungetc(end_char, file);
+		}
+		fscanf(file, "%*[^\n]\n");
+		out->offsets[block_id + 1] = workers_read;
+	}
+	return rv;
+}
+
+void write_schedule(FILE* file, const  Schedule* schedule, RequiredWorkers required_workers, const WorkerDirectory* directory) {
+	unsigned int block_id;
+	for (block_id = 0; block_id < 21; block_id++) {
+		unsigned int i;
+		fprintf(file, "%s,%s", get_day_as_string(block_id / 3), get_shift_as_string(block_id % 3));
+		for (i = required_workers.offsets[block_id]; i < required_workers.offsets[block_id + 1]; i++) {
+			fprintf(file, ",%s.%u", worker_name(directory, schedule->workers[i]), worker_uuid(directory, schedule->workers[i]));
+		}
+		fprintf(file, ",$\n");
+	}
+}
+
+Worker* find_worker_from_uuid(Worker** workers, unsigned int worker_count, const WorkerDirectory* directory, unsigned int uuid) {
+	unsigned int worker;
+	if (!find_uuid(directory, uuid, &worker) || worker >= worker_count) {
+		return NULL;
+	}
+	return workers[worker];
+}
+
+const char* get_day_as_string(enum Day day){
+	switch (day) {
+	case DAY_MONDAY:
+		return "mandag";
+		break;
+	case DAY_TUESDAY:
+		return "tirsdag";
+	case DAY_WEDNESDAY:
+		return "onsdag";
+	case DAY_THURSDAY:
+		return "torsdag";
+	case DAY_FRIDAY:
+		return "fredag";
+	case DAY_SATURDAY:
+		return "lørdag";
+	case DAY_SUNDAY:
+		return "søndag";
+	case DAY_INVALID:
+		return "invalid";
+	default:
+		break;
+	}
+	program_error("Program fejl2");
+	return "";
+}
+
+const char* get_skill_as_string(enum Skill skill) {
+	switch (skill) {
+	case SKILL_NURSE:
+		return "sygeplejerske";
+	case SKILL_DOCTOR:
+		return "læge";
+	case SKILL_NIGHT:
+		return "nattevagt";
+	case SKILL_INVALID:
+		return "ingen";
+	}
+	program_error("Program fejl5");
+	return "";
+}
+
+const char* get_shift_as_string(enum Shift shift) {
+	switch (shift) {
+	case SHIFT_NIGHT:
+		return "nat";
+	case SHIFT_DAY:
+		return "dag";
+	case SHIFT_EVENING: 
+		return "aften";
+	case SHIFT_INVALID:
+		return "ingen";
+	}
+	program_error("Program fejl1");
+	return "";
+}
+
+void free_schedule(VagtplanContext* context, Schedule* schedule) {
+	context_free(context, schedule->workers);
+}
+
+int maxi(int a, int b) {
+	return a > b ? a : b;
+}
+
+double wall_seconds() {
+#ifdef POSIX_SUPPORTED
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double) now.tv_sec + (double) now.tv_nsec / 1e9;
+#else
+	return (double) clock() / CLOCKS_PER_SEC;
+#endif
+}
\ No newline at end of file
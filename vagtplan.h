@@ -0,0 +1,441 @@
+#ifndef VAGTPLAN_H
+#define VAGTPLAN_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define MAX_ISLANDS 64
+#define MAX_POPULATION_SIZE 1000000
+#define MAX_THREADS 64
+#define MAX_ALTERNATIVES 100
+#define MAX_PARALLEL_DEPARTMENTS 64
+#define VAGTPLAN_EVALUATOR_COUNT 4
+#define VAGTPLAN_SKILL_COUNT 3
+
+enum Day {
+	DAY_MONDAY,
+	DAY_TUESDAY,
+	DAY_WEDNESDAY,
+	DAY_THURSDAY,
+	DAY_FRIDAY,
+	DAY_SATURDAY,
+	DAY_SUNDAY,
+	DAY_INVALID
+};
+
+enum Shift {
+	SHIFT_NIGHT,
+	SHIFT_DAY,
+	SHIFT_EVENING,
+	SHIFT_INVALID
+};
+
+/**
+ * Kvalifikationerne en medarbejder kan have, hver er en bit i medarbejderens kvalifikationer
+ */
+enum Skill {
+	SKILL_NURSE,
+	SKILL_DOCTOR,
+	SKILL_NIGHT,
+	SKILL_INVALID
+};
+
+enum Engine {
+	ENGINE_GENERATIONAL,
+	ENGINE_STEADY_STATE,
+	ENGINE_EXACT,
+	ENGINE_ANNEALING,
+	ENGINE_TABU
+};
+
+/**
+ * Hvordan de genetiske motorer laver et barn af to forældre. CROSSOVER_ADAPTIVE vælger mellem de
+ * andre efter hvor ofte deres børn slår begge forældre
+ */
+enum CrossoverOperator {
+	CROSSOVER_ADAPTIVE,
+	/*Et sammenhængende stykke blokke fra den anden forælder, det kan starte og slutte midt på en dag*/
+	CROSSOVER_BLOCKS,
+	/*Et sammenhængende stykke hele dage fra den anden forælder*/
+	CROSSOVER_DAYS,
+	/*Hver dag kommer fra en tilfældig af forældrene*/
+	CROSSOVER_UNIFORM_DAYS,
+	/*Halvdelen af medarbejderne får hele ugen fra den anden forælder*/
+	CROSSOVER_WORKERS
+};
+
+/**
+ * Det som alle funktionerne i biblioteket der kan fejle returnerer. Teksten til fejlen kan
+ * hentes med vagtplan_error_message
+ */
+enum VagtplanStatus {
+	VAGTPLAN_OK,
+	VAGTPLAN_ERROR_MEMORY,
+	VAGTPLAN_ERROR_FORMAT,
+	VAGTPLAN_ERROR_UNKNOWN_WORKER,
+	VAGTPLAN_ERROR_INFEASIBLE,
+	VAGTPLAN_ERROR_ARGUMENT,
+	VAGTPLAN_ERROR_SYSTEM
+};
+
+/**
+ * Hvor mange medarbejdere der skal være på hver af ugens 21 blokke. En vagtplan gemmer alle
+ * pladserne i ugen efter hinanden, og blok b går fra offsets[b] til offsets[b + 1]. Laves med
+ * vagtplan_required_per_shift, vagtplan_required_per_block eller vagtplan_read_required_workers.
+ * skills er hvor mange på blokken der mindst skal have hver kvalifikation, de starter som 0 og
+ * kan sættes med vagtplan_read_skill_requirements
+ */
+typedef struct RequiredWorkers {
+	unsigned int offsets[22];
+	unsigned char skills[21][VAGTPLAN_SKILL_COUNT];
+} RequiredWorkers;
+
+/**
+ * Den bedste vagtplan en kørende motor har fundet indtil videre, og en måde at stoppe den på.
+ * Motoren skriver uden lås, så andre tråde kan læse den med vagtplan_progress_best uden at motoren
+ * venter på dem
+ */
+typedef struct VagtplanProgress VagtplanProgress;
+
+typedef struct SolverOptions {
+	enum Engine engine;
+	unsigned int generations;
+	unsigned int tournament_size;
+	/*Den genetiske algoritmes population: antallet af individer, hvor mange af de bedste der får børn
+	i hver generation og hvor mange børn hver af dem får. Standard er 1000, 40 og 4, og populationen
+	skal være større end eliten og deres børn tilsammen*/
+	unsigned int population_size;
+	unsigned int elite_size;
+	unsigned int children_per_elite;
+	/*Hvor mange tråde den generationsbaserede motor avler børn i, den kaldende tråd medregnet, som
+	også samler generationerne. Standard er 1, som er uden tråde. Med flere tråde afhænger vagtplanen
+	af hvordan trådene bliver kørt, så den samme seed giver ikke altid den samme vagtplan*/
+	unsigned int threads;
+	bool adaptive_mutation;
+	enum CrossoverOperator crossover;
+	unsigned int islands;
+	/*Sekunder motoren højst må køre, 0 betyder ingen grænse. Den eksakte søgning ser ikke på den*/
+	double time_limit;
+	/*Hvor mange forskellige vagtplaner vagtplan_make_schedules højst giver, standard er 1*/
+	unsigned int alternatives;
+	/*Hvor mange pladser to alternativer mindst skal være forskellige på, 0 betyder bare at de ikke må være ens*/
+	unsigned int min_distance;
+	/*Hvor mange afdelinger vagtplan_make_department_schedule løser samtidig, standard er 4*/
+	unsigned int parallel_departments;
+	/*Hvor stor en del af startpopulationen der bliver lavet grådigt med dem der ønsker vagten og
+	ikke bryder de hårde regler, resten er tilfældige. Standard er 0.25, 0 er kun tilfældige*/
+	double greedy_fraction;
+	/*Hvor motoren udgiver den bedste vagtplan undervejs og ser efter om den skal stoppe. Standard er
+	NULL. vagtplan_make_department_schedule ser bort fra den, og den eksakte søgning kan ikke stoppes*/
+	VagtplanProgress* progress;
+} SolverOptions;
+
+/**
+ * Resultatet for en af fitness funktionerne fra vagtplan_check_evaluators
+ */
+typedef struct VagtplanEvaluatorCheck {
+	const char* name;
+	unsigned long evaluations;
+	unsigned long mismatches;
+	double evaluations_per_second;
+} VagtplanEvaluatorCheck;
+
+/**
+ * Funktionerne som biblioteket allokerer hukommelse med, user bliver givet videre til dem.
+ * reallocate og release får aldrig NULL
+ */
+typedef struct VagtplanAllocator {
+	void* (*allocate)(void* user, size_t size);
+	void* (*reallocate)(void* user, void* memory, size_t size);
+	void (*release)(void* user, void* memory);
+	void* user;
+} VagtplanAllocator;
+
+/**
+ * Al tilstand i biblioteket ligger i en kontekst: medarbejderlisten, tilfældighedsgeneratoren,
+ * den sidste fejl og hukommelsen. Der er ingen global tilstand, så forskellige tråde kan bruge
+ * hver sin kontekst samtidig, men en kontekst må kun bruges af en tråd ad gangen
+ */
+typedef struct VagtplanContext VagtplanContext;
+
+/**
+ * En vagtplan og hvor mange medarbejdere der er på hver vagt. Den tilhører konteksten den er lavet i
+ */
+typedef struct VagtplanSchedule VagtplanSchedule;
+
+/**
+ * Laver en ny kontekst
+ * @param[in] allocator funktionerne til hukommelse, NULL betyder malloc, realloc og free
+ * @param[in] seed starten for tilfældighedsgeneratoren, den samme seed giver de samme vagtplaner
+ * @returns konteksten, eller NULL hvis der ikke var hukommelse nok
+ */
+VagtplanContext* vagtplan_create(const VagtplanAllocator* allocator, unsigned long seed);
+
+/**
+ * Frigiver konteksten og alt der er allokeret i den, også vagtplaner der ikke er frigivet
+ */
+void vagtplan_destroy(VagtplanContext* context);
+
+/**
+ * Sætter hvor motorerne skriver hvordan det går, NULL er standard og skriver ingenting
+ */
+void vagtplan_set_log(VagtplanContext* context, FILE* log);
+
+/**
+ * Et stykke arbejde til vagtplan_parallel_for, over elementerne fra begin til end
+ * @param[in] thread nummeret på tråden der kører stykket, fra 0 til antallet af tråde - 1, så
+ * hver tråd kan have sit eget arbejdsområde
+ */
+typedef void (*VagtplanTaskFunction)(void* argument, unsigned int thread, unsigned long begin, unsigned long end);
+
+/**
+ * Kalder function på elementerne fra 0 til count fordelt på flere tråde. Hver tråd har sin egen kø
+ * af stykker, og en tråd der løber tør stjæler den største halvdel fra en anden, så elementer der
+ * tager meget forskellig tid alligevel bliver fordelt. Den kaldende tråd er tråd 0 og arbejder med
+ * indtil alt er kørt. Uden tråde på platformen bliver function kaldt en gang med det hele
+ * @param[in] threads antallet af tråde, 0 betyder en for hver processor, højst MAX_THREADS
+ * @param[in] grain stykkerne bliver ikke delt mindre end det
+ */
+enum VagtplanStatus vagtplan_parallel_for(VagtplanContext* context, unsigned int threads, unsigned long count, unsigned long grain, VagtplanTaskFunction function, void* argument);
+
+/**
+ * @returns teksten til den sidste fejl i konteksten
+ */
+const char* vagtplan_error_message(const VagtplanContext* context);
+
+/**
+ * Sætter options til standardværdierne, den generationsbaserede motor med 100000 generationer
+ */
+void vagtplan_default_options(SolverOptions* options);
+
+/**
+ * @returns det samme antal medarbejdere på alle ugens nattevagter, dagvagter og aftenvagter
+ */
+RequiredWorkers vagtplan_required_per_shift(unsigned int night_workers, unsigned int day_workers, unsigned int evening_workers);
+
+/**
+ * @param[in] counts antallet af medarbejdere på hver af de 21 blokke, mandag nat først
+ */
+RequiredWorkers vagtplan_required_per_block(const unsigned int* counts);
+
+/**
+ * @returns antallet af medarbejdere der skal være på en blok
+ */
+unsigned int vagtplan_required_count(const RequiredWorkers* required_workers, unsigned int block);
+
+/**
+ * Læser bemandingen fra en fil med en linje for hver dag: dagen og antallet på nat, dag og aften,
+ * for eksempel mandag,2,4,3. Alle ugens dage skal være der, og der skal være mindst en på hver blok
+ * @param[in, out] file en åben fil i formatet fra bemanding.csv
+ */
+enum VagtplanStatus vagtplan_read_required_workers(VagtplanContext* context, FILE* file, RequiredWorkers* out);
+
+/**
+ * Læser hvor mange der mindst skal have hver kvalifikation, en linje for hver krav: dagen, vagten,
+ * kvalifikationen og antallet, for eksempel lørdag,nat,nattevagt,2. Dagen kan også være alle.
+ * Antallet må ikke være højere end antallet på blokken
+ * @param[in, out] required_workers bemandingen som kravene bliver sat på
+ */
+enum VagtplanStatus vagtplan_read_skill_requirements(VagtplanContext* context, FILE* file, RequiredWorkers* required_workers);
+
+/**
+ * Læser medarbejderlisten ind i konteksten. En kontekst har kun en medarbejderliste, fordi
+ * vagtplanerne peger ind i den
+ * @param[in, out] file en åben fil i formatet fra medarbejdere.csv
+ */
+enum VagtplanStatus vagtplan_read_workers(VagtplanContext* context, FILE* file);
+
+/**
+ * Læser medarbejderlisten ligesom vagtplan_read_workers, men gennem en binær cache med den færdigt
+ * indlæste liste. Cachen bliver brugt hvis CSV filen har samme størrelse og tidspunkt som da cachen
+ * blev skrevet, eller samme indhold hvis kun tidspunktet er ændret. Ellers bliver CSV filen læst og
+ * cachen skrevet igen. En cache der mangler, er ødelagt eller ikke kan skrives er ikke en fejl
+ * @param[in] file_name stien til CSV filen
+ * @param[in] cache_name stien til cachen
+ * @param[out] used_cache sættes til true hvis medarbejderne kom fra cachen, må være NULL
+ */
+enum VagtplanStatus vagtplan_read_workers_cached(VagtplanContext* context, const char* file_name, const char* cache_name, bool* used_cache);
+
+/**
+ * Kopierer en allerede indlæst medarbejderliste ind i konteksten, så den ikke skal læses igen.
+ * source bliver kun læst, så flere tråde kan kopiere fra den samme kontekst samtidig
+ * @param[in] source en kontekst hvor vagtplan_read_workers er lykkedes
+ */
+enum VagtplanStatus vagtplan_copy_workers(VagtplanContext* context, const VagtplanContext* source);
+
+unsigned int vagtplan_worker_count(const VagtplanContext* context);
+const char* vagtplan_worker_name(const VagtplanContext* context, unsigned int worker);
+unsigned int vagtplan_worker_uuid(const VagtplanContext* context, unsigned int worker);
+
+/**
+ * Afdelingerne kommer fra kolonnen afdeling:navn i medarbejderlisten. Medarbejdere uden kolonnen
+ * er i en afdeling uden navn, så der er altid mindst en afdeling
+ */
+unsigned int vagtplan_department_count(const VagtplanContext* context);
+const char* vagtplan_department_name(const VagtplanContext* context, unsigned int department);
+
+/**
+ * @returns nummeret på medarbejderens afdeling, fra 0 til vagtplan_department_count
+ */
+unsigned int vagtplan_worker_department(const VagtplanContext* context, unsigned int worker);
+
+/**
+ * @param[out] worker medarbejderens nummer, fra 0 til vagtplan_worker_count
+ */
+enum VagtplanStatus vagtplan_find_worker(VagtplanContext* context, unsigned int uuid, unsigned int* worker);
+
+/**
+ * Sætter de blokke en medarbejder ikke kan tage, f.eks. på grund af ferie eller kursus. Motorerne
+ * sætter aldrig medarbejderen på blokkene, og en vagtplan der gør får 1000 strafpoint for hver
+ * @param[in] worker medarbejderens nummer, fra 0 til vagtplan_worker_count
+ * @param[in] blocks en bit for hver blok, erstatter de blokke der var sat før
+ */
+enum VagtplanStatus vagtplan_set_forbidden_blocks(VagtplanContext* context, unsigned int worker, unsigned long blocks);
+
+/**
+ * Læser fraværet fra en fil med en linje for hver fravær: medarbejderens uuid og en liste af blokke
+ * i formatet fra vagtplan_parse_block_list, for eksempel 17,mandag-onsdag,torsdag:nat. En medarbejder
+ * kan have flere linjer. Skal kaldes efter vagtplan_read_workers
+ * @param[in, out] file en åben fil i formatet fra fravaer.csv
+ */
+enum VagtplanStatus vagtplan_read_availability(VagtplanContext* context, FILE* file);
+
+/**
+ * Læser en vagtplan, alle medarbejderne skal findes i medarbejderlisten. Antallet på hver blok
+ * kommer fra filen, og der er ingen krav til kvalifikationer før de bliver sat med
+ * vagtplan_schedule_requirements
+ * @param[out] out den indlæste vagtplan, skal frigives med vagtplan_free_schedule
+ */
+enum VagtplanStatus vagtplan_read_schedule(VagtplanContext* context, FILE* file, VagtplanSchedule** out);
+
+/**
+ * Læser en tidligere vagtplan så den kan bruges som startvagtplan. Medarbejdere som ikke findes
+ * længere bliver erstattet af tilfældige medarbejdere, og vagtplanen bliver tilpasset required_workers
+ * @param[out] out den indlæste vagtplan, skal frigives med vagtplan_free_schedule
+ */
+enum VagtplanStatus vagtplan_read_seed(VagtplanContext* context, FILE* file, RequiredWorkers required_workers, VagtplanSchedule** out);
+
+enum VagtplanStatus vagtplan_write_schedule(VagtplanContext* context, FILE* file, const VagtplanSchedule* schedule);
+
+/**
+ * @param[out] score vagtplanens score, nu højere nu bedre
+ */
+enum VagtplanStatus vagtplan_evaluate_schedule(VagtplanContext* context, VagtplanSchedule* schedule, double* score);
+
+/**
+ * Laver en vagtplan. Med options->islands over 1 bliver der startet barneprocesser med fork, så
+ * det skal kun bruges i et program hvor det er i orden
+ * @param[in] seeds startvagtplaner fra vagtplan_read_seed, må være NULL
+ * @param[out] out den bedste vagtplan, skal frigives med vagtplan_free_schedule
+ */
+enum VagtplanStatus vagtplan_make_schedule(VagtplanContext* context, RequiredWorkers required_workers, const SolverOptions* options, VagtplanSchedule* const* seeds, unsigned int seed_count, VagtplanSchedule** out);
+
+/**
+ * Laver op til options->alternatives forskellige gode vagtplaner i en enkelt kørsel. Motoren
+ * giver de vagtplaner den allerede har evalueret videre til et arkiv af de bedste, så det koster
+ * ingen ekstra evalueringer. Den eksakte søgning finder kun en vagtplan, og med øer bliver
+ * alternativerne taget fra de individer øerne har udgivet
+ * @param[out] out en array med plads til options->alternatives vagtplaner, den bedste først.
+ * Hver vagtplan skal frigives med vagtplan_free_schedule
+ * @param[out] count antallet af vagtplaner der blev fundet, mindst 1
+ */
+enum VagtplanStatus vagtplan_make_schedules(VagtplanContext* context, RequiredWorkers required_workers, const SolverOptions* options, VagtplanSchedule* const* seeds, unsigned int seed_count, VagtplanSchedule** out, unsigned int* count);
+
+/**
+ * Laver en vagtplan for hver afdeling for sig og sætter dem sammen til en vagtplan for hele
+ * medarbejderlisten. Der er ingen regler på tværs af afdelingerne, så hver afdeling er et problem
+ * for sig, og tiden afhænger af den største afdeling i stedet for hele listen. Op til
+ * options->parallel_departments afdelinger bliver løst samtidig i hver sin tråd og kontekst, så
+ * kontekstens allokator skal kunne kaldes fra flere tråde. Hver afdeling får hele options->time_limit.
+ * options->islands bliver ikke brugt, da der ikke kan startes øer med fork fra trådene
+ * @param[in] required_workers bemandingen for hver afdeling, vagtplan_department_count i alt
+ * @param[out] out vagtplanen for alle afdelingerne, blok for blok i afdelingernes rækkefølge. Dens
+ * bemanding er summen af afdelingernes. Skal frigives med vagtplan_free_schedule
+ */
+enum VagtplanStatus vagtplan_make_department_schedule(VagtplanContext* context, const RequiredWorkers* required_workers, const SolverOptions* options, VagtplanSchedule** out);
+
+/**
+ * Genplanlægger en udgivet vagtplan når en medarbejder ikke kan dække nogle af sine blokke.
+ * Kun blokkene omkring de ledige pladser bliver ændret, og hver ændring i forhold til den udgivne
+ * vagtplan koster point, så den nye vagtplan ligger så tæt på den gamle som muligt
+ * @param[in] worker medarbejderen som ikke kan dække blokkene
+ * @param[in] blocks en bit for hver blok medarbejderen ikke kan dække
+ * @param[in] max_changes det højeste antal ændringer, eller -1 for standardværdien
+ * @param[out] out den nye vagtplan, skal frigives med vagtplan_free_schedule
+ * @param[out] changes antallet af pladser der er forskellige fra den udgivne vagtplan
+ */
+enum VagtplanStatus vagtplan_replan_schedule(VagtplanContext* context, const VagtplanSchedule* published, unsigned int worker, unsigned long blocks, int max_changes, VagtplanSchedule** out, unsigned int* changes);
+
+void vagtplan_free_schedule(VagtplanContext* context, VagtplanSchedule* schedule);
+
+/**
+ * Laver et sted hvor motoren kan udgive den bedste vagtplan, til SolverOptions.progress
+ * @param[in] required_workers bemandingen motoren skal køre med
+ * @param[out] out skal frigives med vagtplan_free_progress når motoren er færdig
+ */
+enum VagtplanStatus vagtplan_create_progress(VagtplanContext* context, RequiredWorkers required_workers, VagtplanProgress** out);
+void vagtplan_free_progress(VagtplanContext* context, VagtplanProgress* progress);
+
+/**
+ * Beder motoren om at stoppe efter det skridt den er i gang med, og give den bedste vagtplan
+ * indtil videre som sit resultat. Sætter kun et flag, så den må kaldes fra en signal handler
+ */
+void vagtplan_request_stop(VagtplanProgress* progress);
+
+/**
+ * Kopierer den bedste vagtplan motoren har udgivet. Kan kaldes fra en anden tråd mens motoren
+ * kører, men så med sin egen kontekst
+ * @param[in] context en kontekst med den samme medarbejderliste som motorens, f.eks. fra vagtplan_copy_workers
+ * @param[out] out vagtplanen, skal frigives med vagtplan_free_schedule
+ * @param[out] steps hvor mange skridt motoren havde taget da vagtplanen blev udgivet
+ * @returns VAGTPLAN_ERROR_ARGUMENT hvis motoren ikke har udgivet noget endnu
+ */
+enum VagtplanStatus vagtplan_progress_best(VagtplanContext* context, const VagtplanProgress* progress, VagtplanSchedule** out, unsigned int* steps);
+
+/**
+ * Sammenligner alle fitness funktionerne motorerne bruger med en fastfrosset reference, som
+ * udregner reglerne direkte for hver medarbejder: ønsket vagt og fridag, 11 timers reglen, den
+ * cykliske regel, nattevagter i streg og fridøgnet i løbet af ugen. Halvdelen af vagtplanerne er
+ * tilfældige, og i den anden halvdel dækker få medarbejdere alle blokkene, så reglerne bliver ramt.
+ * Lokalsøgningen bliver tjekket efter hvert træk. De første forskelle bliver skrevet til loggen
+ * @param[in] schedule_count antallet af vagtplaner hver funktion bliver tjekket på
+ * @param[out] results en plads for hver af de VAGTPLAN_EVALUATOR_COUNT funktioner, referencen først
+ */
+enum VagtplanStatus vagtplan_check_evaluators(VagtplanContext* context, RequiredWorkers required_workers, unsigned long schedule_count, VagtplanEvaluatorCheck* results);
+
+/**
+ * @returns antallet af medarbejdere på en blok i vagtplanen
+ */
+unsigned int vagtplan_block_size(const VagtplanSchedule* schedule, unsigned int block);
+
+/**
+ * @returns bemandingen vagtplanen bliver evalueret efter. Kravene til kvalifikationer må ændres,
+ * antallet på blokkene må ikke
+ */
+RequiredWorkers* vagtplan_schedule_requirements(VagtplanSchedule* schedule);
+
+/**
+ * @returns scoren fra den sidste evaluering af vagtplanen
+ */
+double vagtplan_schedule_score(const VagtplanSchedule* schedule);
+
+/**
+ * @returns nummeret på medarbejderen på en plads i en blok
+ */
+unsigned int vagtplan_schedule_worker(const VagtplanSchedule* schedule, unsigned int block, unsigned int slot);
+
+/**
+ * Læser en kommasepareret liste af blokke. Hvert element er enten en dag (tirsdag), et interval af
+ * dage (mandag-onsdag), en dag og en vagt (tirsdag:nat), et bloknummer fra 0 til 20 eller et
+ * interval af bloknumre (3-8)
+ * @param[out] blocks en bit for hver blok
+ * @returns true hvis listen var gyldig
+ */
+bool vagtplan_parse_block_list(const char* text, unsigned long* blocks);
+
+const char* vagtplan_day_name(enum Day day);
+const char* vagtplan_shift_name(enum Shift shift);
+const char* vagtplan_skill_name(enum Skill skill);
+
+#endif